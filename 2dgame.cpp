@@ -1,6 +1,8 @@
 #include "raylib.h"
+#include "Headless.h"
 #include "raymath.h"
 #include "CollisionSystem.h"
+#include "CollisionWorld.h"
 #include "Samurai.h"
 #include "Demon.h"
 #include <iostream>
@@ -20,13 +22,23 @@
 // Define RAYTMX_IMPLEMENTATION to include the implementation of the library
 #define RAYTMX_IMPLEMENTATION
 #include "raytmx.h"
+#include "MapLoader.h"
+#include "MapCache.h"
+#include "MapPrefetcher.h"
+#include "ParallaxBackground.h"
+#include "Profiler.h"
+#include "Log.h"
+#include "FixedTimestep.h"
+#include "Input.h"
+#include "MusicPlayer.h"
 
 // Define the global variable for collision box visibility
 bool showCollisionBoxes = false;
 
 // Global audio variables
-Music backgroundMusic = { 0 };
-Music menuMusic = { 0 };
+MusicTrack backgroundMusic = INVALID_MUSIC_TRACK;
+MusicTrack menuMusic = INVALID_MUSIC_TRACK;
+const float MUSIC_CROSSFADE_SECONDS = 1.5f; // Time the menu and level music take to fade into each other
 float masterVolume = 0.7f;
 
 // Global background texture
@@ -56,7 +68,7 @@ void triggerRoom3Dialogue() {
     dialogueTimer = 0.0f;
     
     // Print debug information
-    printf("Dialogue triggered: %s\n", dialogueText.c_str());
+    GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_GAME, "Dialogue triggered: %s", dialogueText.c_str());
 }
 
 Texture2D backgroundTexture = { 0 };
@@ -64,6 +76,11 @@ Camera2D camera = { 0 };
 
 TmxMap* map = NULL;
 
+// Object layers of the current map that characters land on, looked up once per map rather than by name every frame
+const int MAX_COLLISION_LAYERS = 8;
+TmxLayer* collisionLayers[MAX_COLLISION_LAYERS];
+int collisionLayerCount = 0;
+
 enum GameState {START_SCREEN, MAIN_GAME, EXIT};
 bool isPaused = false;
 bool isComplete = false;
@@ -74,12 +91,66 @@ bool isTransitioning = false;
 float transitionAlpha = 0.0f;
 bool transitionFadeIn = false;
 
+// Loads the next map on a worker thread while the screen fades out
+MapLoader mapLoader;
+
+// Keeps visited maps resident so going back to a room doesn't reload it
+MapCache mapCache;
+TmxMap* transitionMap = NULL; // Resident map to switch to, or NULL while mapLoader loads it
+
+// Portals between maps, bucketed by map and position so finding the one the player stands in is cheap
+PortalIndex portalIndex(PORTALS, PORTAL_COUNT);
+
+// Starts loading the destination of a portal the player is approaching
+MapPrefetcher mapPrefetcher(mapCache, portalIndex);
+std::string currentMapFileName;    // Map being played, used to find the portals leading out of it
+std::string transitionMapFileName; // Map being switched to
+
+// Times the parts of each frame for the F3 overlay and the F4 trace dump
+Profiler profiler;
+
+// Hands frame time to the simulation in fixed steps
+FixedTimestep simulationClock;
+
+// Keyboard and mouse state of the current frame, read live or from a recording
+InputSystem input;
+
+// Characters' collision boxes bucketed by position, so attacks are only tested against nearby hurtboxes
+CollisionWorld collisionWorld;
+std::vector<CollisionPair> collisionPairs; // Result of the latest pair query, kept to reuse its memory
+const int SAMURAI_COLLISION_OWNER = 0;
+const int DEMON_COLLISION_OWNER = 1;
+
 std::function<void()> transitionAction;
-void startTransition(std::function<void()> action) {
+void startTransition(const char* mapFileName, std::function<void()> action) {
+    // Portals stay triggered while the player stands in them, so ignore repeats once a switch is under way
+    if (isTransitioning) return;
+
     isTransitioning = true;
     transitionAlpha = 0.0f;
     transitionFadeIn = false;
     transitionAction = action;
+    transitionMapFileName = mapFileName;
+
+    mapPrefetcher.onTransition(mapFileName);
+    transitionMap = mapCache.acquire(mapFileName);
+    if (!transitionMap && !mapPrefetcher.isLoading(mapFileName)) {
+        mapLoader.request(mapFileName);
+    }
+}
+
+// Checks whether the map being switched to is resident or loaded, starting its load if nothing else is loading it
+bool pollTransitionMap(Vector2 samuraiPosition) {
+    // A prefetch still in flight when the fade started lands in the cache once it's done
+    if (!transitionMap && !mapLoader.isBusy()) {
+        mapPrefetcher.update(currentMapFileName, samuraiPosition);
+        transitionMap = mapCache.peek(transitionMapFileName);
+        if (!transitionMap && !mapPrefetcher.isLoading(transitionMapFileName)) {
+            // The prefetch failed or was evicted, so load the map the usual way
+            mapLoader.request(transitionMapFileName);
+        }
+    }
+    return transitionMap || mapLoader.isReady();
 }
 
 // Helper function to check collision between two collision boxes
@@ -105,17 +176,19 @@ void handleAttackCollision(CollisionBox* attackBox, CollisionBox* hurtBox, int&
 // Custom exit function that bypasses normal cleanup
 void safeExit() {
     // Unload audio resources
-    if (backgroundMusic.ctxData != NULL) {
-        StopMusicStream(backgroundMusic);
-        UnloadMusicStream(backgroundMusic);
-    }
+    getMusicPlayer().shutdown();
     
     // Unload the background texture
     if (backgroundTexture.id != 0) {
         UnloadTexture(backgroundTexture);
     }
 
-    // Clean up Raylib
+    // Finish an input recording and write out queued log messages, since _Exit skips their destructors
+    input.stop();
+    getLogger().shutdown();
+
+    // Clean up Raylib, once the mixer has let go of its voices
+    getAudioMixer().clear();
     CloseAudioDevice();
     CloseWindow();
     
@@ -168,14 +241,39 @@ bool fileExists(const char* fileName) {
     return false;
 }
 
+// Finds the current map's collision layers. Maps whose layers aren't tagged with a role fall back to "Object Layer 1".
+void bindMapLayers() {
+    TmxLayer* layers[MAX_COLLISION_LAYERS];
+    uint32_t layerCount = GetTMXLayersWithRole(map, LAYER_ROLE_COLLISION, layers, MAX_COLLISION_LAYERS);
+    if (layerCount == 0) {
+        layers[0] = GetTMXLayer(map, "Object Layer 1");
+        layerCount = layers[0] != NULL ? 1 : 0;
+    } else if (layerCount > MAX_COLLISION_LAYERS) {
+        GAME_LOG(LOG_LEVEL_WARNING, LOG_CATEGORY_MAP, "%s has %u collision layers, only the first %d are used",
+                 currentMapFileName.c_str(), layerCount, MAX_COLLISION_LAYERS);
+        layerCount = MAX_COLLISION_LAYERS;
+    }
+
+    collisionLayerCount = 0;
+    for (uint32_t i = 0; i < layerCount; i++) {
+        if (layers[i]->type == LAYER_TYPE_OBJECT_GROUP) collisionLayers[collisionLayerCount++] = layers[i];
+    }
+    if (collisionLayerCount == 0) {
+        GAME_LOG(LOG_LEVEL_WARNING, LOG_CATEGORY_MAP, "%s has no collision layer", currentMapFileName.c_str());
+    }
+}
+
 void loadLevel() {
-    map = LoadTMX("maps/LevelDesign.tmx");
+    currentMapFileName = "maps/LevelDesign.tmx";
+    map = mapCache.insert(currentMapFileName, LoadTMXBinary(currentMapFileName.c_str()));
+    mapCache.pin(map);
     if (!map) {
-        printf("Failed to Load TMX File.\n");
+        GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_MAP, "Failed to load %s", currentMapFileName.c_str());
         exit (1);
     } else {
-        printf("Loaded TMX File.");
+        GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_MAP, "Loaded %s", currentMapFileName.c_str());
     }
+    bindMapLayers();
 
     // Loop through tilesets (assuming map->tilesets is a pointer to an array of TmxTileset)
     for (int i = 0; i < map->tilesetsLength; i++) {
@@ -185,7 +283,7 @@ void loadLevel() {
         if (tileset->image.source[0] != '\0') {  // Using image.source to check validity
             Texture2D tilesetTexture = LoadTexture("maps/16 x16 Purple Dungeon Sprite Sheet.png");
             if (tilesetTexture.id == 0) {
-                std::cout << "Error loading tileset image" << std::endl;
+                GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_MAP, "Error loading tileset image");
             }
         }
     }
@@ -197,16 +295,11 @@ void renderLevel() {
     }
 }
 
-void checkTileCollisions(TmxMap* map, Samurai& player) {
-    for (unsigned int i = 0; i < map->layersLength; i++) {
-      TraceLog(LOG_DEBUG, "current layer is %d: %s", i, map->layers[i].name);
-      if (strcmp(map->layers[i].name, "Object Layer 1") == 0 && map->layers[i].type == LAYER_TYPE_OBJECT_GROUP) 
-      {
-          TmxObject col;
-          if (CheckCollisionTMXObjectGroupRec(map->layers[i].exact.objectGroup, player.getRect(), &col))
-          {
-            TraceLog(LOG_DEBUG, "We've made contact!");
-            
+void checkTileCollisions(Samurai& player) {
+    for (int i = 0; i < collisionLayerCount; i++) {
+        TmxObject col;
+        if (CheckCollisionTMXObjectGroupRec(collisionLayers[i]->exact.objectGroup, player.getRect(), &col))
+        {
             Vector2 newVel = player.getVelocity();
             newVel.y = 0;
             player.setVelocity(newVel);
@@ -218,30 +311,61 @@ void checkTileCollisions(TmxMap* map, Samurai& player) {
             if (player.isJumping()) {
                 player.land();
             }
-          }
-      }
+        }
     }
     return;
 } 
 
-int main() 
+int main(int argc, char* argv[]) 
 {
     // Print current working directory
     char cwd[PATH_MAX];
     if (getcwd(cwd, sizeof(cwd)) != NULL) {
-        printf("Current working directory: %s\n", cwd);
+        GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_GAME, "Current working directory: %s", cwd);
     } else {
         perror("getcwd() error");
     }
     
     // Set up error handling
     SetTraceLogLevel(LOG_WARNING);
+
+    // --record <file> saves this run's input, --replay <file> plays a saved run back and --trace logs the
+    // samurai's position as it moves
+    const char* recordFileName = NULL;
+    const char* replayFileName = NULL;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordFileName = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayFileName = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            getLogger().setLevel(LOG_CATEGORY_PLAYER, LOG_LEVEL_TRACE);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+#ifdef HEADLESS
+    // Run the update loop only, for as many frames and with the input the rest of the command line asks for
+    if (!getHeadlessBackend().configure((int)args.size(), args.data())) {
+        return 1;
+    }
+#endif
     
     // Initialize window
     const int screenWidth = 1920;
     const int screenHeight = 1080;
     InitWindow(screenWidth, screenHeight, "2D Game");
 
+    // Recording and replaying reseed the random number generator, which InitWindow() seeds too
+    if (recordFileName && !input.startRecording(recordFileName)) {
+        return 1;
+    }
+    if (replayFileName && !input.startReplay(replayFileName)) {
+        return 1;
+    }
+
     // Define floor level to match where the non-zero tiles (floor tiles) are in Room1.tmx
     // This value is used for all characters to ensure consistent vertical positioning
     const float floorLevel = 10000.0f; // Exact floor level matching the non-zero floor tiles in TMX
@@ -260,20 +384,26 @@ int main()
     float bgposX = ((screenWidth - background.width * scalebg) / 2) - 600;
     float bgposY = ((screenHeight - background.height * scalebg) / 2) - 210;
     
-    // Horizontal and Vertical Sliders for Background.
-    int scaledW = background.width * scalebg;
-    int scaledH = background.height * scalebg;
-    int tilesX = (screenWidth / scaledW) + 50;
-    int tilesY = (screenHeight / scaledH) + 15;
+    // Area the wall repeats over: as many repetitions as fit the screen, plus 50 across and 15 down.
+    float scaledW = background.width * scalebg;
+    float scaledH = background.height * scalebg;
+    int tilesX = (screenWidth / (int)scaledW) + 50;
+    int tilesY = (screenHeight / (int)scaledH) + 15;
+    ParallaxBackground backgroundLayers;
+    backgroundLayers.addLayer(background, scalebg, 1.0f, Vector2{bgposX, bgposY}, GRAY,
+                              Rectangle{bgposX, bgposY, tilesX * scaledW, tilesY * scaledH});
     
     // Initialize audio device before loading music
     InitAudioDevice();
 
-    // Load Music.
-    backgroundMusic = LoadMusicStream("music/03. Hunter's Dream.mp3");
-    menuMusic = LoadMusicStream("music/Soul Of Cinder.mp3");
+    // Load Music. It is decoded and streamed on the music player's own thread.
+    backgroundMusic = getMusicPlayer().addTrack("music/03. Hunter's Dream.mp3");
+    menuMusic = getMusicPlayer().addTrack("music/Soul Of Cinder.mp3", 0.5f * masterVolume);
     
     SetTargetFPS(60);
+
+    // Draw tile layers from 32x32-tile render textures instead of tile by tile, keeping up to 64 MB of them in VRAM
+    SetTMXChunkCache(32, 64 * 1024 * 1024);
     
     // Initialize camera
     camera.target = (Vector2){ 100, 0 };
@@ -293,27 +423,21 @@ int main()
 
     StartScreen startScreen;
     GameState gameState = START_SCREEN;
+#ifdef HEADLESS
+    gameState = MAIN_GAME; // Nobody is there to click the start button
+#endif
+    if (input.getMode() != INPUT_LIVE) {
+        gameState = MAIN_GAME; // Recordings start in the first level, so replays don't depend on the menu
+    }
 
     loadLevel();
 
     // Start playing menu music initially
-    PlayMusicStream(menuMusic);
-    SetMusicVolume(menuMusic, 0.5f * masterVolume);
-    bool isPlayingMenuMusic = true;
+    getMusicPlayer().crossfadeTo(menuMusic, 0.0f);
 
-    // Check which map are we in
-    bool mapSwitchedToRoom2 = false;
-
-    bool mapSwitchedToRoom3 = false;
-    bool mapSwitchedToRoom4 = false;
-    
-    bool mapSwitchedToMainLevel2 = false;
-    
-    //New map for main level 2
-    bool mapSwitchedToRoom5 = false;
-    bool mapSwitchedToRoom6 = false;
-    bool mapSwitchedToRoom7 = false;
-    bool mapSwitchedToRoom8 = false;
+    // Check which main level we are in and what the portal we came through does
+    int currentLevel = 1;
+    PortalEvent arrivalEvent = PORTAL_EVENT_NONE;
 
     
     // Create a demon for Room2
@@ -321,8 +445,10 @@ int main()
 
     // Game loop
     while (!WindowShouldClose()) {
-        // Update currently playing music
-        UpdateMusicStream(isPlayingMenuMusic ? menuMusic : backgroundMusic);
+        // Read this frame's input, stopping once a replay runs out
+        if (!input.beginFrame()) {
+            break;
+        }
 
         // Handle game state updates based on current game state
         switch(gameState) {
@@ -333,12 +459,11 @@ int main()
                 break;
             }
             case START_SCREEN: {
-                if (!isPlayingMenuMusic) {
-                    PlayMusicStream(menuMusic);
-                    isPlayingMenuMusic = true;
+                if (getMusicPlayer().getCurrentTrack() != menuMusic) {
+                    getMusicPlayer().crossfadeTo(menuMusic, MUSIC_CROSSFADE_SECONDS);
                 }
 
-                startScreen.Update();
+                startScreen.Update(input);
 
                 if (startScreen.ShouldStartGame()) {
                     gameState = MAIN_GAME;  // Transition to main game
@@ -354,50 +479,216 @@ int main()
             }
 
             case MAIN_GAME: {
-                if (isPlayingMenuMusic) {
-                    PlayMusicStream(backgroundMusic);
-                    isPlayingMenuMusic = false;
+                profiler.beginFrame();
+
+                if (getMusicPlayer().getCurrentTrack() != backgroundMusic) {
+                    getMusicPlayer().crossfadeTo(backgroundMusic, MUSIC_CROSSFADE_SECONDS);
                 }
 
-                if (IsKeyPressed(KEY_P)) {
+                if (input.isKeyPressed(KEY_P)) {
                     isPaused = !isPaused;
                 }
                 
                 // Toggle music with M key
-                if (IsKeyPressed(KEY_M)) {
-                    if (IsMusicStreamPlaying(backgroundMusic)) {
-                        PauseMusicStream(backgroundMusic);
-                    } else {
-                        ResumeMusicStream(backgroundMusic);
-                    }
+                if (input.isKeyPressed(KEY_M)) {
+                    getMusicPlayer().togglePause();
                 }
 
                 // Toggle collision box visibility with F1 key
-                if (IsKeyPressed(KEY_F1)) {
+                if (input.isKeyPressed(KEY_F1)) {
                     showCollisionBoxes = !showCollisionBoxes;
-                    printf("Collision boxes visibility: %s\n", showCollisionBoxes ? "ON" : "OFF");
+                    GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_GAME, "Collision boxes visibility: %s",
+                             showCollisionBoxes ? "ON" : "OFF");
                 }
 
-                // Get frame time for updates
-                float deltaTime = GetFrameTime();
+                // Toggle the frame time profiler with F3, and save what it recorded with F4
+                if (input.isKeyPressed(KEY_F3)) {
+                    profiler.isVisible = !profiler.isVisible;
+                }
+                if (input.isKeyPressed(KEY_F4)) {
+                    profiler.dumpChromeTrace("profile.json");
+                }
 
+                // Collect key presses once per frame, then advance the simulation in fixed steps. A frame takes as many
+                // steps as its duration covers, possibly none, so gameplay runs at the same speed at any frame rate.
                 if (!isPaused && !isComplete) {
-                    // Update samurai character
-                    samurai.updateSamurai();
+                    samurai.pollInput(input);
                 }
+                int steps = input.syncSteps(simulationClock.advance(GetFrameTime()));
+                float step = simulationClock.getStep();
+                for (int i = 0; i < steps; i++) {
+                    samurai.storePreviousRect();
+                    if (demon != nullptr) {
+                        demon->storePreviousRect();
+                    }
 
-                // You are in the first main level
-                if(!mapSwitchedToMainLevel2)
-                {
-                    samurai.deathBarrier();
-                }
-       
-                // You are now in the second main level. Wow.
-                if (mapSwitchedToMainLevel2)
-                {
-                    samurai.secondDeathBarrier();
+                    if (!isPaused && !isComplete) {
+                        // Update samurai character
+                        PROFILE_SCOPE(profiler, PROFILE_UPDATE_SAMURAI);
+                        samurai.updateSamurai(step);
+                    }
+
+                    // You are in the first main level
+                    if(currentLevel == 1)
+                    {
+                        samurai.deathBarrier();
+                    }
+           
+                    // You are now in the second main level. Wow.
+                    if (currentLevel == 2)
+                    {
+                        samurai.secondDeathBarrier();
+                    }
+
+                    {
+                        PROFILE_SCOPE(profiler, PROFILE_TILE_COLLISIONS);
+                        checkTileCollisions(samurai);
+                    }
+
+                    // Update demon if in Room2
+                    if (arrivalEvent == PORTAL_EVENT_DEMON_ROOM && demon != nullptr) {
+                        PROFILE_SCOPE(profiler, PROFILE_DEMON_AI);
+                        Rectangle samuraiRect = samurai.getRect();
+
+                        // Update demon animation
+                        demon->updateAnimation(step);
+                    
+                        // Update demon AI behavior
+                        if (!demon->isDead && !isPaused) {
+                            // Get distance to player
+                            Rectangle demonRect = demon->rect;
+                            Vector2 demonPos = { demonRect.x + demonRect.width/2, demonRect.y + demonRect.height/2 };
+                            Vector2 samuraiPos = { samuraiRect.x + samuraiRect.width/2, samuraiRect.y + samuraiRect.height/2 };
+                            float distance = Vector2Distance(demonPos, samuraiPos);
+                        
+                            // Chase player if within range
+                            if (distance < demon->chaseRange && distance > demon->attackRange) {
+                                demon->state = WALK_DEMON;
+                                demon->direction = (samuraiPos.x < demonPos.x) ? LEFT_DEMON : RIGHT_DEMON;
+                            
+                                // Move toward player
+                                float moveDir = (demon->direction == LEFT_DEMON) ? -1.0f : 1.0f;
+                                demon->velocity.x = moveDir * demon->moveSpeed * 100.0f;
+                            } 
+                            // Attack if close enough
+                            else if (distance <= demon->attackRange) {
+                                if (!demon->isAttacking) {
+                                    demon->attack();
+                                }
+                            }
+                            // Idle if too far
+                            else {
+                                demon->state = IDLE_DEMON;
+                                demon->velocity.x = 0;
+                            }
+                        
+                            // Apply velocity
+                            demon->applyVelocity(step);
+                        }
+                    }
+
+                    // Keep the collision world up to date with the boxes of the characters on this map
+                    collisionWorld.syncOwner(SAMURAI_COLLISION_OWNER, samurai.getCollisionBoxes());
+                    if (arrivalEvent == PORTAL_EVENT_DEMON_ROOM && demon != nullptr) {
+                        collisionWorld.syncOwner(DEMON_COLLISION_OWNER, demon->collisionBoxes);
+                    } else {
+                        collisionWorld.removeOwner(DEMON_COLLISION_OWNER);
+                    }
+
+                    // Resolve attacks landing on hurtboxes, each attack hitting each character at most once a step
+                    {
+                        PROFILE_SCOPE(profiler, PROFILE_COMBAT);
+                        collisionWorld.queryPairs(ATTACK, HURTBOX, collisionPairs);
+                        bool isDemonHit = false;
+                        bool isSamuraiHit = false;
+                        for (const CollisionPair& hit : collisionPairs) {
+                            if (hit.firstOwner == SAMURAI_COLLISION_OWNER && hit.secondOwner == DEMON_COLLISION_OWNER) {
+                                if (!isDemonHit) {
+                                    demon->takeDamage(25); // Samurai deals 25 damage
+                                    isDemonHit = true;
+                                }
+                            } else if (hit.firstOwner == DEMON_COLLISION_OWNER && hit.secondOwner == SAMURAI_COLLISION_OWNER) {
+                                if (!isSamuraiHit) {
+                                    // Check if samurai is blocking to reduce damage
+                                    if (samurai.isBlocking()) {
+                                        // Apply damage reduction when blocking (half damage)
+                                        int reducedDamage = static_cast<int>(15 * samurai.getBlockDamageReduction());
+                                        samurai.takeDamage(reducedDamage);
+                                        GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_PLAYER, "Blocked attack! Reduced damage: %d", reducedDamage);
+                                    } else {
+                                        samurai.takeDamage(15); // Full damage when not blocking
+                                    }
+                                    demon->collisionBoxes[hit.firstIndex].active = false; // Prevent multiple hits
+                                    isSamuraiHit = true;
+                                }
+                            }
+                        }
+                    }
+
+                    // Portals and the level end are checked after every step rather than once a frame, so the steps
+                    // of a slow frame can't carry the samurai across them unnoticed
+                    Rectangle stepRect = samurai.getRect();
+                    bool wasTransitioning = isTransitioning;
+                    {
+                        PROFILE_SCOPE(profiler, PROFILE_PORTALS);
+
+                        // Load the map behind a nearby portal before the player reaches it
+                        if (!isTransitioning) {
+                            mapPrefetcher.update(currentMapFileName, (Vector2){ stepRect.x, stepRect.y });
+                        }
+
+                        // Switching map :o
+                        const Portal* portal = portalIndex.query(currentMapFileName, (Vector2){ stepRect.x, stepRect.y });
+                        if (portal && !isTransitioning) 
+                        {
+                            // Debug output to confirm portal detection
+                            GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_MAP, "Portal to %s detected! Player position: %.2f, %.2f",
+                                     portal->toMap, stepRect.x, stepRect.y);
+                            startTransition(portal->toMap, [&, portal]() 
+                            {
+                                currentLevel = portal->level;
+                                arrivalEvent = portal->event;
+
+                                // Set Samurai position to destination portal
+                                Rectangle newPos = samurai.getRect();
+                                newPos.x = portal->arrival.x;
+                                newPos.y = portal->arrival.y;
+                                samurai.setRect(newPos);
+                                samurai.storePreviousRect(); // Don't draw the teleport as a slide across the map
+
+                                // Recenter camera
+                                camera.target = { newPos.x, newPos.y };
+
+                                // Create demon in Room2
+                                if (arrivalEvent == PORTAL_EVENT_DEMON_ROOM && demon == nullptr) {
+                                    Vector2 demonPos = { 1000.0f, 2165.0f }; // Position the demon in Room2 at same ground level as samurai
+                                    demon = new Demon(demonPos, 50.0f, 500);
+                                    GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_DEMON, "Demon spawned in Room2");
+                                }
+                            });
+                        }
+                    }
+
+                    if(currentLevel == 2 && stepRect.x >= 12610 && stepRect.x <= 12655 && stepRect.y >= 2304) {
+                        isComplete = true;
+                    }
+
+                    // The rest of the frame's steps belong to the map being left, so stop once a switch begins
+                    if (isTransitioning && !wasTransitioning) {
+                        break;
+                    }
                 }
 
+                // Position tracing, after the frame's steps so headless runs and replays trace too, at most twice a
+                // second so it doesn't hold up the frame
+                GAME_LOG_EVERY(0.5, LOG_LEVEL_TRACE, LOG_CATEGORY_PLAYER, "X: %.2f Y: %.2f",
+                               samurai.getRect().x, samurai.getRect().y);
+
+                // Draw the characters and aim the camera between the last two steps, by how far into the next step
+                // the frame is
+                float alpha = simulationClock.getAlpha();
+                Rectangle samuraiRenderRect = samurai.getInterpolatedRect(alpha);
+
                 // Get samurai position for collision detection
                 Vector2 samuraiPos = {0, 0};
                 CollisionBox* samuraiBody = samurai.getCollisionBox(BODY);
@@ -406,14 +697,6 @@ int main()
                     samuraiPos.y = samuraiBody->rect.y + samuraiBody->rect.height / 2;
                 }
                 
-                // Check for collisions between Samurai's attack and enemies
-                CollisionBox* samuraiAttack = samurai.getCollisionBox(ATTACK);
-                
-                // Check for enemy attacks hitting Samurai
-                CollisionBox* samuraiHurtbox = samurai.getCollisionBox(HURTBOX);
-
-                checkTileCollisions(map, samurai);
-
                 // Update camera to follow player, ensuring it stays within map boundaries
                 Rectangle samuraiRect = samurai.getRect();
                 
@@ -421,7 +704,8 @@ int main()
                 float samuraiCenterY = samuraiRect.y + samuraiRect.height / 2;
                 
                 if (!samurai.checkDeath()) {
-                    camera.target = (Vector2){ samuraiPos.x, samuraiPos.y };
+                    camera.target = (Vector2){ samuraiPos.x + samuraiRenderRect.x - samuraiRect.x,
+                                               samuraiPos.y + samuraiRenderRect.y - samuraiRect.y };
                     // Add some camera boundary checks to avoid the camera going out of bounds:
                     float halfScreenWidth = screenWidth / (2.0f * camera.zoom);
                     float halfScreenHeight = screenHeight / (2.0f * camera.zoom);
@@ -444,418 +728,96 @@ int main()
                     camera.target = camera.target; // Keeps the camera locked in place
                 }
                 
-                // Switching map :o
-
-                // Main Level to Room2
-                if (!mapSwitchedToMainLevel2 && !mapSwitchedToRoom2 && samuraiRect.x >= 920 && samuraiRect.x <= 930 && samuraiRect.y == 1502) 
-                {
-                    // Debug output to confirm portal detection
-                    printf("Portal to Room2 detected! Player position: %.2f, %.2f\n", samuraiRect.x, samuraiRect.y);
-                    startTransition([&]() 
-                    {
-                        mapSwitchedToRoom2 = true;
-
-                        if (map) 
-                        {
-                            UnloadTMX(map);
-                        }
-
-                    map = LoadTMX("maps/Room2.tmx");
-                    if (!map) 
-                    {
-                        std::cerr << "Failed to load Room2.tmx!" << std::endl;
-                    }
-
-                    Rectangle newPos = samurai.getRect();
-
-                    newPos.x = 540;  
-                    newPos.y = 2222;
-                    samurai.setRect(newPos);
-
-                    camera.target = { newPos.x, newPos.y };
-                    
-                    // Create demon in Room2
-                    if (demon == nullptr) {
-                        Vector2 demonPos = { 1000.0f, 2165.0f }; // Position the demon in Room2 at same ground level as samurai
-                        demon = new Demon(demonPos, 50.0f, 500);
-                        std::cout << "Demon spawned in Room2" << std::endl;
-                    }
-                    });
-                }
-
-                
-                // Room2 to Main Level 
-                if (!mapSwitchedToMainLevel2 && mapSwitchedToRoom2 && samuraiRect.x >= 530 && samuraiRect.x <= 540 && samuraiRect.y >= 2170 && samuraiRect.y <= 2180) 
-                {
-                    // Debug output to confirm return portal detection
-                    printf("Return portal detected! Player position: %.2f, %.2f\n", samuraiRect.x, samuraiRect.y);
-                    startTransition([&]() 
-                    {
-                        mapSwitchedToRoom2 = false;
-                        if (map) 
-                        {
-                            UnloadTMX(map);
-                        }
-
-                        map = LoadTMX("maps/LevelDesign.tmx");
-                        if (!map) 
-                        {
-                            std::cerr << "Failed to load LevelDesign.tmx!" << std::endl;
-                        }
-
-                        Rectangle newPos = samurai.getRect();
-                        newPos.x = 920;
-                        newPos.y = 1519.5;
-                        samurai.setRect(newPos);
-
-                        camera.target = { newPos.x, newPos.y };
-
-                    });  
+                if(samurai.checkDeath()) {
+                    gameover = true;
                 }
                 
-                // Main Level to Room 3
-                if (!mapSwitchedToMainLevel2 && !mapSwitchedToRoom3 && samuraiRect.x >= 5415 && samuraiRect.x <= 5435 && samuraiRect.y >= 877 && samuraiRect.y <= 878)
-
-                {
-                    printf("Portal to Room3 detected! Player position: %.2f, %.2f\n", samuraiRect.x, samuraiRect.y);
-                    startTransition([&]() 
-                    {
-
-                        mapSwitchedToRoom3 = true; 
-
-                        if (map) 
-                        {
-                            UnloadTMX(map);
-                        }
 
-                        map = LoadTMX("maps/Room3.tmx"); // Load Room 3
-                        if (!map) 
-                        {
-                            printf("Failed to load Room3.tmx\n");
-                            safeExit(); // Exit if loading fails
-                        } 
-                        else 
-                        {
-                            printf("Loaded Room3.tmx successfully.\n");
-                        }
-                        
-                        Rectangle newPos = samurai.getRect();
-                        newPos.x = 1560; 
-                        newPos.y = 2190.25;
-                        samurai.setRect(newPos);
-                    });
-                }
-                
-                // Room 3 to Main Level 
-                if (!mapSwitchedToMainLevel2 && mapSwitchedToRoom3 && samuraiRect.x >= 1540 && samuraiRect.x <= 1570 && samuraiRect.y >= 2173 && samuraiRect.y <= 2175) 
+                // Fade out, switch maps on the black screen, then fade back in
+                if (isTransitioning) 
                 {
-                    printf("Portal back to LevelDesign detected! Player position: %.2f, %.2f\n", samuraiRect.x, samuraiRect.y);
-                    startTransition([&]() 
+                    if (!transitionFadeIn) 
                     {
-
-                        mapSwitchedToRoom3 = false;
-                        if (map) 
-                        {
-                            UnloadTMX(map);
-                        }
-                        map = LoadTMX("maps/LevelDesign.tmx"); // Load the main level
-                        if (!map) 
-                        {
-                            printf("Failed to Load TMX File: LevelDesign.tmx\n");
-                            safeExit(); 
-                        } 
-                        else 
+                        transitionAlpha += 0.02f;
+                        if (transitionAlpha >= 1.0f) 
                         {
-                            printf("Loaded TMX File: LevelDesign.tmx\n");
-                        }
-
-                        Rectangle newPos = samurai.getRect();
-                        newPos.x = 5895;
-                        newPos.y = 892;
-                        samurai.setRect(newPos);
-
-                        camera.target = { newPos.x, newPos.y };
-                    });  
-                }
-                
-                // Main Level to Room 4 
-                if (!mapSwitchedToMainLevel2 && !mapSwitchedToRoom4 && samuraiRect.x >= 8300 && samuraiRect.x <= 8320 && samuraiRect.y >= 2173 && samuraiRect.y <= 2176) 
-                {
-                    startTransition([&]() 
-                    {
-                        mapSwitchedToRoom4 = true;
+                            transitionAlpha = 1.0f;
 
-                        if (map) 
-                        {
-                            UnloadTMX(map);
-                        }
+                            // Stay on the black screen until the next map is resident or the worker has it ready. A
+                            // replay switches on the frame the recording did, waiting for the map if it's late.
+                            Vector2 samuraiPosition = { samuraiRect.x, samuraiRect.y };
+                            bool isMapReady = pollTransitionMap(samuraiPosition);
+                            if (input.syncMapSwitch(isMapReady)) 
+                            {
+                                while (!isMapReady) {
+                                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                    isMapReady = pollTransitionMap(samuraiPosition);
+                                }
 
-                    map = LoadTMX("maps/Room4.tmx");
-                    if (!map) 
-                    {
-                        std::cerr << "Failed to load Room4.tmx!" << std::endl;
-                    }
+                                TmxMap* nextMap = transitionMap;
+                                if (!nextMap) 
+                                {
+                                    nextMap = mapCache.insert(mapLoader.getFileName(), mapLoader.finish());
+                                }
+                                if (!nextMap) 
+                                {
+                                    GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_MAP, "Failed to load %s", transitionMapFileName.c_str());
+                                    safeExit();
+                                }
 
-                    Rectangle newPos = samurai.getRect();
-                    newPos.x = 665;
-                    newPos.y = 2222;
-                    samurai.setRect(newPos);
+                                // The previous map stays in the cache in case the player comes back
+                                transitionMap = NULL;
+                                mapCache.pin(nextMap);
+                                map = nextMap;
+                                currentMapFileName = transitionMapFileName;
+                                bindMapLayers();
 
-                    camera.target = { newPos.x, newPos.y };
-                    });  
-                }
-                
-                // Room 4 to Main Level
-                if (!mapSwitchedToMainLevel2 && mapSwitchedToRoom4 && samuraiRect.x >= 3050 && samuraiRect.x <= 3070 && samuraiRect.y >= 2170.00) 
-                {
-                    startTransition([&]() 
-                    {
-                        mapSwitchedToRoom4 = false;
+                                if (transitionAction) 
+                                {
+                                    transitionAction();  // run the map change
+                                }
 
-                        if (map) 
-                        {
-                            UnloadTMX(map);
+                                transitionFadeIn = true;
+                            }
                         }
-
-                    map = LoadTMX("maps/LevelDesign.tmx");
-                    if (!map) 
-                    {
-                        std::cerr << "Failed to load LevelDesign.tmx!" << std::endl;
-                    }
-
-                    Rectangle newPos = samurai.getRect();
-
-                    newPos.x = 9385;
-                    newPos.y = 2062.25;
-                    samurai.setRect(newPos);
-
-                    camera.target = { newPos.x, newPos.y };
-                    });  
-                }
-
-                // Main Level to Main Level 2
-                if (!mapSwitchedToMainLevel2 && samuraiRect.x >= 18760 && samuraiRect.x <= 18840 && samuraiRect.y >= 3660) 
-                {
-                    startTransition([&]() 
+                    } 
+                    else 
                     {
-                        mapSwitchedToMainLevel2 = true;
-
-                        if (map) 
+                        transitionAlpha -= 0.02f;
+                        if (transitionAlpha <= 0.0f) 
                         {
-                            UnloadTMX(map);
+                            transitionAlpha = 0.0f;
+                            isTransitioning = false;
+                            
+                            // Check if we just entered Room3 and trigger dialogue if needed
+                            if (arrivalEvent == PORTAL_EVENT_DIALOGUE && !showDialogue) {
+                                triggerRoom3Dialogue();
+                                GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_GAME, "Dialogue triggered after transition: %s",
+                                         dialogueText.c_str());
+                            }
                         }
-
-                    map = LoadTMX("maps/LevelDesign2.tmx");
-                    if (!map) 
-                    {
-                        std::cerr << "Failed to load LevelDesign2.tmx!" << std::endl;
-                    }
-
-                    Rectangle newPos = samurai.getRect();
-                    newPos.x = 200;
-                    newPos.y = 1500;
-                    samurai.setRect(newPos);
-
-                    camera.target = { newPos.x, newPos.y };
-                    });  
-                }
-                
-                if (mapSwitchedToMainLevel2 && !mapSwitchedToRoom5 && 
-                    samuraiRect.x > 4400 && samuraiRect.x < 4430 && 
-                    samuraiRect.y > 2760 && samuraiRect.y < 2780) 
-                   {
-                    startTransition([&]() {
-                    mapSwitchedToRoom5 = true;
-
-                    // Unload current map
-                    if (map) {
-                     UnloadTMX(map);
-                    }
-
-                    // Load new TMX map (e.g., Room5)
-                    
-                    map = LoadTMX("maps/Lv2RoomOne.tmx");
-                    if (!map) {
-                        std::cerr << "Failed to load Room5.tmx!" << std::endl;
                     }
-                    
-
-                    // Set Samurai position to destination portal
-                    Rectangle newPos = samurai.getRect();
-                    newPos.x = 0;  // Adjust to coordinates of portal in Room5
-                    newPos.y = 224;
-                    samurai.setRect(newPos);
-
-                     // Recenter camera
-                    camera.target = { newPos.x, newPos.y };
-                     });
                 }
 
-                // New portal (e.g., Room5 -> Level2)
-                if (mapSwitchedToMainLevel2 && mapSwitchedToRoom5 &&
-                    samuraiRect.x > 1000 && samuraiRect.x < 1100 &&
-                    samuraiRect.y > 1200 && samuraiRect.y < 1300) 
-                {
-             
-                    startTransition([&]() {
-                    mapSwitchedToRoom5 = false;
-
-                 if (map) {
-                    UnloadTMX(map);
-                }
-
-                    map = LoadTMX("maps/LevelDesign2.tmx");
-
-                    Rectangle newPos = samurai.getRect();
-                    newPos.x = 3820;   // back to original portal
-                    newPos.y = 1218.77;
-                    samurai.setRect(newPos);
-
-                    camera.target = { newPos.x, newPos.y };
-                    });
-                }
-
-
-                // New portal (e.g., Level2 -> Room6)
-                if (mapSwitchedToMainLevel2 && !mapSwitchedToRoom6 && 
-                    samuraiRect.x > 5600 && samuraiRect.x < 5700 && 
-                    samuraiRect.y > 3300 && samuraiRect.y < 3400) 
-                   {
-                    startTransition([&]() {
-                    mapSwitchedToRoom6 = true;
-
-                    // Unload current map
-                    if (map) {
-                     UnloadTMX(map);
-                    }
-
-                    // Load new TMX map 
-                    
-                    map = LoadTMX("maps/Lv2RoomTwo.tmx");
-                    if (!map) {
-                        std::cerr << "Failed to load Lv2RoomTwo.tmx!" << std::endl;
-                    }
-                    
-
-                    // Set Samurai position to destination portal
-                    Rectangle newPos = samurai.getRect();
-                    newPos.x = 0;  // Adjust to coordinates of portal in Room5
-                    newPos.y = 224;
-                    samurai.setRect(newPos);
-
-                     // Recenter camera
-                    camera.target = { newPos.x, newPos.y };
-                     });
-                }
-
-
-               // New portal (e.g., Room6 -> Level2)
-                if (mapSwitchedToMainLevel2 && mapSwitchedToRoom6 && 
-                    samuraiRect.x > 1600 && samuraiRect.x < 1610 && 
-                    samuraiRect.y > 3300 && samuraiRect.y < 3500) 
-                   {
-                    startTransition([&]() {
-                    mapSwitchedToRoom6 = false;
-
-                    // Unload current map
-                    if (map) {
-                     UnloadTMX(map);
-                    }
-
-                    // Load new TMX map 
-                    
-                    map = LoadTMX("maps/LevelDesign2.tmx");
-                    if (!map) {
-                        std::cerr << "Failed to load Room5.tmx!" << std::endl;
-                    }
-                    
-
-                    // Set Samurai position to destination portal
-                    Rectangle newPos = samurai.getRect();
-                    newPos.x = 8390;  // Adjust to coordinates of portal in Room6
-                    newPos.y = 1313.78;
-                    samurai.setRect(newPos);
-
-                     // Recenter camera
-                    camera.target = { newPos.x, newPos.y };
-                     });
-                }
+                if (showDialogue) {
+                    // Update dialogue timer
+                    dialogueTimer += GetFrameTime();
 
-                                
-                                   
-                // New portal (e.g., Level2 -> Room7)
-                if (mapSwitchedToMainLevel2 && !mapSwitchedToRoom7 && 
-                    samuraiRect.x > 7500 && samuraiRect.x < 7580 && 
-                    samuraiRect.y > 2900 && samuraiRect.y < 3000) 
-                   {
-                    startTransition([&]() {
-                    mapSwitchedToRoom5 = true;
-
-                    // Unload current map
-                    if (map) {
-                     UnloadTMX(map);
+                    // Print debug info when F2 is pressed
+                    if (input.isKeyPressed(KEY_F2)) {
+                        GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_GAME, "Dialogue active: %s (Timer: %.2f/%.2f)",
+                                 dialogueText.c_str(), dialogueTimer, dialogueDuration);
                     }
 
-                    // Load new TMX map (e.g., Room5)
-                    
-                    map = LoadTMX("maps/Lv2Room3.tmx");
-                    if (!map) {
-                        std::cerr << "Failed to load Room5.tmx!" << std::endl;
+                    // Hide dialogue after duration expires
+                    if (dialogueTimer >= dialogueDuration) {
+                        showDialogue = false;
+                        dialogueTimer = 0.0f;
+                        GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_GAME, "Dialogue ended.");
                     }
-                    
-
-                    // Set Samurai position to destination portal
-                    Rectangle newPos = samurai.getRect();
-                    newPos.x = 0;  // Adjust to coordinates of portal in Room5
-                    newPos.y = 224;
-                    samurai.setRect(newPos);
-
-                     // Recenter camera
-                    camera.target = { newPos.x, newPos.y };
-                     });
                 }
 
-                // New portal (e.g., Level2 -> Room8)
-                if (mapSwitchedToMainLevel2 && !mapSwitchedToRoom7 && 
-                    samuraiRect.x > 9100 && samuraiRect.x < 9200 && 
-                    samuraiRect.y > 2000 && samuraiRect.y < 2100) 
-                   {
-                    startTransition([&]() {
-                    mapSwitchedToRoom5 = true;
-
-                    // Unload current map
-                    if (map) {
-                     UnloadTMX(map);
-                    }
-
-                    // Load new TMX map (e.g., Room5)
-                    
-                    map = LoadTMX("maps/Lv2Room4.tmx");
-                    if (!map) {
-                        std::cerr << "Failed to load Room5.tmx!" << std::endl;
-                    }
-                    
-
-                    // Set Samurai position to destination portal
-                    Rectangle newPos = samurai.getRect();
-                    newPos.x = 0;  // Adjust to coordinates of portal in Room5
-                    newPos.y = 224;
-                    samurai.setRect(newPos);
-
-                     // Recenter camera
-                    camera.target = { newPos.x, newPos.y };
-                     });
-                }
-                
-                if(samurai.checkDeath()) {
-                    gameover = true;
-                }
-                
-
-                if(mapSwitchedToMainLevel2 && samurai.getRect().x >= 12610 && samurai.getRect().x <= 12655 && samuraiRect.y >= 2304) {
-                    isComplete = true;
-                }
-                
+#ifndef HEADLESS
                 // Begin drawing
                 BeginDrawing();
                 ClearBackground(BLACK);
@@ -864,109 +826,30 @@ int main()
                 BeginMode2D(camera);
                 
                 // Draw Background.
-                for (int x = 0; x < tilesX; x++) {
-                    for (int y = 0; y < tilesY; y++) {
-                        float posX = x * scaledW;
-                        float posY = y * scaledH;
-                        
-                        DrawTextureEx(background, Vector2{posX + bgposX, posY + bgposY}, 0.0f, scalebg, GRAY);
-                    }
+                {
+                    PROFILE_SCOPE(profiler, PROFILE_BACKGROUND);
+                    backgroundLayers.draw(camera);
                 }
                 
-                renderLevel();
+                {
+                    PROFILE_SCOPE(profiler, PROFILE_RENDER_LEVEL);
+                    renderLevel();
+                }
                 
                 // Draw Samurai.
-                samurai.draw();
+                samurai.draw(alpha);
                 
-                // Update and draw demon if in Room2
-                if (mapSwitchedToRoom2 && demon != nullptr) {
-                    // Update demon animation
-                    demon->updateAnimation();
-                    
-                    // Update demon AI behavior
-                    if (!demon->isDead && !isPaused) {
-                        // Get distance to player
-                        Rectangle demonRect = demon->rect;
-                        Vector2 demonPos = { demonRect.x + demonRect.width/2, demonRect.y + demonRect.height/2 };
-                        Vector2 samuraiPos = { samuraiRect.x + samuraiRect.width/2, samuraiRect.y + samuraiRect.height/2 };
-                        float distance = Vector2Distance(demonPos, samuraiPos);
-                        
-                        // Chase player if within range
-                        if (distance < demon->chaseRange && distance > demon->attackRange) {
-                            demon->state = WALK_DEMON;
-                            demon->direction = (samuraiPos.x < demonPos.x) ? LEFT_DEMON : RIGHT_DEMON;
-                            
-                            // Move toward player
-                            float moveDir = (demon->direction == LEFT_DEMON) ? -1.0f : 1.0f;
-                            demon->velocity.x = moveDir * demon->moveSpeed * 100.0f;
-                        } 
-                        // Attack if close enough
-                        else if (distance <= demon->attackRange) {
-                            if (!demon->isAttacking) {
-                                demon->attack();
-                            }
-                        }
-                        // Idle if too far
-                        else {
-                            demon->state = IDLE_DEMON;
-                            demon->velocity.x = 0;
-                        }
-                        
-                        // Apply velocity
-                        demon->applyVelocity();
-                    }
-                    
-                    // Draw the demon
-                    demon->draw();
-                    
-                    // Check for collision between Samurai's attack and demon
-                    CollisionBox* samuraiAttack = samurai.getCollisionBox(ATTACK);
-                    if (samuraiAttack && samuraiAttack->active) {
-                        for (auto& box : demon->collisionBoxes) {
-                            if (box.type == HURTBOX && box.active) {
-                                if (checkCharacterCollision(*samuraiAttack, box)) {
-                                    demon->takeDamage(25); // Samurai deals 25 damage
-                                    //samuraiAttack->active = false; // Prevent multiple hits
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                    
-                    // Check for collision between demon's attack and Samurai
-                    CollisionBox* samuraiHurtbox = samurai.getCollisionBox(HURTBOX);
-                    for (auto& box : demon->collisionBoxes) {
-                        if (box.type == ATTACK && box.active) {
-                            if (samuraiHurtbox && samuraiHurtbox->active) {
-                                if (checkCharacterCollision(box, *samuraiHurtbox)) {
-                                    // Check if samurai is blocking to reduce damage
-                                    if (samurai.isBlocking()) {
-                                        // Apply damage reduction when blocking (half damage)
-                                        int reducedDamage = static_cast<int>(15 * samurai.getBlockDamageReduction());
-                                        samurai.takeDamage(reducedDamage);
-                                        std::cout << "Blocked attack! Reduced damage: " << reducedDamage << std::endl;
-                                    } else {
-                                        samurai.takeDamage(15); // Full damage when not blocking
-                                    }
-                                    box.active = false; // Prevent multiple hits
-                                    break;
-                                }
-                            }
-                        }
-                    }
+                // Draw demon if in Room2
+                if (arrivalEvent == PORTAL_EVENT_DEMON_ROOM && demon != nullptr) {
+                    PROFILE_SCOPE(profiler, PROFILE_DEMON_AI);
+                    demon->draw(alpha);
                 }
 
-                std::cout << "X: " << samurai.getRect().x << std::endl;
-                std::cout << "Y: " << samurai.getRect().y << std::endl;
-
                 // End camera mode and finalize drawing
                 EndMode2D();
                 
                 // Draw dialogue textbox after 2D mode
                 if (showDialogue) {
-                    // Update dialogue timer
-                    dialogueTimer += GetFrameTime();
-                    
                     // Create a visually appealing dialogue box with fixed screen coordinates (not affected by camera)
                     int boxWidth = 800;
                     int boxHeight = 120; // Slightly taller for better visibility
@@ -983,19 +866,6 @@ int main()
                     
                     // Draw the dialogue text centered in the box
                     DrawText(dialogueText.c_str(), boxX + 20, boxY + 50, 24, WHITE);
-
-                    // Print debug info when F2 is pressed
-                    if (IsKeyPressed(KEY_F2)) {
-                        printf("Dialogue active: %s (Timer: %.2f/%.2f)\n", 
-                               dialogueText.c_str(), dialogueTimer, dialogueDuration);
-                    }
-
-                    // Hide dialogue after duration expires
-                    if (dialogueTimer >= dialogueDuration) {
-                        showDialogue = false;
-                        dialogueTimer = 0.0f;
-                        printf("Dialogue ended.\n");
-                    }
                 }
 
 
@@ -1011,6 +881,38 @@ int main()
                 DrawText("Double-tap A/D: Dash", 10, instructionsY + lineHeight*4, 20, WHITE);
                 DrawText("M: Toggle music", 10, instructionsY + lineHeight*5, 20, WHITE);
                 DrawText("P: Pause", 10, instructionsY + lineHeight*6, 20, WHITE);
+                DrawText("F3: Frame time profiler", 10, instructionsY + lineHeight*7, 20, WHITE);
+
+                // Map cache statistics alongside the collision boxes debug view
+                if (showCollisionBoxes) {
+                    DrawText(TextFormat("Map cache: %d maps, %.1f/%.1f MB, %u hits, %u misses, %u evictions",
+                                        (int)mapCache.getMapCount(), mapCache.getResidentBytes() / (1024.0 * 1024.0),
+                                        mapCache.getBudget() / (1024.0 * 1024.0), mapCache.getHits(),
+                                        mapCache.getMisses(), mapCache.getEvictions()),
+                             10, instructionsY + lineHeight*8, 20, YELLOW);
+                    DrawText(TextFormat("Prefetch: %u issued, %u/%u transitions hit (%.0f%%), %u wasted",
+                                        mapPrefetcher.getIssued(), mapPrefetcher.getHits(),
+                                        mapPrefetcher.getTransitions(), mapPrefetcher.getHitRate() * 100.0f,
+                                        mapPrefetcher.getWasted()),
+                             10, instructionsY + lineHeight*9, 20, YELLOW);
+                    TmxChunkCacheStats chunkStats = GetTMXChunkCacheStats();
+                    DrawText(TextFormat("Tile chunks: %u drawn, %u resident (%.1f/%.1f MB), %u rasterized, %u evicted",
+                                        chunkStats.drawnChunks, chunkStats.residentChunks,
+                                        chunkStats.residentBytes / (1024.0 * 1024.0),
+                                        chunkStats.budgetBytes / (1024.0 * 1024.0), chunkStats.rasterizedChunks,
+                                        chunkStats.evictedChunks),
+                             10, instructionsY + lineHeight*10, 20, YELLOW);
+                    TmxTileBatchStats batchStats = GetTMXTileBatchStats();
+                    DrawText(TextFormat("Tile batches: %u quads in %u draws",
+                                        batchStats.submittedQuads, batchStats.submittedBatches),
+                             10, instructionsY + lineHeight*11, 20, YELLOW);
+                    AssetManager& assets = getAssetManager();
+                    DrawText(TextFormat("Assets: %d resident, %.1f MB VRAM, %.1f MB RAM, %u loads, %u cache hits",
+                                        (int)assets.getAssetCount(), assets.getVramBytes() / (1024.0 * 1024.0),
+                                        assets.getRamBytes() / (1024.0 * 1024.0), assets.getLoads(),
+                                        assets.getHits()),
+                             10, instructionsY + lineHeight*12, 20, YELLOW);
+                }
                 
                 if (isPaused) {
                     DrawRectangle(0, 0, GetScreenWidth(), GetScreenHeight(), Fade(BLACK, 0.5f));
@@ -1028,7 +930,7 @@ int main()
                     DrawText("Exit", GetScreenWidth()/2 - 20, GetScreenHeight()/2 + 70, 20, WHITE);
 
                     // Check if the exit button is clicked
-                    if (CheckCollisionPointRec(GetMousePosition(), exitButton) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+                    if (CheckCollisionPointRec(input.getMousePosition(), exitButton) && input.isMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
                         safeExit();
                     }
 
@@ -1051,19 +953,19 @@ int main()
                                             200.0f, 50.0f };
 
                     // Draw the exit button with a hover effect
-                    Color exitButtonColor = CheckCollisionPointRec(GetMousePosition(), exitButton) ? LIGHTGRAY : DARKGRAY;
+                    Color exitButtonColor = CheckCollisionPointRec(input.getMousePosition(), exitButton) ? LIGHTGRAY : DARKGRAY;
                     DrawRectangleRec(exitButton, exitButtonColor);
                     DrawText("Exit", centerX - MeasureText("Exit", 25) / 2, centerY + 75, 25, WHITE);
 
                     // Check if the exit button is clicked
-                    if (CheckCollisionPointRec(GetMousePosition(), exitButton) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+                    if (CheckCollisionPointRec(input.getMousePosition(), exitButton) && input.isMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
                         if (startScreen.ShouldStartGame()) {
                             safeExit();
                         }
                     }
 
                     // Handle key press for exiting
-                    if (IsKeyPressed(KEY_E)) {
+                    if (input.isKeyPressed(KEY_E)) {
                         if (startScreen.ShouldStartGame()) {
                             safeExit();
                         }
@@ -1086,17 +988,17 @@ int main()
                                             200.0f, 50.0f };
 
                     // Draw the Exit button with hover effect
-                    Color exitButtonColor = CheckCollisionPointRec(GetMousePosition(), exitButton) ? LIGHTGRAY : DARKGRAY;
+                    Color exitButtonColor = CheckCollisionPointRec(input.getMousePosition(), exitButton) ? LIGHTGRAY : DARKGRAY;
                     DrawRectangleRec(exitButton, exitButtonColor);
                     DrawText("Exit", centerX - MeasureText("Exit", 25) / 2, centerY + 45, 25, WHITE);
 
                     // Check if the Exit button is clicked
-                    if (CheckCollisionPointRec(GetMousePosition(), exitButton) && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+                    if (CheckCollisionPointRec(input.getMousePosition(), exitButton) && input.isMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
                         safeExit(); // Close the game window
                     }
 
                     // Handle key press for exiting
-                    if (IsKeyPressed(KEY_E)) {
+                    if (input.isKeyPressed(KEY_E)) {
                         safeExit();
                     }
                 }
@@ -1105,46 +1007,36 @@ int main()
                     samurai.resumeSound();
                 }
                 
-                if (isTransitioning) 
-                {
+                if (isTransitioning) {
                     DrawRectangle(0, 0, screenWidth, screenHeight, Fade(BLACK, transitionAlpha));
-                    if (!transitionFadeIn) 
-                    {
-                        transitionAlpha += 0.02f;
-                        if (transitionAlpha >= 1.0f) 
-                        {
-                            transitionAlpha = 1.0f;
-
-                            if (transitionAction) 
-                            {
-                                transitionAction();  // run the map change
-                            }
+                }
 
-                            transitionFadeIn = true;
-                        }
-                    } 
-                    else 
-                    {
-                        transitionAlpha -= 0.02f;
-                        if (transitionAlpha <= 0.0f) 
-                        {
-                            transitionAlpha = 0.0f;
-                            isTransitioning = false;
-                            
-                            // Check if we just entered Room3 and trigger dialogue if needed
-                            if (mapSwitchedToRoom3 && !showDialogue) {
-                                triggerRoom3Dialogue();
-                                printf("Dialogue triggered after transition: %s\n", dialogueText.c_str());
-                            }
-                        }
-                    }
+                if (profiler.isVisible) {
+                    profiler.drawOverlay(GetScreenWidth() - 490, 10, 480, 240);
                 }
                 
-                EndDrawing();
-
+                {
+                    PROFILE_SCOPE(profiler, PROFILE_END_DRAWING);
+                    EndDrawing();
+                }
+#endif // HEADLESS
 
                 break;
             }
         }
     }
+
+    input.stop();
+
+#ifdef HEADLESS
+    getHeadlessBackend().report();
+    getAssetManager().report();
+    getAudioMixer().report();
+    GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_GAME, "Headless run ended in %s with the samurai at %.2f, %.2f",
+             currentMapFileName.c_str(), samurai.getRect().x, samurai.getRect().y);
+#endif
+
+    getMusicPlayer().shutdown();
+    getAudioMixer().clear();
+    delete demon; // Releases its share of the assets before the samurai's go
 }
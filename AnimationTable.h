@@ -0,0 +1,86 @@
+#ifndef ANIMATION_TABLE_H
+#define ANIMATION_TABLE_H
+
+#include "raylib.h"
+#include "AtlasPacker.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @file AnimationTable.h
+ * @brief Compile-time tables describing a character's animations.
+ *
+ * Each character lists its animations once, as constexpr data: where the
+ * frames are in the sprite sheets, how long each frame lasts, whether the
+ * animation loops and on which frames its attack hitbox is active. Where each
+ * animation starts in the character's frame table is worked out by the
+ * compiler, so looking up a frame to draw is a single index into the atlas's
+ * frames.
+ */
+
+/**
+ * @struct AnimationClip
+ * @brief One animation: a row of equally sized frames in a sprite sheet and how they play.
+ */
+struct AnimationClip {
+    const char* sheet;     ///< Image file of the sprite sheet.
+    int frameWidth;        ///< Width of a frame in pixels.
+    int frameHeight;       ///< Height of a frame in pixels.
+    int row;               ///< Row of the sheet the frames are in.
+    int frameCount;        ///< Number of frames.
+    float frameTime;       ///< Seconds each frame is shown.
+    bool isLooping;        ///< Starts over after the last frame, rather than holding it.
+    int firstActiveFrame;  ///< First frame the attack hitbox is active on, or -1 if it never is.
+    int lastActiveFrame;   ///< Last frame the attack hitbox is active on, or -1 if it never is.
+
+    /**
+     * @brief Checks whether the attack hitbox is active on a frame.
+     */
+    constexpr bool isHitboxActive(int frame) const {
+        return frame >= firstActiveFrame && frame <= lastActiveFrame;
+    }
+};
+
+/**
+ * @struct AnimationTable
+ * @brief A character's animations, indexed by its state, with where each starts among all their frames.
+ */
+template <size_t N>
+struct AnimationTable {
+    AnimationClip clips[N];
+    int firstFrames[N]; ///< Index of each animation's first frame among the frames of the whole table.
+    int frameCount;     ///< Frames of all the animations together.
+
+    constexpr AnimationTable(const AnimationClip (&source)[N]) : clips(), firstFrames(), frameCount(0) {
+        for (size_t i = 0; i < N; i++) {
+            clips[i] = source[i];
+            firstFrames[i] = frameCount;
+            frameCount += source[i].frameCount;
+        }
+    }
+
+    constexpr size_t size() const { return N; }
+
+    /**
+     * @brief Gets the index of a frame of an animation among the frames of the whole table.
+     * @param animation Index of the animation. Must be valid.
+     * @param frame Frame within the animation. Must be within its frame count.
+     */
+    constexpr int getFrameIndex(int animation, int frame) const {
+        return firstFrames[animation] + frame;
+    }
+
+    /**
+     * @brief Lists the animations as sheets for packAtlas(), in table order.
+     */
+    std::vector<AtlasSheet> getSheets() const {
+        std::vector<AtlasSheet> sheets;
+        for (size_t i = 0; i < N; i++) {
+            sheets.push_back({ clips[i].sheet, clips[i].frameWidth, clips[i].frameHeight, clips[i].row,
+                               clips[i].frameCount });
+        }
+        return sheets;
+    }
+};
+
+#endif // ANIMATION_TABLE_H
@@ -0,0 +1,276 @@
+#ifndef ASSET_MANAGER_H
+#define ASSET_MANAGER_H
+
+#include "raylib.h"
+#include "Log.h"
+#include "AtlasPacker.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file AssetManager.h
+ * @brief Loads each texture, sound and atlas once, however many characters use it.
+ *
+ * Assets are cached by path and handed out as handles. Every acquire adds a
+ * reference and every release drops one; the asset is unloaded when the last
+ * reference goes. Spawning another character of a kind already on screen
+ * therefore costs a hash lookup instead of reading and decoding its sprite
+ * sheets and sounds again. The manager also tracks how much VRAM and RAM each
+ * resident asset takes.
+ */
+
+/// Index of an asset in the AssetManager, valid from acquire until the matching release.
+typedef int AssetHandle;
+
+const AssetHandle INVALID_ASSET_HANDLE = -1;
+
+/**
+ * @enum AssetType
+ * @brief Kind of data an asset holds.
+ */
+enum AssetType {
+    ASSET_TEXTURE, ///< A Texture2D in VRAM.
+    ASSET_SOUND,   ///< A Sound whose samples are kept in RAM.
+    ASSET_ATLAS    ///< An Atlas packed from sprite sheets, in VRAM.
+};
+
+/**
+ * @class AssetManager
+ * @brief Reference-counted cache of textures and sounds keyed by path, and of atlases keyed by name.
+ *
+ * Must be used from the main thread, as loading textures needs the OpenGL context.
+ */
+class AssetManager {
+public:
+    AssetManager() = default;
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    ~AssetManager() {
+        if (getAssetCount() > 0) {
+            GAME_LOG(LOG_LEVEL_WARNING, LOG_CATEGORY_GAME, "Asset manager: %d assets still referenced at exit",
+                     (int)getAssetCount());
+        }
+    }
+
+    /**
+     * @brief Gets a texture, loading it on first use.
+     * @param path Path of the image file.
+     * @return A handle to release once done. A texture that failed to load still gets a handle, with an ID of 0.
+     */
+    AssetHandle acquireTexture(const std::string& path) {
+        return acquire(ASSET_TEXTURE, path);
+    }
+
+    /**
+     * @brief Gets a sound, loading it on first use.
+     * @param path Path of the audio file.
+     * @return A handle to release once done. A sound that failed to load still gets a handle, with no frames.
+     */
+    AssetHandle acquireSound(const std::string& path) {
+        return acquire(ASSET_SOUND, path);
+    }
+
+    /**
+     * @brief Gets an atlas, packing it from its sprite sheets on first use.
+     * @param name Name the atlas is cached under, such as the character it is for.
+     * @param sheets Animations to pack. Only read when the atlas isn't resident yet.
+     * @return A handle to release once done. An atlas that failed to pack still gets a handle, with no frames.
+     */
+    AssetHandle acquireAtlas(const std::string& name, const std::vector<AtlasSheet>& sheets) {
+        return acquire(ASSET_ATLAS, name, &sheets);
+    }
+
+    /**
+     * @brief Adds a reference to an asset already held, for passing it on without looking it up by path again.
+     * @return The same handle to release once done, or INVALID_ASSET_HANDLE if it wasn't a resident asset's.
+     */
+    AssetHandle retain(AssetHandle handle) {
+        if (!isValid(handle)) return INVALID_ASSET_HANDLE;
+        entries[handle].references++;
+        return handle;
+    }
+
+    /**
+     * @brief Drops a reference, unloading the asset if it was the last one.
+     * @param handle Handle from acquireTexture(), acquireSound() or acquireAtlas(). INVALID_ASSET_HANDLE is ignored.
+     */
+    void release(AssetHandle handle) {
+        if (!isValid(handle)) return;
+
+        Entry& entry = entries[handle];
+        if (--entry.references > 0) return;
+
+        if (entry.type == ASSET_TEXTURE) {
+            if (entry.texture.id != 0) UnloadTexture(entry.texture);
+            vramBytes -= entry.bytes;
+        } else if (entry.type == ASSET_SOUND) {
+            if (entry.sound.frameCount > 0) UnloadSound(entry.sound);
+            ramBytes -= entry.bytes;
+        } else {
+            if (entry.atlas.texture.id != 0) UnloadTexture(entry.atlas.texture);
+            vramBytes -= entry.bytes;
+        }
+        getHandles(entry.type).erase(entry.path);
+        GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_GAME, "Asset manager: unloaded %s", entry.path.c_str());
+
+        entry = Entry();
+        freeHandles.push_back(handle);
+    }
+
+    /**
+     * @brief Gets the texture behind a handle.
+     * @return The texture, or an empty one if the handle isn't a texture's.
+     */
+    Texture2D getTexture(AssetHandle handle) const {
+        if (!isValid(handle) || entries[handle].type != ASSET_TEXTURE) return Texture2D{};
+        return entries[handle].texture;
+    }
+
+    /**
+     * @brief Gets the sound behind a handle.
+     * @return The sound, or an empty one if the handle isn't a sound's.
+     */
+    Sound getSound(AssetHandle handle) const {
+        if (!isValid(handle) || entries[handle].type != ASSET_SOUND) return Sound{};
+        return entries[handle].sound;
+    }
+
+    /**
+     * @brief Gets the atlas behind a handle.
+     * @return The atlas, or NULL if the handle isn't an atlas's. Only valid until the next acquire.
+     */
+    const Atlas* getAtlas(AssetHandle handle) const {
+        if (!isValid(handle) || entries[handle].type != ASSET_ATLAS) return NULL;
+        return &entries[handle].atlas;
+    }
+
+    /**
+     * @brief Logs every resident asset with its references and size, then the totals.
+     */
+    void report() const {
+        for (const Entry& entry : entries) {
+            if (entry.references == 0) continue;
+            GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_GAME, "Asset manager: %-7s %6.1f KB %-4s %2d refs  %s",
+                     TYPE_NAMES[entry.type], entry.bytes / 1024.0, entry.type == ASSET_SOUND ? "RAM" : "VRAM",
+                     entry.references, entry.path.c_str());
+        }
+        GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_GAME,
+                 "Asset manager: %d assets, %.1f MB VRAM, %.1f MB RAM, %u loads, %u cache hits", (int)getAssetCount(),
+                 vramBytes / (1024.0 * 1024.0), ramBytes / (1024.0 * 1024.0), loads, hits);
+    }
+
+    /// Resident assets.
+    size_t getAssetCount() const { return textureHandles.size() + soundHandles.size() + atlasHandles.size(); }
+    size_t getVramBytes() const { return vramBytes; } ///< Estimated VRAM used by resident textures and atlases.
+    size_t getRamBytes() const { return ramBytes; }   ///< Estimated RAM used by resident sounds.
+    unsigned int getLoads() const { return loads; }   ///< Assets read from disk so far.
+    unsigned int getHits() const { return hits; }     ///< Acquires served from the cache so far.
+
+private:
+    /**
+     * @struct Entry
+     * @brief A resident asset, or a free slot when it has no references.
+     */
+    struct Entry {
+        std::string path; ///< Path of the file, or name of an atlas.
+        AssetType type = ASSET_TEXTURE;
+        Texture2D texture = {};
+        Sound sound = {};
+        Atlas atlas;
+        int references = 0;
+        size_t bytes = 0; ///< Estimated VRAM for a texture or atlas, RAM for a sound.
+    };
+
+    std::vector<Entry> entries;
+    std::vector<AssetHandle> freeHandles;                       ///< Entries free for reuse.
+    std::unordered_map<std::string, AssetHandle> textureHandles; ///< Resident textures by path.
+    std::unordered_map<std::string, AssetHandle> soundHandles;   ///< Resident sounds by path.
+    std::unordered_map<std::string, AssetHandle> atlasHandles;   ///< Resident atlases by name.
+    size_t vramBytes = 0;
+    size_t ramBytes = 0;
+    unsigned int loads = 0;
+    unsigned int hits = 0;
+
+    static constexpr const char* TYPE_NAMES[] = { "texture", "sound", "atlas" };
+
+    std::unordered_map<std::string, AssetHandle>& getHandles(AssetType type) {
+        if (type == ASSET_TEXTURE) return textureHandles;
+        return type == ASSET_SOUND ? soundHandles : atlasHandles;
+    }
+
+    // Assumes 32-bit pixels, plus a third for mipmaps if the texture has any
+    static size_t getTextureBytes(Texture2D texture) {
+        size_t bytes = (size_t)texture.width * texture.height * 4;
+        if (texture.mipmaps > 1) bytes += bytes / 3;
+        return bytes;
+    }
+
+    bool isValid(AssetHandle handle) const {
+        return handle >= 0 && handle < (AssetHandle)entries.size() && entries[handle].references > 0;
+    }
+
+    AssetHandle acquire(AssetType type, const std::string& path, const std::vector<AtlasSheet>* sheets = NULL) {
+        std::unordered_map<std::string, AssetHandle>& handles = getHandles(type);
+        std::unordered_map<std::string, AssetHandle>::iterator cached = handles.find(path);
+        if (cached != handles.end()) {
+            entries[cached->second].references++;
+            hits++;
+            return cached->second;
+        }
+
+        AssetHandle handle;
+        if (!freeHandles.empty()) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        } else {
+            handle = (AssetHandle)entries.size();
+            entries.push_back(Entry());
+        }
+
+        Entry& entry = entries[handle];
+        entry.path = path;
+        entry.type = type;
+        entry.references = 1;
+        if (type == ASSET_TEXTURE) {
+            entry.texture = LoadTexture(path.c_str());
+            entry.bytes = getTextureBytes(entry.texture);
+            vramBytes += entry.bytes;
+            if (entry.texture.id == 0) {
+                GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_GAME, "Asset manager: failed to load texture %s", path.c_str());
+            }
+        } else if (type == ASSET_SOUND) {
+            entry.sound = LoadSound(path.c_str());
+            entry.bytes = (size_t)entry.sound.frameCount * entry.sound.stream.channels * (entry.sound.stream.sampleSize / 8);
+            ramBytes += entry.bytes;
+            if (entry.sound.frameCount == 0) {
+                GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_GAME, "Asset manager: failed to load sound %s", path.c_str());
+            }
+        } else {
+            Image packed = packAtlas(*sheets, entry.atlas);
+            if (packed.data != NULL) {
+                entry.atlas.texture = LoadTextureFromImage(packed);
+                UnloadImage(packed);
+            }
+            entry.bytes = getTextureBytes(entry.atlas.texture);
+            vramBytes += entry.bytes;
+            if (entry.atlas.texture.id == 0) {
+                GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_GAME, "Asset manager: failed to pack atlas %s", path.c_str());
+            }
+        }
+        handles[path] = handle;
+        loads++;
+        return handle;
+    }
+};
+
+/**
+ * @brief Gets the asset manager shared by the whole game.
+ */
+inline AssetManager& getAssetManager() {
+    static AssetManager assets;
+    return assets;
+}
+
+#endif // ASSET_MANAGER_H
@@ -0,0 +1,326 @@
+#ifndef ATLAS_PACKER_H
+#define ATLAS_PACKER_H
+
+#include "raylib.h"
+#include "Log.h"
+#include <algorithm>
+#include <climits>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @file AtlasPacker.h
+ * @brief Packs a character's animation frames into one texture with a table of where each frame went.
+ *
+ * Frames are cut out of the character's sprite sheets, trimmed of their
+ * transparent borders, and placed with a skyline bottom-left bin packer,
+ * tallest first. Every frame of a character then comes from the same
+ * texture, so switching animations doesn't switch textures and raylib can
+ * batch all of the character's sprites. The trimmed-away borders are recorded
+ * per frame so frames are still drawn where the untrimmed frame would be.
+ */
+
+/**
+ * @struct AtlasSheet
+ * @brief One animation to pack: a row of equally sized frames in a sprite sheet.
+ */
+struct AtlasSheet {
+    const char* path; ///< Image file of the sprite sheet. Several animations may share one.
+    int frameWidth;   ///< Width of a frame in pixels.
+    int frameHeight;  ///< Height of a frame in pixels.
+    int row;          ///< Row of the sheet the animation's frames are in.
+    int frameCount;   ///< Frames in the animation, or 0 for as many as fit across the sheet.
+};
+
+/**
+ * @struct AtlasFrame
+ * @brief Where a frame is in the atlas and where its trimmed pixels sit within the original frame.
+ */
+struct AtlasFrame {
+    Rectangle source; ///< Trimmed frame within the atlas texture. Empty if the frame was fully transparent.
+    Vector2 offset;   ///< Top-left of the trimmed pixels within the original frame.
+    Vector2 size;     ///< Size of the original frame.
+};
+
+/**
+ * @struct Atlas
+ * @brief A packed texture and the frame table of each animation packed into it.
+ */
+struct Atlas {
+    Texture2D texture = {};
+    std::vector<AtlasFrame> frames;   ///< Every frame, animation by animation.
+    std::vector<int> firstFrames;     ///< Index in frames of each animation's first frame.
+    std::vector<int> frameCounts;     ///< Number of frames of each animation.
+
+    /**
+     * @brief Looks up a frame of an animation, clamping the frame to the animation's range.
+     * @param animation Index of the animation, in the order its sheet was packed.
+     * @param frame Frame within the animation.
+     * @return The frame, or NULL if the animation doesn't exist or has no frames.
+     */
+    const AtlasFrame* getFrame(int animation, int frame) const {
+        if (animation < 0 || animation >= (int)firstFrames.size() || frameCounts[animation] == 0) return NULL;
+        if (frame < 0) frame = 0;
+        if (frame >= frameCounts[animation]) frame = frameCounts[animation] - 1;
+        return &frames[firstFrames[animation] + frame];
+    }
+};
+
+/**
+ * @class SkylinePacker
+ * @brief Places rectangles in a fixed-size bin by keeping track of the skyline of the ones placed so far.
+ *
+ * Each rectangle goes where its top edge ends up lowest, which on equal
+ * heights is the narrowest gap that fits it.
+ */
+class SkylinePacker {
+public:
+    SkylinePacker(int width, int height) : width(width), height(height) {
+        skyline.push_back({ 0, 0, width });
+    }
+
+    /**
+     * @brief Places a rectangle.
+     * @param rectWidth Width of the rectangle.
+     * @param rectHeight Height of the rectangle.
+     * @param x Set to the left of the place found.
+     * @param y Set to the top of the place found.
+     * @return False if the rectangle no longer fits anywhere in the bin.
+     */
+    bool insert(int rectWidth, int rectHeight, int* x, int* y) {
+        int bestIndex = -1;
+        int bestTop = INT_MAX;
+        int bestWidth = INT_MAX;
+        for (size_t i = 0; i < skyline.size(); i++) {
+            int top = fit(i, rectWidth, rectHeight);
+            if (top < 0) continue;
+            if (top + rectHeight < bestTop || (top + rectHeight == bestTop && skyline[i].width < bestWidth)) {
+                bestIndex = (int)i;
+                bestTop = top + rectHeight;
+                bestWidth = skyline[i].width;
+            }
+        }
+        if (bestIndex < 0) return false;
+
+        *x = skyline[bestIndex].x;
+        *y = bestTop - rectHeight;
+        addLevel(bestIndex, *x, bestTop, rectWidth);
+        return true;
+    }
+
+private:
+    /**
+     * @struct Segment
+     * @brief A horizontal stretch of the skyline.
+     */
+    struct Segment {
+        int x, y, width;
+    };
+
+    int width;
+    int height;
+    std::vector<Segment> skyline; ///< Left to right, covering the whole width of the bin.
+
+    /**
+     * @brief Finds how low a rectangle can sit with its left edge at the start of a segment.
+     * @return The top of the rectangle, or -1 if it doesn't fit there.
+     */
+    int fit(size_t index, int rectWidth, int rectHeight) const {
+        if (skyline[index].x + rectWidth > width) return -1;
+
+        int top = 0;
+        int widthLeft = rectWidth;
+        for (size_t i = index; widthLeft > 0; i++) {
+            top = std::max(top, skyline[i].y);
+            if (top + rectHeight > height) return -1;
+            widthLeft -= skyline[i].width;
+        }
+        return top;
+    }
+
+    /**
+     * @brief Raises the skyline under a rectangle just placed, merging neighbouring segments of the same height.
+     */
+    void addLevel(int index, int x, int y, int levelWidth) {
+        skyline.insert(skyline.begin() + index, { x, y, levelWidth });
+
+        // Cut back the segments the new one now covers
+        for (size_t i = index + 1; i < skyline.size(); i++) {
+            int overlap = skyline[i - 1].x + skyline[i - 1].width - skyline[i].x;
+            if (overlap <= 0) break;
+            skyline[i].x += overlap;
+            skyline[i].width -= overlap;
+            if (skyline[i].width > 0) break;
+            skyline.erase(skyline.begin() + i);
+            i--;
+        }
+
+        for (size_t i = 0; i + 1 < skyline.size(); i++) {
+            if (skyline[i].y == skyline[i + 1].y) {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+                i--;
+            }
+        }
+    }
+};
+
+/// Transparent pixels kept around each frame, so filtering never samples a neighbouring frame.
+const int ATLAS_PADDING = 1;
+
+/// Largest atlas side tried before giving up, well within what any GPU that runs the game supports.
+const int ATLAS_MAX_SIZE = 8192;
+
+/**
+ * @brief Cuts the frames of some sprite sheets, trims them and packs them into one image.
+ * @param sheets Animations to pack. Their order is the order of the atlas's animations.
+ * @param atlas Filled with the frame table. Its texture is left for the caller to upload.
+ * @return The packed image, to upload and then unload, or an image without data if nothing could be packed.
+ */
+inline Image packAtlas(const std::vector<AtlasSheet>& sheets, Atlas& atlas) {
+    /**
+     * @struct PendingFrame
+     * @brief A trimmed frame waiting for its place in the atlas.
+     */
+    struct PendingFrame {
+        const Image* sheet;
+        Rectangle trimmed; ///< Trimmed pixels within the sheet.
+        int x, y;          ///< Place found in the atlas.
+    };
+
+    std::map<std::string, Image> images; // Sheets by path, loaded once however many animations they hold
+    std::vector<PendingFrame> pending;
+    atlas.frames.clear();
+    atlas.firstFrames.clear();
+    atlas.frameCounts.clear();
+
+    for (const AtlasSheet& sheet : sheets) {
+        std::map<std::string, Image>::iterator image = images.find(sheet.path);
+        if (image == images.end()) {
+            image = images.insert(std::make_pair(std::string(sheet.path), LoadImage(sheet.path))).first;
+            if (image->second.data == NULL) {
+                GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_GAME, "Atlas: failed to load %s", sheet.path);
+            }
+        }
+
+        int frameCount = sheet.frameCount > 0 ? sheet.frameCount : image->second.width / sheet.frameWidth;
+        // A missing or smaller than expected sheet still gets its frames, empty, so frame indexes stay the same
+        bool isMissing = (sheet.row + 1) * sheet.frameHeight > image->second.height ||
+                         frameCount * sheet.frameWidth > image->second.width;
+        atlas.firstFrames.push_back((int)atlas.frames.size());
+        atlas.frameCounts.push_back(frameCount);
+
+        for (int i = 0; i < frameCount; i++) {
+            Rectangle frameRect = { (float)(i * sheet.frameWidth), (float)(sheet.row * sheet.frameHeight),
+                                    (float)sheet.frameWidth, (float)sheet.frameHeight };
+            Rectangle border = { 0.0f, 0.0f, 0.0f, 0.0f };
+            if (!isMissing) {
+                Image frameImage = ImageFromImage(image->second, frameRect);
+                border = GetImageAlphaBorder(frameImage, 0.0f);
+                UnloadImage(frameImage);
+            }
+
+            AtlasFrame frame;
+            frame.source = { 0.0f, 0.0f, border.width, border.height };
+            frame.offset = { border.x, border.y };
+            frame.size = { (float)sheet.frameWidth, (float)sheet.frameHeight };
+            atlas.frames.push_back(frame);
+
+            PendingFrame trimmed = { &image->second, { frameRect.x + border.x, frameRect.y + border.y,
+                                                       border.width, border.height }, 0, 0 };
+            pending.push_back(trimmed);
+        }
+    }
+
+    // Tallest frames first, which keeps the skyline flat
+    std::vector<int> order;
+    int area = 0;
+    int widest = 1;
+    int tallest = 1;
+    for (size_t i = 0; i < pending.size(); i++) {
+        if (pending[i].trimmed.width <= 0 || pending[i].trimmed.height <= 0) continue;
+        order.push_back((int)i);
+        int paddedWidth = (int)pending[i].trimmed.width + 2 * ATLAS_PADDING;
+        int paddedHeight = (int)pending[i].trimmed.height + 2 * ATLAS_PADDING;
+        area += paddedWidth * paddedHeight;
+        widest = std::max(widest, paddedWidth);
+        tallest = std::max(tallest, paddedHeight);
+    }
+    std::stable_sort(order.begin(), order.end(), [&pending](int a, int b) {
+        return pending[a].trimmed.height > pending[b].trimmed.height;
+    });
+
+    // Start from the smallest power-of-two size that could hold every frame and grow until they fit
+    int width = 64;
+    int height = 64;
+    while (width < widest) width *= 2;
+    while (height < tallest) height *= 2;
+    while (width * height < area) {
+        if (width <= height) width *= 2;
+        else height *= 2;
+    }
+
+    bool isPacked = false;
+    while (!isPacked && width <= ATLAS_MAX_SIZE && height <= ATLAS_MAX_SIZE) {
+        SkylinePacker packer(width, height);
+        isPacked = true;
+        for (int index : order) {
+            PendingFrame& frame = pending[index];
+            if (!packer.insert((int)frame.trimmed.width + 2 * ATLAS_PADDING,
+                               (int)frame.trimmed.height + 2 * ATLAS_PADDING, &frame.x, &frame.y)) {
+                isPacked = false;
+                if (width <= height) width *= 2;
+                else height *= 2;
+                break;
+            }
+        }
+    }
+
+    Image packed = {};
+    if (!isPacked) {
+        GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_GAME, "Atlas: %d frames don't fit in %dx%d", (int)order.size(),
+                 ATLAS_MAX_SIZE, ATLAS_MAX_SIZE);
+        for (AtlasFrame& frame : atlas.frames) frame.source = { 0.0f, 0.0f, 0.0f, 0.0f };
+    } else if (!order.empty()) {
+        packed = GenImageColor(width, height, BLANK);
+        for (int index : order) {
+            const PendingFrame& frame = pending[index];
+            Rectangle destination = { (float)(frame.x + ATLAS_PADDING), (float)(frame.y + ATLAS_PADDING),
+                                      frame.trimmed.width, frame.trimmed.height };
+            ImageDraw(&packed, *frame.sheet, frame.trimmed, destination, WHITE);
+            atlas.frames[index].source.x = destination.x;
+            atlas.frames[index].source.y = destination.y;
+        }
+        GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_GAME, "Atlas: packed %d frames into %dx%d, %.0f%% used",
+                 (int)order.size(), width, height, 100.0f * area / ((float)width * height));
+    }
+
+    for (std::map<std::string, Image>::iterator it = images.begin(); it != images.end(); ++it) {
+        if (it->second.data != NULL) UnloadImage(it->second);
+    }
+    return packed;
+}
+
+/**
+ * @brief Draws an atlas frame into the rectangle the whole, untrimmed frame would cover.
+ * @param texture The atlas texture.
+ * @param frame Frame from the atlas's table.
+ * @param dest Where the untrimmed frame goes on screen.
+ * @param isFlipped Mirrors the frame horizontally.
+ * @param tint Color to tint the frame with.
+ */
+inline void drawAtlasFrame(Texture2D texture, const AtlasFrame& frame, Rectangle dest, bool isFlipped, Color tint) {
+    if (frame.source.width <= 0.0f || frame.source.height <= 0.0f) return;
+
+    float scaleX = dest.width / frame.size.x;
+    float scaleY = dest.height / frame.size.y;
+    float offsetX = isFlipped ? frame.size.x - frame.offset.x - frame.source.width : frame.offset.x;
+    Rectangle source = frame.source;
+    if (isFlipped) source.width = -source.width;
+    Rectangle trimmedDest = { dest.x + offsetX * scaleX, dest.y + frame.offset.y * scaleY,
+                              frame.source.width * scaleX, frame.source.height * scaleY };
+    DrawTexturePro(texture, source, trimmedDest, (Vector2){ 0, 0 }, 0.0f, tint);
+}
+
+#endif // ATLAS_PACKER_H
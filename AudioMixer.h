@@ -0,0 +1,244 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include "raylib.h"
+#include "Log.h"
+#include "AssetManager.h"
+#include <unordered_map>
+
+/**
+ * @file AudioMixer.h
+ * @brief A fixed pool of voices that every sound effect in the game plays through.
+ *
+ * Characters ask the mixer to play a sound instead of calling PlaySound on it
+ * directly. Each voice plays an alias of a loaded sound, so several instances
+ * of one sample can overlap without loading it again, and a voice keeps its
+ * alias for the next play of the same sound. The number of voices is fixed,
+ * so however many characters make noise at once the audio thread mixes at
+ * most VOICE_COUNT sounds. When every voice is busy, the quietest-ranked
+ * sound gives way: a new sound takes over the oldest voice of the lowest
+ * priority category, provided that is no higher than its own. Each sound also
+ * has a limit on how many voices it may hold at once, and a cooldown during
+ * which repeated plays, such as the same effect triggered twice in one frame,
+ * are dropped.
+ */
+
+/**
+ * @enum SoundCategory
+ * @brief Kind of sound effect, in increasing order of priority when voices run out.
+ */
+enum SoundCategory {
+    SOUND_CATEGORY_AMBIENT,  ///< Background sounds, such as a demon's chant.
+    SOUND_CATEGORY_MOVEMENT, ///< Footsteps, jumps, landings and dashes.
+    SOUND_CATEGORY_COMBAT,   ///< Sword swings, blocks and explosions.
+    SOUND_CATEGORY_VOICE     ///< Hurt and death cries, which are never cut off by anything less important.
+};
+
+/**
+ * @struct SoundSettings
+ * @brief How the mixer treats plays of a sound.
+ */
+struct SoundSettings {
+    SoundCategory category; ///< Priority of the sound when voices run out.
+    int maxInstances;       ///< Voices the sound may hold at once. Beyond that, a play restarts its oldest voice.
+    float cooldown;         ///< Seconds after a play during which further plays of the sound are dropped.
+};
+
+/**
+ * @class AudioMixer
+ * @brief Plays sound effects on a fixed number of voices, with priorities, instance limits and cooldowns.
+ *
+ * Must be used from the main thread, like the rest of raylib's audio API.
+ */
+class AudioMixer {
+public:
+    static const int VOICE_COUNT = 16; ///< Sounds that can play at once.
+
+    AudioMixer() = default;
+    AudioMixer(const AudioMixer&) = delete;
+    AudioMixer& operator=(const AudioMixer&) = delete;
+
+    /**
+     * @brief Plays a sound on a voice, if its cooldown, instance limit and priority allow.
+     * @param sound Handle of a sound from the asset manager. The voice keeps its own reference to it.
+     * @param settings How plays of the sound are limited.
+     * @param volume Volume of this play, from 0 to 1.
+     * @return False if the play was dropped.
+     */
+    bool play(AssetHandle sound, const SoundSettings& settings, float volume = 1.0f) {
+        Sound sample = getAssetManager().getSound(sound);
+        if (sample.frameCount == 0) return false;
+
+        // Repeats within the cooldown are the same sound triggered again, not a new one
+        double now = GetTime();
+        std::unordered_map<AssetHandle, double>::iterator lastPlay = lastPlayTimes.find(sound);
+        if (lastPlay != lastPlayTimes.end() && now - lastPlay->second < settings.cooldown) {
+            dropped++;
+            return false;
+        }
+
+        int voice = findVoice(sound, settings);
+        if (voice < 0) {
+            dropped++;
+            return false;
+        }
+
+        Voice& target = voices[voice];
+        if (target.sound != sound) {
+            unloadVoice(target);
+            target.sound = getAssetManager().retain(sound);
+            target.alias = LoadSoundAlias(sample);
+        } else if (target.isPaused || IsSoundPlaying(target.alias)) {
+            StopSound(target.alias);
+        }
+        target.category = settings.category;
+        target.startTime = now;
+        target.isPaused = false;
+        SetSoundVolume(target.alias, volume);
+        PlaySound(target.alias);
+
+        lastPlayTimes[sound] = now;
+        plays++;
+        return true;
+    }
+
+    /**
+     * @brief Stops every voice playing a sound.
+     */
+    void stop(AssetHandle sound) {
+        for (Voice& voice : voices) {
+            if (voice.sound != sound) continue;
+            StopSound(voice.alias);
+            voice.isPaused = false;
+        }
+    }
+
+    /**
+     * @brief Pauses every voice playing a sound. Paused voices keep their place until resumed or stopped.
+     */
+    void pause(AssetHandle sound) {
+        for (Voice& voice : voices) {
+            if (voice.sound != sound || !IsSoundPlaying(voice.alias)) continue;
+            PauseSound(voice.alias);
+            voice.isPaused = true;
+        }
+    }
+
+    /**
+     * @brief Resumes every voice paused while playing a sound.
+     */
+    void resume(AssetHandle sound) {
+        for (Voice& voice : voices) {
+            if (voice.sound != sound || !voice.isPaused) continue;
+            ResumeSound(voice.alias);
+            voice.isPaused = false;
+        }
+    }
+
+    /**
+     * @brief Checks whether any voice is playing a sound.
+     */
+    bool isPlaying(AssetHandle sound) const {
+        for (const Voice& voice : voices) {
+            if (voice.sound == sound && IsSoundPlaying(voice.alias)) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Stops every voice and lets go of the sounds they hold. Call before closing the audio device.
+     */
+    void clear() {
+        for (Voice& voice : voices) unloadVoice(voice);
+        lastPlayTimes.clear();
+    }
+
+    /**
+     * @brief Logs how many plays went through, were dropped or took over another sound's voice.
+     */
+    void report() const {
+        GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_GAME, "Audio mixer: %u plays, %u dropped, %u voices stolen", plays,
+                 dropped, steals);
+    }
+
+    unsigned int getPlays() const { return plays; }     ///< Sounds started so far.
+    unsigned int getDropped() const { return dropped; } ///< Plays dropped by cooldowns or priority so far.
+    unsigned int getSteals() const { return steals; }   ///< Plays that cut off another sound so far.
+
+private:
+    /**
+     * @struct Voice
+     * @brief A slot the mixer plays sounds on, holding an alias of the last sound it played.
+     */
+    struct Voice {
+        AssetHandle sound = INVALID_ASSET_HANDLE; ///< Sound the alias is of, referenced until the voice moves on.
+        Sound alias = {};
+        SoundCategory category = SOUND_CATEGORY_AMBIENT;
+        double startTime = 0.0;
+        bool isPaused = false;
+    };
+
+    Voice voices[VOICE_COUNT];
+    std::unordered_map<AssetHandle, double> lastPlayTimes; ///< When each sound last started.
+    unsigned int plays = 0;
+    unsigned int dropped = 0;
+    unsigned int steals = 0;
+
+    bool isBusy(const Voice& voice) const {
+        return voice.sound != INVALID_ASSET_HANDLE && (voice.isPaused || IsSoundPlaying(voice.alias));
+    }
+
+    void unloadVoice(Voice& voice) {
+        if (voice.sound == INVALID_ASSET_HANDLE) return;
+        StopSound(voice.alias);
+        UnloadSoundAlias(voice.alias);
+        getAssetManager().release(voice.sound);
+        voice = Voice();
+    }
+
+    /**
+     * @brief Picks the voice a sound should play on.
+     * @return The voice, or -1 if every voice is busy with something more important.
+     */
+    int findVoice(AssetHandle sound, const SoundSettings& settings) {
+        int instances = 0;
+        int oldestInstance = -1;
+        int idle = -1;
+        int victim = -1;
+        for (int i = 0; i < VOICE_COUNT; i++) {
+            const Voice& voice = voices[i];
+            if (!isBusy(voice)) {
+                // An idle voice that already holds an alias of this sound saves loading another
+                if (idle < 0 || (voice.sound == sound && voices[idle].sound != sound)) idle = i;
+                continue;
+            }
+            if (voice.sound == sound) {
+                instances++;
+                if (oldestInstance < 0 || voice.startTime < voices[oldestInstance].startTime) oldestInstance = i;
+            }
+            if (victim < 0 || voice.category < voices[victim].category ||
+                (voice.category == voices[victim].category && voice.startTime < voices[victim].startTime)) {
+                victim = i;
+            }
+        }
+
+        // A sound at its limit restarts its oldest instance rather than taking another voice
+        if (instances >= settings.maxInstances && oldestInstance >= 0) return oldestInstance;
+        if (idle >= 0) return idle;
+        if (victim >= 0 && voices[victim].category <= settings.category) {
+            steals++;
+            return victim;
+        }
+        return -1;
+    }
+};
+
+/**
+ * @brief Gets the audio mixer shared by the whole game.
+ */
+inline AudioMixer& getAudioMixer() {
+    static AudioMixer mixer;
+    return mixer;
+}
+
+#endif // AUDIO_MIXER_H
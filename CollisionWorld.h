@@ -0,0 +1,271 @@
+#ifndef COLLISION_WORLD_H
+#define COLLISION_WORLD_H
+
+#include "raylib.h"
+#include "CollisionSystem.h"
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file CollisionWorld.h
+ * @brief Broad phase for collisions between the characters' collision boxes.
+ *
+ * Boxes are bucketed in a uniform grid, a spatial hash keyed by cell, with a
+ * separate grid per box type. A pair query only looks at the boxes of the
+ * second type sharing a cell with a box of the first, so it scales with the
+ * number of nearby boxes rather than with every pair of characters. Boxes are
+ * synced each step, but only those that moved to other cells, appeared or
+ * disappeared touch the grid.
+ */
+
+/// Index of a box in a CollisionWorld, stable until the box is removed.
+typedef int CollisionHandle;
+
+/**
+ * @struct CollisionPair
+ * @brief Two overlapping boxes of different owners, in the order of the types that were queried.
+ */
+struct CollisionPair {
+    int firstOwner;  ///< Owner of the box of the first type.
+    int firstIndex;  ///< Index of that box among its owner's boxes.
+    int secondOwner; ///< Owner of the box of the second type.
+    int secondIndex; ///< Index of that box among its owner's boxes.
+};
+
+/**
+ * @class CollisionWorld
+ * @brief Spatial hash of collision boxes tagged by owner and type.
+ */
+class CollisionWorld {
+public:
+    static const int TYPE_COUNT = HURTBOX + 1; ///< Number of CollisionBoxType values.
+
+    /**
+     * @brief Constructs an empty world.
+     * @param cellSize Side of a grid cell in pixels. Somewhat larger than a typical box works best.
+     */
+    explicit CollisionWorld(float cellSize = 128.0f) : cellSize(cellSize) {}
+
+    /**
+     * @brief Brings an owner's boxes up to date, adding, moving or removing them as needed. Call each step.
+     * @param owner Id of the character the boxes belong to, such as an index into a list of enemies.
+     * @param boxes The owner's boxes. Their order must stay the same between calls.
+     */
+    void syncOwner(int owner, const std::vector<CollisionBox>& boxes) {
+        std::vector<CollisionHandle>& handles = ownerHandles[owner];
+        while (handles.size() > boxes.size()) {
+            remove(handles.back());
+            handles.pop_back();
+        }
+        for (size_t i = 0; i < boxes.size(); i++) {
+            if (i < handles.size()) {
+                update(handles[i], boxes[i]);
+            } else {
+                handles.push_back(add(owner, (int)i, boxes[i]));
+            }
+        }
+    }
+
+    /**
+     * @brief Removes all of an owner's boxes, for example when it leaves the map.
+     * @param owner Id the boxes were synced with.
+     */
+    void removeOwner(int owner) {
+        std::unordered_map<int, std::vector<CollisionHandle> >::iterator it = ownerHandles.find(owner);
+        if (it == ownerHandles.end()) return;
+        for (CollisionHandle handle : it->second) remove(handle);
+        ownerHandles.erase(it);
+    }
+
+    /**
+     * @brief Finds every overlap between an active box of one type and an active box of another owner of a second
+     *        type, such as ATTACK against HURTBOX.
+     * @param firstType Type of the first box of each pair.
+     * @param secondType Type of the second box of each pair.
+     * @param pairs Cleared, then filled with the overlaps, each reported once, or once each way when both types
+     *              are the same.
+     */
+    void queryPairs(CollisionBoxType firstType, CollisionBoxType secondType, std::vector<CollisionPair>& pairs) const {
+        pairs.clear();
+        const Grid& secondGrid = grids[secondType];
+        for (CollisionHandle handle : typeHandles[firstType]) {
+            const Entry& first = entries[handle];
+            if (!first.isInGrid) continue;
+
+            for (int y = first.cells.minY; y <= first.cells.maxY; y++) {
+                for (int x = first.cells.minX; x <= first.cells.maxX; x++) {
+                    Grid::const_iterator cell = secondGrid.find(cellKey(x, y));
+                    if (cell == secondGrid.end()) continue;
+
+                    for (CollisionHandle otherHandle : cell->second) {
+                        const Entry& second = entries[otherHandle];
+                        if (second.owner == first.owner) continue;
+
+                        // Boxes sharing several cells are reported only from the first cell they share
+                        int firstSharedX = first.cells.minX > second.cells.minX ? first.cells.minX : second.cells.minX;
+                        int firstSharedY = first.cells.minY > second.cells.minY ? first.cells.minY : second.cells.minY;
+                        if (x != firstSharedX || y != firstSharedY) continue;
+
+                        if (CheckCollisionRecs(first.rect, second.rect)) {
+                            pairs.push_back({ first.owner, first.index, second.owner, second.index });
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    size_t getBoxCount() const { return entries.size() - freeHandles.size(); } ///< Boxes synced.
+    unsigned int getMovedCount() const { return movedCount; }                  ///< Boxes that changed cells so far.
+
+private:
+    /**
+     * @struct CellRange
+     * @brief Cells a box covers, inclusive.
+     */
+    struct CellRange {
+        int minX, minY, maxX, maxY;
+
+        bool operator==(const CellRange& other) const {
+            return minX == other.minX && minY == other.minY && maxX == other.maxX && maxY == other.maxY;
+        }
+    };
+
+    /**
+     * @struct Entry
+     * @brief A box as the world last saw it.
+     */
+    struct Entry {
+        Rectangle rect;
+        CollisionBoxType type;
+        int owner;        ///< Id of the character the box belongs to, or -1 for a free entry.
+        int index;        ///< Index of the box among its owner's boxes.
+        CellRange cells;  ///< Cells the box is listed in, if it is in the grid.
+        bool isInGrid;    ///< Only active boxes are in the grid.
+        int typeSlot;     ///< Position in typeHandles[type].
+    };
+
+    typedef std::unordered_map<int64_t, std::vector<CollisionHandle> > Grid;
+
+    float cellSize;
+    std::vector<Entry> entries;
+    std::vector<CollisionHandle> freeHandles;                             ///< Entries free for reuse.
+    std::vector<CollisionHandle> typeHandles[TYPE_COUNT];                 ///< Boxes of each type, for pair queries.
+    Grid grids[TYPE_COUNT];                                               ///< Active boxes of each type by cell.
+    std::unordered_map<int, std::vector<CollisionHandle> > ownerHandles; ///< Boxes of each owner, in its order.
+    unsigned int movedCount = 0;
+
+    static int64_t cellKey(int x, int y) {
+        return (int64_t)(((uint64_t)(uint32_t)x << 32) | (uint32_t)y);
+    }
+
+    CellRange getCells(Rectangle rect) const {
+        CellRange cells;
+        cells.minX = (int)floorf(rect.x / cellSize);
+        cells.minY = (int)floorf(rect.y / cellSize);
+        cells.maxX = (int)floorf((rect.x + rect.width) / cellSize);
+        cells.maxY = (int)floorf((rect.y + rect.height) / cellSize);
+        return cells;
+    }
+
+    CollisionHandle add(int owner, int index, const CollisionBox& box) {
+        CollisionHandle handle;
+        if (!freeHandles.empty()) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        } else {
+            handle = (CollisionHandle)entries.size();
+            entries.push_back(Entry());
+        }
+
+        Entry& entry = entries[handle];
+        entry.rect = box.rect;
+        entry.type = box.type;
+        entry.owner = owner;
+        entry.index = index;
+        entry.isInGrid = false;
+        entry.typeSlot = (int)typeHandles[box.type].size();
+        typeHandles[box.type].push_back(handle);
+        if (box.active) insertIntoGrid(handle, getCells(box.rect));
+        return handle;
+    }
+
+    void update(CollisionHandle handle, const CollisionBox& box) {
+        Entry& entry = entries[handle];
+        if (entry.type != box.type) {
+            // A box changing type is rare enough to be treated as a new box
+            int owner = entry.owner;
+            int index = entry.index;
+            remove(handle);
+            CollisionHandle newHandle = add(owner, index, box);
+            ownerHandles[owner][index] = newHandle;
+            return;
+        }
+
+        entry.rect = box.rect;
+        if (!box.active) {
+            if (entry.isInGrid) removeFromGrid(handle);
+            return;
+        }
+
+        // Only boxes that entered other cells are rehashed
+        CellRange cells = getCells(box.rect);
+        if (entry.isInGrid && entry.cells == cells) return;
+        if (entry.isInGrid) removeFromGrid(handle);
+        insertIntoGrid(handle, cells);
+        movedCount++;
+    }
+
+    void remove(CollisionHandle handle) {
+        Entry& entry = entries[handle];
+        if (entry.isInGrid) removeFromGrid(handle);
+
+        // Swap the last box of the type into this one's slot
+        std::vector<CollisionHandle>& handles = typeHandles[entry.type];
+        CollisionHandle last = handles.back();
+        handles[entry.typeSlot] = last;
+        entries[last].typeSlot = entry.typeSlot;
+        handles.pop_back();
+
+        entry.owner = -1;
+        freeHandles.push_back(handle);
+    }
+
+    void insertIntoGrid(CollisionHandle handle, const CellRange& cells) {
+        Entry& entry = entries[handle];
+        Grid& grid = grids[entry.type];
+        for (int y = cells.minY; y <= cells.maxY; y++) {
+            for (int x = cells.minX; x <= cells.maxX; x++) {
+                grid[cellKey(x, y)].push_back(handle);
+            }
+        }
+        entry.cells = cells;
+        entry.isInGrid = true;
+    }
+
+    void removeFromGrid(CollisionHandle handle) {
+        Entry& entry = entries[handle];
+        Grid& grid = grids[entry.type];
+        for (int y = entry.cells.minY; y <= entry.cells.maxY; y++) {
+            for (int x = entry.cells.minX; x <= entry.cells.maxX; x++) {
+                Grid::iterator cell = grid.find(cellKey(x, y));
+                if (cell == grid.end()) continue;
+
+                std::vector<CollisionHandle>& handles = cell->second;
+                for (size_t i = 0; i < handles.size(); i++) {
+                    if (handles[i] == handle) {
+                        handles[i] = handles.back();
+                        handles.pop_back();
+                        break;
+                    }
+                }
+                if (handles.empty()) grid.erase(cell);
+            }
+        }
+        entry.isInGrid = false;
+    }
+};
+
+#endif // COLLISION_WORLD_H
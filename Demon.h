@@ -4,6 +4,10 @@
 #include "raylib.h"
 #include "CollisionSystem.h"
 #include "CharacterAI.h" // Include the CharacterAI header
+#include "Log.h"
+#include "AssetManager.h"
+#include "AnimationTable.h"
+#include "AudioMixer.h"
 #include <vector>
 #include <iostream>
 #include <string>
@@ -40,9 +44,29 @@ struct AnimationDemon {
     AnimationTypeDemon type;
 };
 
+// Animations of each state, in state order. The sprite sheet has a row of 288x160 frames per state.
+constexpr const char* DEMON_SPRITE_SHEET = "assets/Demon/spritesheets/demon_slime_FREE_v1.0_288x160_spritesheet.png";
+constexpr AnimationClip DEMON_CLIPS[] = {
+    { DEMON_SPRITE_SHEET, 288, 160, 0, 6, 0.1f, true, -1, -1 },    // IDLE_DEMON
+    { DEMON_SPRITE_SHEET, 288, 160, 1, 12, 0.1f, true, -1, -1 },   // WALK_DEMON
+    { DEMON_SPRITE_SHEET, 288, 160, 2, 15, 0.1f, false, 10, 14 },  // ATTACK_DEMON - hits on the last five frames
+    { DEMON_SPRITE_SHEET, 288, 160, 3, 5, 0.1f, false, -1, -1 },   // HURT_DEMON
+    { DEMON_SPRITE_SHEET, 288, 160, 4, 22, 0.1f, false, -1, -1 }   // DEAD_DEMON
+};
+constexpr AnimationTable<DEAD_DEMON + 1> DEMON_ANIMATIONS(DEMON_CLIPS);
+
+// How the mixer limits each of the demons' sound effects, which every demon on the map shares
+constexpr SoundSettings DEMON_ATTACK_SOUND = { SOUND_CATEGORY_COMBAT, 2, 0.1f };
+constexpr SoundSettings DEMON_HURT_SOUND = { SOUND_CATEGORY_VOICE, 2, 0.1f };
+constexpr SoundSettings DEMON_DEAD_SOUND = { SOUND_CATEGORY_VOICE, 2, 0.1f };
+constexpr SoundSettings DEMON_EXPLOSION_SOUND = { SOUND_CATEGORY_COMBAT, 2, 0.1f };
+constexpr SoundSettings DEMON_CHANT_SOUND = { SOUND_CATEGORY_AMBIENT, 1, 1.0f };
+const float DEMON_SOUND_VOLUME = 0.7f;
+
 class Demon {
     public:
         Rectangle rect;
+        Rectangle previousRect; // Rectangle at the start of the current simulation step, for interpolated drawing
         Vector2 velocity;
         DirectionDemon direction;
         CurrentStateDemon state;
@@ -54,14 +78,15 @@ class Demon {
         int health;
 
         std::vector<AnimationDemon> animations;
-        std::vector<Texture2D> sprites; // The texture sheets used for animations
+        AssetHandle atlasHandle = INVALID_ASSET_HANDLE; // Atlas with the frames of every state, one animation per state
         
-        // Sound variables
-        Sound attackSound;
-        Sound hurtSound;
-        Sound deadSound;
-        Sound chantSound;
-        Sound explosionSound;
+        // Sound variables, played through the audio mixer
+        AssetHandle attackSound = INVALID_ASSET_HANDLE;
+        AssetHandle hurtSound = INVALID_ASSET_HANDLE;
+        AssetHandle deadSound = INVALID_ASSET_HANDLE;
+        AssetHandle chantSound = INVALID_ASSET_HANDLE;
+        AssetHandle explosionSound = INVALID_ASSET_HANDLE;
+        std::vector<AssetHandle> assetHandles; // References to the atlas and sounds, released on destruction
         float chantTimer = 0.0f;
         float chantInterval = 10.0f; // Play chant every 10 seconds
 
@@ -76,43 +101,31 @@ class Demon {
 
         // Constructor initializing the Demon's properties and animations
         Demon(Vector2 position, float baseSpeed = 150.0f, int startingHealth = 500) {
-            std::cout << "Initializing Demon at position: " << position.x << ", " << position.y << std::endl;
+            GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_DEMON, "Initializing Demon at position: %.2f, %.2f", position.x, position.y);
             rect = { position.x, position.y, 144.0f * SPRITE_SCALE, 80.0f * SPRITE_SCALE };
+            previousRect = rect;
             velocity = { 0, 0 };
             direction = RIGHT_DEMON;
             state = IDLE_DEMON;
             health = startingHealth; // Initialize health
             moveSpeed = baseSpeed * 0.01f; // Convert to appropriate scale
 
-            // Initialize animations for different states with correct frame counts
-            animations = {
-                { 0, 5, 0, 0.1f, 0.1f, REPEATING_DEMON }, // IDLE_DEMON - 6 frames
-                { 0, 11, 0, 0.1f, 0.1f, REPEATING_DEMON },  // WALK_DEMON - 12 frames
-                { 0, 14, 0, 0.1f, 0.1f, ONESHOT_DEMON },   // ATTACK_DEMON - 15 frames
-                { 0, 4, 0, 0.1f, 0.1f, ONESHOT_DEMON },    // HURT_DEMON - 5 frames
-                { 0, 21, 0, 0.1f, 0.1f, ONESHOT_DEMON }    // DEAD_DEMON - 22 frames
-            };
+            // Initialize animations for different states from the table
+            for (const AnimationClip& clip : DEMON_CLIPS) {
+                animations.push_back({ 0, clip.frameCount - 1, 0, clip.frameTime, clip.frameTime,
+                                       clip.isLooping ? REPEATING_DEMON : ONESHOT_DEMON });
+            }
 
-            // Load textures for each state
-            std::cout << "Loading Demon textures..." << std::endl;
-            try {
-                Texture2D texture = LoadTexture("assets/Demon/spritesheets/demon_slime_FREE_v1.0_288x160_spritesheet.png");
-                if (texture.id == 0) {
-                    std::cout << "Error: Failed to load Demon texture" << std::endl;
-                    // Create a small placeholder texture to prevent crashes
-                    Image placeholder = GenImageColor(288, 160, RED);
-                    texture = LoadTextureFromImage(placeholder);
-                    UnloadImage(placeholder);
-                }
-                sprites.push_back(texture);
-                std::cout << "Demon texture loaded. Width: " << sprites[0].width << ", Height: " << sprites[0].height << std::endl;
-            } catch (const std::exception& e) {
-                std::cout << "Exception loading Demon texture: " << e.what() << std::endl;
-                // Create a small placeholder texture to prevent crashes
-                Image placeholder = GenImageColor(288, 160, RED);
-                Texture2D texture = LoadTextureFromImage(placeholder);
-                UnloadImage(placeholder);
-                sprites.push_back(texture);
+            // Pack the sprite sheet's rows into an atlas, in state order
+            GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_DEMON, "Loading Demon textures...");
+            atlasHandle = getAssetManager().acquireAtlas("demon", DEMON_ANIMATIONS.getSheets());
+            assetHandles.push_back(atlasHandle);
+            const Atlas* atlas = getAssetManager().getAtlas(atlasHandle);
+            if (atlas->texture.id == 0) {
+                GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_DEMON, "Failed to load Demon texture, drawing a placeholder");
+            } else {
+                GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_DEMON, "Demon atlas loaded. Width: %d, Height: %d",
+                         atlas->texture.width, atlas->texture.height);
             }
 
             // Initialize collision boxes with scaled dimensions for the larger Demon
@@ -141,49 +154,45 @@ class Demon {
             // Create a new AggressiveBehavior and pass it to setBehavior
             ai.setBehavior(std::unique_ptr<AIBehavior>(new AggressiveBehavior(attackRange, chaseRange)));
             
-            std::cout << "Demon collision boxes initialized. Count: " << collisionBoxes.size() << std::endl;
+            GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_DEMON, "Demon collision boxes initialized. Count: %d",
+                     (int)collisionBoxes.size());
 
             // Load sounds
-            chantSound = LoadSound("sounds/misc/demon-chant-latin-14489.mp3");
-            hurtSound = LoadSound("sounds/demon/mixkit-fantasy-monster-grunt-1977.wav"); 
-            deadSound = LoadSound("sounds/demon/demonic-roar-40349.wav"); 
-            explosionSound = LoadSound("sounds/demon/large-explosion-100420.wav");
-            attackSound = LoadSound("sounds/demon/sword-clash-1-6917.wav");
-
-            // Set sound volume
-            SetSoundVolume(chantSound, 0.7f);
-            SetSoundVolume(hurtSound, 0.7f);
-            SetSoundVolume(deadSound, 0.7f);
-            SetSoundVolume(explosionSound, 0.7f);
-            SetSoundVolume(attackSound, 0.7f);
+            chantSound = acquireSound("sounds/misc/demon-chant-latin-14489.mp3");
+            hurtSound = acquireSound("sounds/demon/mixkit-fantasy-monster-grunt-1977.wav"); 
+            deadSound = acquireSound("sounds/demon/demonic-roar-40349.wav"); 
+            explosionSound = acquireSound("sounds/demon/large-explosion-100420.wav");
+            attackSound = acquireSound("sounds/demon/sword-clash-1-6917.wav");
         }
 
         // Destructor to clean up resources
         ~Demon() {
-            for (auto& sprite : sprites) {
-                if (sprite.id != 0) {
-                    UnloadTexture(sprite);
-                }
+            // The atlas and sounds are shared with other demons and unloaded once none uses them
+            for (AssetHandle handle : assetHandles) {
+                getAssetManager().release(handle);
             }
-            
-            // Unload sounds if they were loaded
-            if (attackSound.frameCount > 0) UnloadSound(attackSound);
-            if (hurtSound.frameCount > 0) UnloadSound(hurtSound);
-            if (deadSound.frameCount > 0) UnloadSound(deadSound);
-            if (chantSound.frameCount > 0) UnloadSound(chantSound);
-            if (explosionSound.frameCount > 0) UnloadSound(explosionSound);
-            if (attackSound.frameCount > 0) UnloadSound(attackSound);
         }
 
-        void updateAnimation() {
-            std::cout << "Demon Animation State: " << state << std::endl;
+        // Gets a sound through the asset manager, remembering the reference to release.
+        AssetHandle acquireSound(const char* path) {
+            AssetHandle handle = getAssetManager().acquireSound(path);
+            assetHandles.push_back(handle);
+            return handle;
+        }
+
+        // Plays one of the sound effects through the mixer.
+        void playSound(AssetHandle sound, const SoundSettings& settings) {
+            getAudioMixer().play(sound, settings, DEMON_SOUND_VOLUME);
+        }
+
+        void updateAnimation(float deltaTime) {
+            GAME_LOG_EVERY(0.5, LOG_LEVEL_TRACE, LOG_CATEGORY_DEMON, "Demon Animation State: %d", (int)state);
             // Safety check for valid state
             if (state < 0 || state >= animations.size()) {
                 state = IDLE_DEMON; // Reset to idle if state is invalid
             }
             
             AnimationDemon& anim = animations[state];
-            float deltaTime = GetFrameTime();
 
             anim.timeLeft -= deltaTime;
             if (anim.timeLeft <= 0) {
@@ -226,57 +235,32 @@ class Demon {
             }      
         }
 
-        Rectangle getAnimationFrame() const {
-            // Safety check for valid state
-            if (state < 0 || state >= animations.size()) {
-                return Rectangle{0.0f, 0.0f, 288.0f, 160.0f}; // Return a default frame
-            }
-            
-            const AnimationDemon& anim = animations[state];
-            
-            // Safety check for valid sprite
-            if (sprites.empty() || sprites[0].id == 0) {
-                return Rectangle{0.0f, 0.0f, 288.0f, 160.0f}; // Return a default frame
-            }
-            
-            // Calculate frame dimensions based on sprite sheet layout
-            // The demon sprite sheet has 22 columns and 5 rows
-            int frameWidth = 288;
-            int frameHeight = 160;
-            
-            // Calculate the row and column for the current frame
-            int row = state;
-            int col = anim.currentFrame;
-            
-            // Safety check for valid frame
-            if (row < 0 || row >= 5 || col < 0 || col > anim.lastFrame) {
-                return Rectangle{0.0f, 0.0f, static_cast<float>(frameWidth), static_cast<float>(frameHeight)}; // Return the first frame
-            }
-            
-            return Rectangle{
-                static_cast<float>(col * frameWidth),
-                static_cast<float>(row * frameHeight),
-                static_cast<float>(frameWidth),
-                static_cast<float>(frameHeight)
-            };
+        // Get the current animation frame from an atlas packed from DEMON_ANIMATIONS.
+        // updateAnimation() keeps the state and frame in range, so this is a single lookup.
+        const AtlasFrame& getAnimationFrame(const Atlas& atlas) const {
+            return atlas.frames[DEMON_ANIMATIONS.getFrameIndex(state, animations[state].currentFrame)];
         }
 
-        void draw() const {
-            // Safety check for valid state and sprite
-            if (state < 0 || state >= animations.size() || sprites.empty() || sprites[0].id == 0) {
-                return; // Don't draw if state is invalid or texture not loaded
+        // Remember the current rectangle as the one drawing interpolates from, at the start of each simulation step
+        void storePreviousRect() {
+            previousRect = rect;
+        }
+
+        // Draw the demon, interpolated between the last two simulation steps by alpha (0 to 1)
+        void draw(float alpha = 1.0f) const {
+            // Safety check for valid state
+            if (state < 0 || state >= animations.size()) {
+                return; // Don't draw if state is invalid
             }
-            
-            Rectangle source = getAnimationFrame();
-            Rectangle dest = { rect.x, rect.y, rect.width, rect.height };
-            Vector2 origin = { 0, 0 };
-            float rotation = 0.0f;
 
-            if (direction == LEFT_DEMON) {
-                DrawTexturePro(sprites[0], source, dest, origin, rotation, WHITE);
+            Rectangle dest = { previousRect.x + (rect.x - previousRect.x) * alpha,
+                               previousRect.y + (rect.y - previousRect.y) * alpha, rect.width, rect.height };
+            const Atlas* atlas = getAssetManager().getAtlas(atlasHandle);
+            if (atlas == NULL || atlas->texture.id == 0 ||
+                atlas->frames.size() != (size_t)DEMON_ANIMATIONS.frameCount) {
+                DrawRectangleRec(dest, RED); // Placeholder when the sprite sheet failed to load
             } else {
-                Rectangle flippedSource = { source.x + source.width, source.y, -source.width, source.height };
-                DrawTexturePro(sprites[0], flippedSource, dest, origin, rotation, WHITE);
+                drawAtlasFrame(atlas->texture, getAnimationFrame(*atlas), dest, direction != LEFT_DEMON, WHITE);
             }
 
             // Draw collision boxes for debugging
@@ -326,7 +310,7 @@ class Demon {
 
         void attack() {
             if (!isAttacking && !isDead) {
-                PlaySound(attackSound);
+                playSound(attackSound, DEMON_ATTACK_SOUND);
                 state = ATTACK_DEMON;
                 animations[state].currentFrame = 0;
                 isAttacking = true;
@@ -362,15 +346,12 @@ class Demon {
                     }
                 }
                 
-                // Play attack sound if available
-                if (attackSound.frameCount > 0) {
-                    PlaySound(attackSound);
-                }
+                // Play attack sound
+                playSound(attackSound, DEMON_ATTACK_SOUND);
             }
         }
 
-        void applyVelocity() {
-            float deltaTime = GetFrameTime();
+        void applyVelocity(float deltaTime) {
             rect.x += velocity.x * deltaTime;
             
             // Add map boundary checks
@@ -440,11 +421,11 @@ class Demon {
                     box.rect.y = hurtbox->rect.y + 5.0f * SPRITE_SCALE;
                     
                     if (box.type == ATTACK) {
-                        // Only activate the attack box in the last two frames of the attack animation
+                        // Only activate the attack box on the attack animation's hit frames
                         if (state == ATTACK_DEMON) {
                             AnimationDemon& attackAnim = animations[ATTACK_DEMON];
 
-                            if (attackAnim.currentFrame >= attackAnim.lastFrame - 4) {
+                            if (DEMON_CLIPS[ATTACK_DEMON].isHitboxActive(attackAnim.currentFrame)) {
                                 box.active = true;
 
                                 if (hurtbox) {
@@ -491,21 +472,17 @@ class Demon {
                         }
                     }
                     
-                    // Play death sound if available
-                    if (deadSound.frameCount > 0) {
-                        PlaySound(deadSound);
-                        PlaySound(explosionSound);
-                        StopSound(attackSound);
-                    }
+                    // Play death sound
+                    playSound(deadSound, DEMON_DEAD_SOUND);
+                    playSound(explosionSound, DEMON_EXPLOSION_SOUND);
+                    getAudioMixer().stop(attackSound);
                 } else {
                     state = HURT_DEMON;
                     velocity.x = 0;
                     
-                    // Play hurt sound if available
-                    if (hurtSound.frameCount > 0) {
-                        PlaySound(hurtSound);
-                        StopSound(attackSound);
-                    }
+                    // Play hurt sound
+                    playSound(hurtSound, DEMON_HURT_SOUND);
+                    getAudioMixer().stop(attackSound);
                 }
             }
         }
@@ -516,14 +493,14 @@ class Demon {
             chantTimer += deltaTime;
             if (chantTimer >= chantInterval) {
                 chantTimer = 0.0f;
-                if (!IsSoundPlaying(chantSound) && !isDead) {
-                    PlaySound(chantSound);
+                if (!getAudioMixer().isPlaying(chantSound) && !isDead) {
+                    playSound(chantSound, DEMON_CHANT_SOUND);
                 }
             }
             
             if (isDead) {
                 state = DEAD_DEMON;
-                updateAnimation();
+                updateAnimation(deltaTime);
                 return;
             }
 
@@ -552,8 +529,8 @@ class Demon {
                     animations[state].currentFrame = 0;
                     
                     // Play attack sound
-                    if (!IsSoundPlaying(attackSound)) {
-                        PlaySound(attackSound);
+                    if (!getAudioMixer().isPlaying(attackSound)) {
+                        playSound(attackSound, DEMON_ATTACK_SOUND);
                     }
                 }
                 else if (distance < minDistance) {
@@ -593,7 +570,7 @@ class Demon {
             if (rect.x < 0) rect.x = 0;
             if (rect.x > mapWidth - rect.width) rect.x = mapWidth - rect.width;
             
-            updateAnimation();
+            updateAnimation(deltaTime);
             updateCollisionBoxes();
         }
 
@@ -603,18 +580,18 @@ class Demon {
             chantTimer += deltaTime;
             if (chantTimer >= chantInterval) {
                 chantTimer = 0.0f;
-                if (!IsSoundPlaying(chantSound) && !isDead) {
-                    PlaySound(chantSound);
+                if (!getAudioMixer().isPlaying(chantSound) && !isDead) {
+                    playSound(chantSound, DEMON_CHANT_SOUND);
                 }
             }
             
             if (!isDead) {
                 move();  // Fall back to random movement
-                updateAnimation();
+                updateAnimation(deltaTime);
                 updateCollisionBoxes();
             } else {
                 state = DEAD_DEMON;
-                updateAnimation(); // Continue death animation
+                updateAnimation(deltaTime); // Continue death animation
             }
         }
 
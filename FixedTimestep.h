@@ -0,0 +1,76 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+/**
+ * @file FixedTimestep.h
+ * @brief Runs the simulation in steps of constant length, however long each rendered frame takes.
+ *
+ * Frame times are added to an accumulator and the simulation takes as many
+ * whole steps as fit, carrying the remainder over to the next frame. What's
+ * left is a fraction of a step that the renderer uses to interpolate between
+ * the last two simulated states, so motion stays smooth at any frame rate.
+ */
+
+/**
+ * Simulation steps per second. Gameplay constants such as the samurai's jump
+ * impulse, gravity and run speed, and the demon's contact damage, are tuned
+ * per step at this rate, so changing it changes how the game plays.
+ */
+const float SIMULATION_RATE = 60.0f;
+
+/**
+ * @class FixedTimestep
+ * @brief Accumulates frame time and hands it out in fixed steps.
+ */
+class FixedTimestep {
+public:
+    /**
+     * @brief Constructs a timestep with an empty accumulator.
+     * @param stepsPerSecond Rate at which the simulation steps.
+     * @param maxStepsPerFrame Most steps a single frame may take. Time beyond that is dropped, so a long stall
+     *                         (loading, a breakpoint, dragging the window) slows the game down instead of making
+     *                         every following frame take even longer to catch up.
+     */
+    explicit FixedTimestep(float stepsPerSecond = SIMULATION_RATE, int maxStepsPerFrame = 8)
+        : step(1.0f / stepsPerSecond), maxSteps(maxStepsPerFrame) {}
+
+    /**
+     * @brief Adds a frame's duration to the accumulator.
+     * @param frameTime Seconds the last frame took, normally GetFrameTime().
+     * @return Number of steps the simulation has to take this frame, possibly zero.
+     */
+    int advance(float frameTime) {
+        if (frameTime > 0.0f) accumulator += frameTime;
+
+        int steps = (int)(accumulator / step);
+        if (steps > maxSteps) {
+            steps = maxSteps;
+            accumulator = step * maxSteps;
+        }
+        accumulator -= steps * step;
+        return steps;
+    }
+
+    /**
+     * @brief Gets the length of a step.
+     * @return Seconds of simulated time per step.
+     */
+    float getStep() const {
+        return step;
+    }
+
+    /**
+     * @brief Gets how far the current time is between the last step and the next one.
+     * @return A ratio between 0 and 1 to interpolate the previous and the current state with.
+     */
+    float getAlpha() const {
+        return accumulator / step;
+    }
+
+private:
+    float step;               ///< Seconds per step.
+    int maxSteps;             ///< Most steps taken in one frame.
+    float accumulator = 0.0f; ///< Frame time not yet simulated, always less than a step after advance().
+};
+
+#endif // FIXED_TIMESTEP_H
@@ -0,0 +1,327 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+/**
+ * @file Headless.h
+ * @brief Stand-in backends for running the game logic without a window, GPU or audio device.
+ *
+ * Building with HEADLESS defined, for example
+ *
+ *     g++ -std=c++17 -O2 -DHEADLESS 2dgame.cpp -o 2dgame_headless -lraylib
+ *
+ * makes 2dgame.cpp skip the start screen and all drawing, and replaces the
+ * raylib calls the game makes for the window, textures, audio, input and time
+ * with the stand-ins below. Textures keep only their size, sounds and music
+ * are silent, key presses come from a script, the mouse stays put and every
+ * frame advances the clock by exactly one simulation step. The update loop
+ * then runs as fast as the CPU allows and plays out the same way every time,
+ * which is what soak tests and benchmarks on machines without a GPU need.
+ *
+ * The command line is `2dgame_headless [frames] [input script] [random seed]`.
+ * An input script holds one key press per line, `<frame> <frames held> <key>`,
+ * with the key given by name (W, A, D, SPACE, LEFT, F4, ...) or by its raylib
+ * key code. Lines starting with # are comments. Pressing F4 in a script saves
+ * the profiler's trace as usual.
+ *
+ * Include this file right after raylib.h, so the replacements apply to every
+ * header included after it, raytmx.h's implementation included.
+ */
+
+#ifdef HEADLESS
+
+#include "raylib.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "FixedTimestep.h"
+
+/**
+ * @struct ScriptedKeyPress
+ * @brief A key held down for a number of frames.
+ */
+struct ScriptedKeyPress {
+    long long frame;  ///< Frame on which the key goes down.
+    long long frames; ///< Number of frames the key stays down.
+    int key;          ///< raylib key code.
+};
+
+/**
+ * @struct ScriptedKeyName
+ * @brief A key name that input scripts may use.
+ */
+struct ScriptedKeyName {
+    const char* name;
+    int key;
+};
+
+const ScriptedKeyName SCRIPTED_KEY_NAMES[] = {
+    { "W", KEY_W }, { "A", KEY_A }, { "B", KEY_B }, { "D", KEY_D }, { "E", KEY_E }, { "H", KEY_H },
+    { "K", KEY_K }, { "M", KEY_M }, { "P", KEY_P }, { "SPACE", KEY_SPACE }, { "UP", KEY_UP },
+    { "DOWN", KEY_DOWN }, { "LEFT", KEY_LEFT }, { "RIGHT", KEY_RIGHT }, { "LEFT_SHIFT", KEY_LEFT_SHIFT },
+    { "F1", KEY_F1 }, { "F2", KEY_F2 }, { "F3", KEY_F3 }, { "F4", KEY_F4 }
+};
+
+/**
+ * @class HeadlessBackend
+ * @brief Frame counter, simulated clock and scripted keyboard behind the stand-in raylib calls.
+ */
+class HeadlessBackend {
+public:
+    /**
+     * @brief Reads the frame count, input script and random seed from the command line.
+     * @param argc Number of arguments, as passed to main().
+     * @param argv Arguments, as passed to main().
+     * @return False if an argument was invalid or the script couldn't be read.
+     */
+    bool configure(int argc, char* argv[]) {
+        if (argc > 1) {
+            frameLimit = atoll(argv[1]);
+            if (frameLimit <= 0) {
+                fprintf(stderr, "Usage: %s [frames] [input script] [random seed]\n", argv[0]);
+                return false;
+            }
+        }
+        if (argc > 2 && !loadScript(argv[2])) return false;
+
+        unsigned int seed = argc > 3 ? (unsigned int)strtoul(argv[3], NULL, 10) : 1;
+        SetRandomSeed(seed);
+        return true;
+    }
+
+    /**
+     * @brief Reads key presses from a script, replacing any read before.
+     * @param fileName Path of the script.
+     * @return False if the file couldn't be opened or a line couldn't be parsed.
+     */
+    bool loadScript(const char* fileName) {
+        FILE* file = fopen(fileName, "r");
+        if (!file) {
+            fprintf(stderr, "Headless: Could not open input script %s\n", fileName);
+            return false;
+        }
+
+        script.clear();
+        char line[256];
+        int lineNumber = 0;
+        bool isValid = true;
+        while (fgets(line, sizeof(line), file)) {
+            lineNumber++;
+            char keyName[64];
+            ScriptedKeyPress press;
+            if (line[strspn(line, " \t\r\n")] == '\0' || line[strspn(line, " \t")] == '#') continue;
+            if (sscanf(line, "%lld %lld %63s", &press.frame, &press.frames, keyName) != 3 ||
+                (press.key = findKey(keyName)) == KEY_NULL) {
+                fprintf(stderr, "Headless: %s:%d: Expected <frame> <frames held> <key>\n", fileName, lineNumber);
+                isValid = false;
+                break;
+            }
+            script.push_back(press);
+        }
+        fclose(file);
+        return isValid;
+    }
+
+    /**
+     * @brief Moves on to the next frame. Stands in for WindowShouldClose().
+     * @return True once the requested number of frames has run.
+     */
+    bool nextFrame() {
+        long long next = frame.load(std::memory_order_relaxed) + 1;
+        if (next == 0) wallStart = std::chrono::steady_clock::now();
+        if (next >= frameLimit) {
+            if (wallEnd == std::chrono::steady_clock::time_point()) wallEnd = std::chrono::steady_clock::now();
+            return true;
+        }
+        frame.store(next, std::memory_order_relaxed);
+        return false;
+    }
+
+    /**
+     * @brief Checks whether the script holds a key down on the current frame.
+     */
+    bool isKeyDown(int key) const {
+        long long now = frame.load(std::memory_order_relaxed);
+        for (const ScriptedKeyPress& press : script) {
+            if (press.key == key && now >= press.frame && now < press.frame + press.frames) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Checks whether the script presses a key on the current frame.
+     */
+    bool isKeyPressed(int key) const {
+        long long now = frame.load(std::memory_order_relaxed);
+        for (const ScriptedKeyPress& press : script) {
+            if (press.key == key && now == press.frame) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Gets the simulated time, one step per frame. Safe to call from any thread.
+     * @return Seconds since the first frame.
+     */
+    double getTime() const {
+        long long now = frame.load(std::memory_order_relaxed);
+        return now > 0 ? now * (double)getFrameTime() : 0.0;
+    }
+
+    /**
+     * @brief Gets the simulated length of a frame, which is exactly one simulation step.
+     */
+    float getFrameTime() const {
+        return 1.0f / SIMULATION_RATE;
+    }
+
+    /**
+     * @brief Hands out an id for a texture that was never uploaded, so checks for id 0 still mean failure.
+     */
+    unsigned int nextTextureId() {
+        return textureCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    /**
+     * @brief Prints how many frames ran and how fast.
+     */
+    void report() const {
+        long long frames = frame.load(std::memory_order_relaxed) + 1;
+        // A replay running out ends the loop before the frame limit does
+        std::chrono::steady_clock::time_point end = wallEnd;
+        if (end == std::chrono::steady_clock::time_point()) end = std::chrono::steady_clock::now();
+        double wallSeconds = std::chrono::duration<double>(end - wallStart).count();
+        printf("Headless: Simulated %lld frames (%.1f s of game time) in %.3f s, %.0f frames per second\n",
+               frames, frames * (double)getFrameTime(), wallSeconds, wallSeconds > 0.0 ? frames / wallSeconds : 0.0);
+    }
+
+private:
+    std::atomic<long long> frame{-1};                     ///< Frame being run, read by loader threads through GetTime().
+    long long frameLimit = 60 * 60;                       ///< Frames to run, a minute of game time by default.
+    std::vector<ScriptedKeyPress> script;                 ///< Key presses to play back.
+    std::atomic<unsigned int> textureCount{0};            ///< Textures handed out, maybe by loader threads.
+    std::chrono::steady_clock::time_point wallStart;      ///< When the first frame started.
+    std::chrono::steady_clock::time_point wallEnd;        ///< When the last frame finished.
+
+    static int findKey(const char* name) {
+        for (const ScriptedKeyName& keyName : SCRIPTED_KEY_NAMES) {
+            if (strcmp(keyName.name, name) == 0) return keyName.key;
+        }
+        return atoi(name); // A key code, or KEY_NULL if it's neither
+    }
+};
+
+/**
+ * @brief Gets the backend shared by all the stand-in calls.
+ */
+inline HeadlessBackend& getHeadlessBackend() {
+    static HeadlessBackend backend;
+    return backend;
+}
+
+// Window and frame loop
+inline void HeadlessInitWindow(int, int, const char*) {}
+inline void HeadlessCloseWindow() {}
+inline bool HeadlessWindowShouldClose() { return getHeadlessBackend().nextFrame(); }
+inline void HeadlessSetTargetFPS(int) {}
+inline double HeadlessGetTime() { return getHeadlessBackend().getTime(); }
+inline float HeadlessGetFrameTime() { return getHeadlessBackend().getFrameTime(); }
+
+// Input
+inline bool HeadlessIsKeyPressed(int key) { return getHeadlessBackend().isKeyPressed(key); }
+inline bool HeadlessIsKeyDown(int key) { return getHeadlessBackend().isKeyDown(key); }
+inline Vector2 HeadlessGetMousePosition() { return Vector2{ 0.0f, 0.0f }; }
+inline bool HeadlessIsMouseButtonPressed(int) { return false; }
+
+// Textures keep their size, which sprite animation and map layout depend on, but never reach a GPU
+inline Texture2D HeadlessLoadTextureFromImage(Image image) {
+    Texture2D texture = { 0 };
+    if (image.data == NULL) return texture;
+    texture.id = getHeadlessBackend().nextTextureId();
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.mipmaps = 1;
+    texture.format = image.format;
+    return texture;
+}
+inline Texture2D HeadlessLoadTexture(const char* fileName) {
+    Image image = LoadImage(fileName);
+    Texture2D texture = HeadlessLoadTextureFromImage(image);
+    UnloadImage(image);
+    return texture;
+}
+inline void HeadlessUnloadTexture(Texture2D) {}
+inline void HeadlessSetTextureWrap(Texture2D, int) {}
+
+// Audio is silent and never loaded
+inline void HeadlessInitAudioDevice() {}
+inline void HeadlessCloseAudioDevice() {}
+inline Sound HeadlessLoadSound(const char*) {
+    Sound sound = { 0 };
+    sound.frameCount = 1; // Looks loaded to the checks in the characters
+    return sound;
+}
+inline void HeadlessUnloadSound(Sound) {}
+inline Sound HeadlessLoadSoundAlias(Sound source) { return source; }
+inline void HeadlessUnloadSoundAlias(Sound) {}
+inline void HeadlessPlaySound(Sound) {}
+inline void HeadlessStopSound(Sound) {}
+inline void HeadlessPauseSound(Sound) {}
+inline void HeadlessResumeSound(Sound) {}
+inline bool HeadlessIsSoundPlaying(Sound) { return false; }
+inline void HeadlessSetSoundVolume(Sound, float) {}
+inline Music HeadlessLoadMusicStream(const char*) {
+    Music music = { 0 };
+    music.frameCount = 1; // Looks loaded to the music player
+    return music;
+}
+inline void HeadlessUnloadMusicStream(Music) {}
+inline void HeadlessPlayMusicStream(Music) {}
+inline void HeadlessStopMusicStream(Music) {}
+inline void HeadlessPauseMusicStream(Music) {}
+inline void HeadlessResumeMusicStream(Music) {}
+inline void HeadlessUpdateMusicStream(Music) {}
+inline bool HeadlessIsMusicStreamPlaying(Music) { return false; }
+inline void HeadlessSetMusicVolume(Music, float) {}
+
+#define InitWindow HeadlessInitWindow
+#define CloseWindow HeadlessCloseWindow
+#define WindowShouldClose HeadlessWindowShouldClose
+#define SetTargetFPS HeadlessSetTargetFPS
+#define GetTime HeadlessGetTime
+#define GetFrameTime HeadlessGetFrameTime
+#define IsKeyPressed HeadlessIsKeyPressed
+#define IsKeyDown HeadlessIsKeyDown
+#define GetMousePosition HeadlessGetMousePosition
+#define IsMouseButtonPressed HeadlessIsMouseButtonPressed
+#define LoadTexture HeadlessLoadTexture
+#define LoadTextureFromImage HeadlessLoadTextureFromImage
+#define UnloadTexture HeadlessUnloadTexture
+#define SetTextureWrap HeadlessSetTextureWrap
+#define InitAudioDevice HeadlessInitAudioDevice
+#define CloseAudioDevice HeadlessCloseAudioDevice
+#define LoadSound HeadlessLoadSound
+#define UnloadSound HeadlessUnloadSound
+#define LoadSoundAlias HeadlessLoadSoundAlias
+#define UnloadSoundAlias HeadlessUnloadSoundAlias
+#define PlaySound HeadlessPlaySound
+#define StopSound HeadlessStopSound
+#define PauseSound HeadlessPauseSound
+#define ResumeSound HeadlessResumeSound
+#define IsSoundPlaying HeadlessIsSoundPlaying
+#define SetSoundVolume HeadlessSetSoundVolume
+#define LoadMusicStream HeadlessLoadMusicStream
+#define UnloadMusicStream HeadlessUnloadMusicStream
+#define PlayMusicStream HeadlessPlayMusicStream
+#define StopMusicStream HeadlessStopMusicStream
+#define PauseMusicStream HeadlessPauseMusicStream
+#define ResumeMusicStream HeadlessResumeMusicStream
+#define UpdateMusicStream HeadlessUpdateMusicStream
+#define IsMusicStreamPlaying HeadlessIsMusicStreamPlaying
+#define SetMusicVolume HeadlessSetMusicVolume
+
+#endif // HEADLESS
+
+#endif // HEADLESS_H
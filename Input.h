@@ -0,0 +1,328 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "raylib.h"
+#include "Log.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+/**
+ * @file Input.h
+ * @brief Reads the keyboard and mouse once per frame, and records or replays what it read.
+ *
+ * The game reads input through InputSystem rather than from raylib, so a run
+ * can be recorded to a file and played back exactly. Besides the keys and
+ * the mouse, a recording holds what the run depends on that isn't input: the
+ * random seed, how many simulation steps each frame took and the frame each
+ * map switch happened on. A replay therefore simulates the same steps with
+ * the same input whatever the frame times, which makes it usable for
+ * comparing frame times across builds.
+ *
+ * A recording starts with a header, the magic "2DGI", a version, the number
+ * of keys and the random seed. Each frame follows as a byte of flags and
+ * only the fields that changed since the previous frame, so a frame where
+ * nothing changes and one step is taken costs a single byte.
+ */
+
+/// Keys the game reads. Each has a bit in the recorded key state, in this order.
+const int INPUT_KEYS[] = {
+    KEY_W, KEY_A, KEY_D, KEY_B, KEY_LEFT, KEY_RIGHT, KEY_SPACE, KEY_H, KEY_K,
+    KEY_P, KEY_M, KEY_E, KEY_F1, KEY_F2, KEY_F3, KEY_F4
+};
+const int INPUT_KEY_COUNT = sizeof(INPUT_KEYS) / sizeof(INPUT_KEYS[0]);
+
+const char INPUT_RECORDING_MAGIC[4] = { '2', 'D', 'G', 'I' };
+const uint16_t INPUT_RECORDING_VERSION = 1;
+
+/**
+ * @enum InputMode
+ * @brief Where input comes from and whether it is saved.
+ */
+enum InputMode {
+    INPUT_LIVE,      ///< Read from raylib.
+    INPUT_RECORDING, ///< Read from raylib and saved to a file.
+    INPUT_REPLAYING  ///< Read from a recording.
+};
+
+/**
+ * @struct InputFrame
+ * @brief Input and simulation events of one frame.
+ */
+struct InputFrame {
+    uint32_t keysDown = 0;          ///< Bit per entry of INPUT_KEYS held down.
+    uint32_t keysPressed = 0;       ///< Bit per entry of INPUT_KEYS pressed this frame.
+    Vector2 mousePosition = { 0, 0 };
+    bool isMousePressed = false;    ///< Whether the left mouse button was pressed this frame.
+    uint8_t steps = 0;              ///< Simulation steps taken this frame.
+    bool isMapSwitch = false;       ///< Whether the map switch of a transition happened this frame.
+};
+
+/**
+ * @class InputSystem
+ * @brief Per-frame input state, read live, recorded or replayed.
+ */
+class InputSystem {
+public:
+    ~InputSystem() {
+        stop();
+    }
+
+    /**
+     * @brief Starts saving every frame's input to a file. Reseeds the random number generator with a seed it saves.
+     * @param fileName Path of the recording to write.
+     * @return False if the file couldn't be opened.
+     */
+    bool startRecording(const char* fileName) {
+        stop();
+        file = fopen(fileName, "wb");
+        if (!file) {
+            GAME_LOG(LOG_LEVEL_WARNING, LOG_CATEGORY_GAME, "Could not open %s for recording", fileName);
+            return false;
+        }
+
+        unsigned int seed = (unsigned int)time(NULL);
+        SetRandomSeed(seed);
+
+        fwrite(INPUT_RECORDING_MAGIC, 1, sizeof(INPUT_RECORDING_MAGIC), file);
+        writeUint(INPUT_RECORDING_VERSION, 2);
+        writeUint(INPUT_KEY_COUNT, 2);
+        writeUint(seed, 4);
+        mode = INPUT_RECORDING;
+        frameCount = 0;
+        hasPendingFrame = false;
+        previous = InputFrame();
+        return true;
+    }
+
+    /**
+     * @brief Starts playing back a recording instead of reading raylib. Reseeds the random number generator with
+     *        the recording's seed.
+     * @param fileName Path of the recording to read.
+     * @return False if the file couldn't be opened or isn't a recording this version of the game understands.
+     */
+    bool startReplay(const char* fileName) {
+        stop();
+        file = fopen(fileName, "rb");
+        if (!file) {
+            GAME_LOG(LOG_LEVEL_WARNING, LOG_CATEGORY_GAME, "Could not open %s for replay", fileName);
+            return false;
+        }
+
+        char magic[sizeof(INPUT_RECORDING_MAGIC)];
+        uint32_t version, keyCount, seed;
+        if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+            memcmp(magic, INPUT_RECORDING_MAGIC, sizeof(magic)) != 0 || !readUint(&version, 2) ||
+            !readUint(&keyCount, 2) || !readUint(&seed, 4) || version != INPUT_RECORDING_VERSION ||
+            keyCount != INPUT_KEY_COUNT) {
+            GAME_LOG(LOG_LEVEL_WARNING, LOG_CATEGORY_GAME, "%s isn't a version %d input recording", fileName,
+                     INPUT_RECORDING_VERSION);
+            fclose(file);
+            file = NULL;
+            return false;
+        }
+
+        SetRandomSeed(seed);
+        mode = INPUT_REPLAYING;
+        frameCount = 0;
+        isReplayFinished = false;
+        previous = InputFrame();
+        return true;
+    }
+
+    /**
+     * @brief Finishes the recording or replay in progress and goes back to reading raylib.
+     */
+    void stop() {
+        if (!file) return;
+        if (mode == INPUT_RECORDING && hasPendingFrame) writeFrame(current);
+        fclose(file);
+        file = NULL;
+        GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_GAME, "%s %u frames of input",
+                 mode == INPUT_RECORDING ? "Recorded" : "Replayed", frameCount);
+        mode = INPUT_LIVE;
+        hasPendingFrame = false;
+    }
+
+    /**
+     * @brief Reads this frame's input. Call once at the start of every frame, before anything reads input.
+     * @return False once a replay has run out of frames.
+     */
+    bool beginFrame() {
+        if (mode == INPUT_REPLAYING) {
+            if (!isReplayFinished && !readFrame(&current)) {
+                isReplayFinished = true;
+                GAME_LOG(LOG_LEVEL_INFO, LOG_CATEGORY_GAME, "Input replay ended after %u frames", frameCount);
+            }
+            if (!isReplayFinished) frameCount++;
+            return !isReplayFinished;
+        }
+
+        if (mode == INPUT_RECORDING && hasPendingFrame) writeFrame(current);
+
+        current = InputFrame();
+        for (int i = 0; i < INPUT_KEY_COUNT; i++) {
+            if (IsKeyDown(INPUT_KEYS[i])) current.keysDown |= 1u << i;
+            if (IsKeyPressed(INPUT_KEYS[i])) current.keysPressed |= 1u << i;
+        }
+        current.mousePosition = GetMousePosition();
+        current.isMousePressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+        hasPendingFrame = mode == INPUT_RECORDING;
+        return true;
+    }
+
+    /**
+     * @brief Checks whether a key is held down this frame.
+     * @param key One of INPUT_KEYS. Other keys are never down.
+     */
+    bool isKeyDown(int key) const {
+        return (current.keysDown & keyBit(key)) != 0;
+    }
+
+    /**
+     * @brief Checks whether a key was pressed this frame.
+     * @param key One of INPUT_KEYS. Other keys are never pressed.
+     */
+    bool isKeyPressed(int key) const {
+        return (current.keysPressed & keyBit(key)) != 0;
+    }
+
+    /**
+     * @brief Gets the position of the mouse this frame.
+     */
+    Vector2 getMousePosition() const {
+        return current.mousePosition;
+    }
+
+    /**
+     * @brief Checks whether the left mouse button was pressed this frame. Other buttons are never pressed.
+     */
+    bool isMouseButtonPressed(int button) const {
+        return button == MOUSE_BUTTON_LEFT && current.isMousePressed;
+    }
+
+    /**
+     * @brief Settles how many simulation steps this frame takes.
+     * @param steps Steps the frame's own duration calls for.
+     * @return The recorded number of steps when replaying, otherwise 'steps', which is recorded.
+     */
+    int syncSteps(int steps) {
+        if (mode == INPUT_REPLAYING) return current.steps;
+        current.steps = (uint8_t)(steps < 255 ? steps : 255);
+        return current.steps;
+    }
+
+    /**
+     * @brief Settles whether the map switch of a transition happens this frame.
+     * @param isMapReady Whether the next map is ready to switch to.
+     * @return The recorded answer when replaying, in which case the caller has to wait for the map if it isn't
+     *         ready yet. Otherwise 'isMapReady', which is recorded.
+     */
+    bool syncMapSwitch(bool isMapReady) {
+        if (mode == INPUT_REPLAYING) return current.isMapSwitch;
+        current.isMapSwitch = isMapReady;
+        return isMapReady;
+    }
+
+    InputMode getMode() const { return mode; }               ///< Where input comes from.
+    unsigned int getFrameCount() const { return frameCount; } ///< Frames recorded or replayed so far.
+
+private:
+    // Flags byte of a recorded frame. The lowest two bits hold the step count, or FRAME_STEPS_FOLLOW.
+    static const uint8_t FRAME_STEPS_MASK = 0x03;
+    static const uint8_t FRAME_STEPS_FOLLOW = 0x03;   ///< The step count follows as a byte.
+    static const uint8_t FRAME_KEYS_DOWN = 0x04;      ///< The held keys changed and follow.
+    static const uint8_t FRAME_KEYS_PRESSED = 0x08;   ///< Keys were pressed and follow.
+    static const uint8_t FRAME_MOUSE_MOVED = 0x10;    ///< The mouse moved and its position follows.
+    static const uint8_t FRAME_MOUSE_PRESSED = 0x20;
+    static const uint8_t FRAME_MAP_SWITCH = 0x40;
+
+    InputMode mode = INPUT_LIVE;
+    FILE* file = NULL;
+    InputFrame current;           ///< This frame's input.
+    InputFrame previous;          ///< Last frame written or read, which the next one is stored relative to.
+    bool hasPendingFrame = false; ///< Whether 'current' is still to be written once the frame is over.
+    bool isReplayFinished = false;
+    unsigned int frameCount = 0;
+
+    static uint32_t keyBit(int key) {
+        for (int i = 0; i < INPUT_KEY_COUNT; i++) {
+            if (INPUT_KEYS[i] == key) return 1u << i;
+        }
+        return 0;
+    }
+
+    void writeFrame(const InputFrame& frame) {
+        bool isMouseMoved = memcmp(&frame.mousePosition, &previous.mousePosition, sizeof(Vector2)) != 0;
+        uint8_t flags = frame.steps < FRAME_STEPS_FOLLOW ? frame.steps : FRAME_STEPS_FOLLOW;
+        if (frame.keysDown != previous.keysDown) flags |= FRAME_KEYS_DOWN;
+        if (frame.keysPressed != 0) flags |= FRAME_KEYS_PRESSED;
+        if (isMouseMoved) flags |= FRAME_MOUSE_MOVED;
+        if (frame.isMousePressed) flags |= FRAME_MOUSE_PRESSED;
+        if (frame.isMapSwitch) flags |= FRAME_MAP_SWITCH;
+
+        writeUint(flags, 1);
+        if ((flags & FRAME_STEPS_MASK) == FRAME_STEPS_FOLLOW) writeUint(frame.steps, 1);
+        if (flags & FRAME_KEYS_DOWN) writeUint(frame.keysDown, 4);
+        if (flags & FRAME_KEYS_PRESSED) writeUint(frame.keysPressed, 4);
+        if (isMouseMoved) {
+            writeFloat(frame.mousePosition.x);
+            writeFloat(frame.mousePosition.y);
+        }
+        previous = frame;
+        frameCount++;
+    }
+
+    bool readFrame(InputFrame* frame) {
+        uint32_t flags, value;
+        if (!readUint(&flags, 1)) return false;
+
+        *frame = InputFrame();
+        frame->keysDown = previous.keysDown;
+        frame->mousePosition = previous.mousePosition;
+        frame->steps = (uint8_t)(flags & FRAME_STEPS_MASK);
+        if (frame->steps == FRAME_STEPS_FOLLOW) {
+            if (!readUint(&value, 1)) return false;
+            frame->steps = (uint8_t)value;
+        }
+        if ((flags & FRAME_KEYS_DOWN) && !readUint(&frame->keysDown, 4)) return false;
+        if ((flags & FRAME_KEYS_PRESSED) && !readUint(&frame->keysPressed, 4)) return false;
+        if ((flags & FRAME_MOUSE_MOVED) && (!readFloat(&frame->mousePosition.x) ||
+                                            !readFloat(&frame->mousePosition.y))) return false;
+        frame->isMousePressed = (flags & FRAME_MOUSE_PRESSED) != 0;
+        frame->isMapSwitch = (flags & FRAME_MAP_SWITCH) != 0;
+        previous = *frame;
+        return true;
+    }
+
+    // Integers are stored little-endian and floats by their bits, so recordings move between machines
+    void writeUint(uint32_t value, int size) {
+        unsigned char bytes[4];
+        for (int i = 0; i < size; i++) bytes[i] = (unsigned char)(value >> (8 * i));
+        fwrite(bytes, 1, size, file);
+    }
+
+    bool readUint(uint32_t* value, int size) {
+        unsigned char bytes[4];
+        if (fread(bytes, 1, size, file) != (size_t)size) return false;
+        *value = 0;
+        for (int i = 0; i < size; i++) *value |= (uint32_t)bytes[i] << (8 * i);
+        return true;
+    }
+
+    void writeFloat(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        writeUint(bits, 4);
+    }
+
+    bool readFloat(float* value) {
+        uint32_t bits;
+        if (!readUint(&bits, 4)) return false;
+        memcpy(value, &bits, sizeof(bits));
+        return true;
+    }
+};
+
+#endif // INPUT_H
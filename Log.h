@@ -0,0 +1,286 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+/**
+ * @file Log.h
+ * @brief Leveled, categorized logging that never blocks the thread that logs.
+ *
+ * GAME_LOG() formats a message into a slot of a fixed-size ring buffer and
+ * returns. A background thread drains the buffer to stdout, flushing once
+ * per batch rather than once per line. Claiming a slot is a compare-and-swap,
+ * so any thread can log; when the buffer is full the message is dropped and
+ * counted instead of waiting. GAME_LOG_EVERY() additionally limits a single
+ * call site to one message per interval, which keeps per-frame tracing cheap
+ * enough to leave in.
+ */
+
+/**
+ * @enum LogLevel
+ * @brief Severity of a message, from most to least verbose.
+ */
+enum LogLevel {
+    LOG_LEVEL_TRACE,   ///< Per-frame state, normally rate-limited.
+    LOG_LEVEL_DEBUG,   ///< Events useful while developing.
+    LOG_LEVEL_INFO,    ///< Noteworthy events such as map switches.
+    LOG_LEVEL_WARNING, ///< Something went wrong but the game carries on.
+    LOG_LEVEL_ERROR,   ///< Something the player will notice went wrong.
+    LOG_LEVEL_NONE     ///< Used as a filter level to silence a category.
+};
+
+/**
+ * @enum LogCategory
+ * @brief Subsystem a message comes from, each with its own level filter.
+ */
+enum LogCategory {
+    LOG_CATEGORY_GAME,   ///< Game state, UI and dialogue.
+    LOG_CATEGORY_PLAYER, ///< The samurai.
+    LOG_CATEGORY_DEMON,  ///< The demon.
+    LOG_CATEGORY_MAP,    ///< Maps, portals and transitions.
+    LOG_CATEGORY_COUNT
+};
+
+const char* const LOG_LEVEL_NAMES[LOG_LEVEL_NONE] = { "TRACE", "DEBUG", "INFO", "WARNING", "ERROR" };
+const char* const LOG_CATEGORY_NAMES[LOG_CATEGORY_COUNT] = { "game", "player", "demon", "map" };
+
+/**
+ * @class Logger
+ * @brief Bounded multi-producer queue of formatted messages and the thread that writes them out.
+ */
+class Logger {
+public:
+    static const uint32_t CAPACITY = 1024;        ///< Messages the ring buffer holds. Must be a power of two.
+    static const uint32_t MESSAGE_LENGTH = 240;   ///< Longest message kept, longer ones are truncated.
+
+    /**
+     * @brief Starts the writer thread.
+     * @param level Lowest level logged in every category until changed with setLevel().
+     */
+    explicit Logger(LogLevel level = LOG_LEVEL_INFO) : start(std::chrono::steady_clock::now()) {
+        for (uint32_t i = 0; i < CAPACITY; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+        for (int i = 0; i < LOG_CATEGORY_COUNT; i++) levels[i].store(level, std::memory_order_relaxed);
+        writer = std::thread(&Logger::run, this);
+    }
+
+    ~Logger() {
+        shutdown();
+    }
+
+    /**
+     * @brief Sets the lowest level logged for a category.
+     * @param category Category to filter.
+     * @param level Lowest level that gets through, or LOG_LEVEL_NONE to silence the category.
+     */
+    void setLevel(LogCategory category, LogLevel level) {
+        levels[category].store(level, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets the lowest level logged for every category.
+     * @param level Lowest level that gets through, or LOG_LEVEL_NONE to silence everything.
+     */
+    void setLevel(LogLevel level) {
+        for (int i = 0; i < LOG_CATEGORY_COUNT; i++) setLevel((LogCategory)i, level);
+    }
+
+    /**
+     * @brief Checks whether a message would get through the filters, before paying for formatting it.
+     */
+    bool isEnabled(LogLevel level, LogCategory category) const {
+        return level >= levels[category].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Queues a printf-style message. Drops it if the ring buffer is full.
+     * @param level Severity of the message.
+     * @param category Subsystem the message comes from.
+     * @param format printf-style format string, without a trailing newline.
+     */
+    void log(LogLevel level, LogCategory category, const char* format, ...)
+#if defined(__GNUC__)
+        __attribute__((format(printf, 4, 5)))
+#endif
+    {
+        va_list args;
+        va_start(args, format);
+        write(level, category, format, args);
+        va_end(args);
+    }
+
+    /**
+     * @brief Queues a message like log(), taking the format arguments as a va_list.
+     */
+    void write(LogLevel level, LogCategory category, const char* format, va_list args) {
+        // Claim the next slot, as long as the writer has emptied it since its previous lap around the buffer
+        Slot* slot;
+        uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &slots[position & (CAPACITY - 1)];
+            uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (sequence < position) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->level = level;
+        slot->category = category;
+        slot->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        vsnprintf(slot->message, MESSAGE_LENGTH, format, args);
+        slot->sequence.store(position + 1, std::memory_order_release); // Hand the slot to the writer
+    }
+
+    /**
+     * @brief Writes out everything queued so far and stops the writer thread. Later messages are dropped.
+     */
+    void shutdown() {
+        if (!writer.joinable()) return;
+        isRunning.store(false, std::memory_order_release);
+        writer.join();
+    }
+
+    /**
+     * @brief Gets the number of messages dropped because the ring buffer was full.
+     */
+    uint64_t getDropped() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    /**
+     * @struct Slot
+     * @brief One queued message. Its sequence number says whether a producer or the writer owns it.
+     */
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        LogLevel level;
+        LogCategory category;
+        double seconds; ///< Time since the logger started.
+        char message[MESSAGE_LENGTH];
+    };
+
+    Slot slots[CAPACITY];
+    std::atomic<uint64_t> enqueuePosition{0};
+    uint64_t dequeuePosition = 0; ///< Only touched by the writer thread.
+    std::atomic<LogLevel> levels[LOG_CATEGORY_COUNT];
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> isRunning{true};
+    std::chrono::steady_clock::time_point start;
+    std::thread writer;
+
+    /**
+     * @brief Writes out every message whose slot has been filled, in order.
+     * @return The number of messages written.
+     */
+    int drain() {
+        int count = 0;
+        for (;;) {
+            Slot& slot = slots[dequeuePosition & (CAPACITY - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) break;
+
+            fprintf(stdout, "[%9.3f] %-7s %-6s %s\n", slot.seconds, LOG_LEVEL_NAMES[slot.level],
+                    LOG_CATEGORY_NAMES[slot.category], slot.message);
+            slot.sequence.store(dequeuePosition + CAPACITY, std::memory_order_release); // Free it for the next lap
+            dequeuePosition++;
+            count++;
+        }
+        if (count > 0) fflush(stdout);
+        return count;
+    }
+
+    void run() {
+        uint64_t reportedDropped = 0;
+        while (isRunning.load(std::memory_order_acquire)) {
+            if (drain() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            reportDropped(&reportedDropped);
+        }
+        drain();
+        reportDropped(&reportedDropped);
+    }
+
+    void reportDropped(uint64_t* reportedDropped) {
+        uint64_t droppedNow = dropped.load(std::memory_order_relaxed);
+        if (droppedNow == *reportedDropped) return;
+        fprintf(stdout, "Logger: Dropped %llu messages, the ring buffer was full\n",
+                (unsigned long long)(droppedNow - *reportedDropped));
+        fflush(stdout);
+        *reportedDropped = droppedNow;
+    }
+};
+
+/**
+ * @brief Gets the logger shared by the whole game, starting it on first use.
+ */
+inline Logger& getLogger() {
+#ifdef NDEBUG
+    static Logger logger(LOG_LEVEL_INFO);
+#else
+    static Logger logger(LOG_LEVEL_DEBUG);
+#endif
+    return logger;
+}
+
+/**
+ * @class LogRateLimit
+ * @brief Lets one message through per interval and counts the ones it holds back.
+ */
+class LogRateLimit {
+public:
+    /**
+     * @param intervalSeconds Shortest time between two messages that get through.
+     */
+    explicit LogRateLimit(double intervalSeconds)
+        : interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+              std::chrono::duration<double>(intervalSeconds)).count()) {}
+
+    /**
+     * @brief Decides whether a message gets through now.
+     * @param suppressed Set to the number of messages held back since the last one that got through.
+     * @return True if the message should be logged.
+     */
+    bool allow(uint32_t* suppressed) {
+        int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+        int64_t next = nextAllowed.load(std::memory_order_relaxed);
+        if (now < next || !nextAllowed.compare_exchange_strong(next, now + interval, std::memory_order_relaxed)) {
+            skipped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        *suppressed = skipped.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    int64_t interval; ///< In steady_clock ticks.
+    std::atomic<int64_t> nextAllowed{0};
+    std::atomic<uint32_t> skipped{0};
+};
+
+/// Logs a printf-style message if its level gets through the category's filter.
+#define GAME_LOG(level, category, ...) \
+    do { \
+        if (getLogger().isEnabled(level, category)) getLogger().log(level, category, __VA_ARGS__); \
+    } while (0)
+
+/// Like GAME_LOG(), but this call site logs at most once every given number of seconds.
+#define GAME_LOG_EVERY(seconds, level, category, ...) \
+    do { \
+        static LogRateLimit logRateLimit(seconds); \
+        uint32_t logSuppressed; \
+        if (getLogger().isEnabled(level, category) && logRateLimit.allow(&logSuppressed)) { \
+            getLogger().log(level, category, __VA_ARGS__); \
+            if (logSuppressed > 0) \
+                getLogger().log(level, category, "(%u similar messages suppressed)", logSuppressed); \
+        } \
+    } while (0)
+
+#endif // LOG_H
@@ -0,0 +1,316 @@
+#ifndef MAP_CACHE_H
+#define MAP_CACHE_H
+
+#include "raylib.h"
+#include "raytmx.h"
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * @file MapCache.h
+ * @brief Keeps recently visited maps resident so returning to a room costs a pointer swap.
+ *
+ * Maps are kept in least-recently-used order and evicted once their combined
+ * size exceeds a memory budget. Tileset textures are shared between maps by
+ * image path, so each tileset image is uploaded to VRAM once however many
+ * resident maps use it.
+ */
+
+/**
+ * @class MapCache
+ * @brief LRU cache of loaded TMX maps with a memory budget.
+ *
+ * The cache owns every map inserted into it and unloads them on eviction or
+ * destruction. The pinned map, normally the one being played, and the most
+ * recently used map are never evicted.
+ */
+class MapCache {
+public:
+    /**
+     * @brief Constructs an empty cache.
+     * @param budgetBytes Memory, in bytes, that resident maps and their textures may use.
+     */
+    explicit MapCache(size_t budgetBytes = 32 * 1024 * 1024) : budget(budgetBytes) {}
+
+    ~MapCache() {
+        clear();
+    }
+
+    /**
+     * @brief Looks up a map and marks it as most recently used. Counts a hit or a miss.
+     * @param fileName Path of the TMX document the map was loaded from.
+     * @return The resident map, or NULL if it isn't cached.
+     */
+    TmxMap* acquire(const std::string& fileName) {
+        std::list<Entry>::iterator entry = find(fileName);
+        if (entry == entries.end()) {
+            misses++;
+            return NULL;
+        }
+        hits++;
+        entries.splice(entries.begin(), entries, entry);
+        return entry->map;
+    }
+
+    /**
+     * @brief Looks up a map without counting a hit or miss or changing its place in the LRU order.
+     * @param fileName Path of the TMX document the map was loaded from.
+     * @return The resident map, or NULL if it isn't cached.
+     */
+    TmxMap* peek(const std::string& fileName) {
+        std::list<Entry>::iterator entry = find(fileName);
+        return entry != entries.end() ? entry->map : NULL;
+    }
+
+    /**
+     * @brief Checks whether a map is resident without counting a hit or miss.
+     * @param fileName Path of the TMX document.
+     * @return True if the map is cached.
+     */
+    bool contains(const std::string& fileName) {
+        return find(fileName) != entries.end();
+    }
+
+    /**
+     * @brief Takes ownership of a freshly loaded map, uploading any textures it doesn't share.
+     *
+     * Must be called on the main thread. Tileset images already resident for
+     * another map are reused instead of being uploaded again. Least recently
+     * used maps are then evicted until the cache fits its budget. If the map
+     * is resident already, perhaps pinned and being played, the resident copy
+     * is kept and a different one passed in is unloaded.
+     *
+     * @param fileName Path of the TMX document the map was loaded from.
+     * @param map The loaded map, with textures uploaded or still pending.
+     * @return The map now owned by the cache for fileName, marked as most recently used.
+     */
+    TmxMap* insert(const std::string& fileName, TmxMap* map) {
+        if (!map) return NULL;
+        std::list<Entry>::iterator existing = find(fileName);
+        if (existing != entries.end()) {
+            if (existing->map != map) UnloadTMX(map);
+            entries.splice(entries.begin(), entries, existing);
+            return existing->map;
+        }
+
+        Entry entry;
+        entry.fileName = fileName;
+        entry.map = map;
+        entry.bytes = estimateMapBytes(map);
+        shareTilesetTextures(entry);
+        entries.push_front(entry);
+        residentBytes += entry.bytes;
+
+        evictToBudget();
+        return map;
+    }
+
+    /**
+     * @brief Protects a map from eviction, typically the one currently being played.
+     * @param map The map to pin, or NULL to pin nothing.
+     */
+    void pin(TmxMap* map) {
+        pinned = map;
+    }
+
+    /**
+     * @brief Changes the memory budget, evicting maps if the cache no longer fits.
+     * @param budgetBytes Memory, in bytes, that resident maps and their textures may use.
+     */
+    void setBudget(size_t budgetBytes) {
+        budget = budgetBytes;
+        evictToBudget();
+    }
+
+    /**
+     * @brief Unloads every map, including the pinned one.
+     */
+    void clear() {
+        while (!entries.empty()) remove(entries.begin());
+        pinned = NULL;
+    }
+
+    size_t getBudget() const { return budget; }             ///< Memory budget in bytes.
+    size_t getResidentBytes() const { return residentBytes; } ///< Estimated bytes used by resident maps and textures.
+    size_t getMapCount() const { return entries.size(); }   ///< Number of resident maps.
+    unsigned int getHits() const { return hits; }           ///< Lookups that found a resident map.
+    unsigned int getMisses() const { return misses; }       ///< Lookups that had to load the map.
+    unsigned int getEvictions() const { return evictions; } ///< Maps unloaded to stay within the budget.
+
+private:
+    /**
+     * @struct Entry
+     * @brief A resident map and the shared textures its tilesets use.
+     */
+    struct Entry {
+        std::string fileName;             ///< Path of the TMX document.
+        TmxMap* map;                      ///< The loaded map.
+        size_t bytes;                     ///< Estimated RAM used by the map itself.
+        std::vector<std::string> textureKeys; ///< Keys of the shared textures referenced, one per tileset image.
+    };
+
+    /**
+     * @struct SharedTexture
+     * @brief A tileset texture used by one or more resident maps.
+     */
+    struct SharedTexture {
+        Texture2D texture;
+        int references;
+    };
+
+    std::list<Entry> entries;                      ///< Resident maps, most recently used first.
+    std::map<std::string, SharedTexture> textures; ///< Shared tileset textures by image path.
+    TmxMap* pinned = NULL;
+    size_t budget;
+    size_t residentBytes = 0;
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int evictions = 0;
+
+    std::list<Entry>::iterator find(const std::string& fileName) {
+        for (std::list<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+            if (it->fileName == fileName) return it;
+        }
+        return entries.end();
+    }
+
+    /**
+     * @brief Estimates the RAM a map occupies, including tile arrays read from a mapped baked file.
+     */
+    static size_t estimateMapBytes(const TmxMap* map) {
+        size_t bytes = sizeof(TmxMap) + sizeof(TmxTileset) * map->tilesetsLength + sizeof(TmxTile) * map->gidsToTilesLength;
+        for (uint32_t i = 0; i < map->layersLength; i++) {
+            const TmxLayer& layer = map->layers[i];
+            bytes += sizeof(TmxLayer);
+            if (layer.type == LAYER_TYPE_TILE_LAYER) {
+                bytes += sizeof(uint32_t) * layer.exact.tileLayer.tilesLength;
+            } else if (layer.type == LAYER_TYPE_OBJECT_GROUP) {
+                const TmxObjectGroup& group = layer.exact.objectGroup;
+                bytes += (sizeof(TmxObject) + sizeof(uint32_t)) * group.objectsLength;
+                if (group.bvh) bytes += sizeof(TmxObjectBvhNode) * group.bvhLength + sizeof(uint32_t) * group.objectsLength;
+                for (uint32_t j = 0; j < group.objectsLength; j++) {
+                    bytes += 2 * sizeof(Vector2) * group.objects[j].pointsLength; // 'points' and 'drawPoints'
+                }
+            }
+        }
+        return bytes;
+    }
+
+    /**
+     * @brief Estimates the VRAM a texture occupies, assuming 32-bit pixels.
+     */
+    static size_t estimateTextureBytes(Texture2D texture) {
+        return (size_t)texture.width * texture.height * 4;
+    }
+
+    /**
+     * @brief Builds the key identifying a tileset image across maps: its path relative to the working directory.
+     */
+    static std::string textureKey(const std::string& fileName, const TmxTileset& tileset) {
+        std::string key = GetDirectoryPath(fileName.c_str());
+        key += "/";
+        if (tileset.source) {
+            // External tilesets' images are relative to the TSX, not the TMX
+            std::string source = tileset.source;
+            size_t slash = source.find_last_of("/\\");
+            if (slash != std::string::npos) key += source.substr(0, slash + 1);
+        }
+        key += tileset.image.source;
+        return key;
+    }
+
+    /**
+     * @brief Points a new map's tilesets at resident textures where possible and uploads the rest.
+     */
+    void shareTilesetTextures(Entry& entry) {
+        TmxMap* map = entry.map;
+        std::vector<unsigned int> released; // IDs of the map's own textures replaced by shared ones
+
+        for (uint32_t i = 0; i < map->tilesetsLength; i++) {
+            TmxTileset& tileset = map->tilesets[i];
+            if (!tileset.hasImage) continue;
+
+            std::map<std::string, SharedTexture>::iterator shared = textures.find(textureKey(entry.fileName, tileset));
+            if (shared == textures.end()) continue;
+
+            if (tileset.image.pendingImage.data) {
+                // Decoded but never uploaded, so drop the pixels along with every tileset sharing them
+                void* data = tileset.image.pendingImage.data;
+                UnloadImage(tileset.image.pendingImage);
+                for (uint32_t j = i; j < map->tilesetsLength; j++) {
+                    if (map->tilesets[j].image.pendingImage.data == data) map->tilesets[j].image.pendingImage = Image{};
+                }
+            } else if (tileset.image.texture.id != 0 && tileset.image.texture.id != shared->second.texture.id) {
+                bool isReleased = false;
+                for (unsigned int id : released) isReleased = isReleased || id == tileset.image.texture.id;
+                if (!isReleased) {
+                    released.push_back(tileset.image.texture.id);
+                    UnloadTexture(tileset.image.texture);
+                }
+            }
+            tileset.image.texture = shared->second.texture;
+        }
+
+        // Upload whatever isn't shared yet and point the GID-to-tile table at the final textures
+        UploadTMXTextures(map);
+
+        for (uint32_t i = 0; i < map->tilesetsLength; i++) {
+            const TmxTileset& tileset = map->tilesets[i];
+            if (!tileset.hasImage || tileset.image.texture.id == 0) continue;
+
+            std::string key = textureKey(entry.fileName, tileset);
+            std::map<std::string, SharedTexture>::iterator shared = textures.find(key);
+            if (shared == textures.end()) {
+                SharedTexture texture = { tileset.image.texture, 0 };
+                shared = textures.insert(std::make_pair(key, texture)).first;
+                residentBytes += estimateTextureBytes(tileset.image.texture);
+            }
+            shared->second.references++;
+            entry.textureKeys.push_back(key);
+        }
+    }
+
+    /**
+     * @brief Unloads a map, releasing its shared textures once no resident map uses them.
+     */
+    void remove(std::list<Entry>::iterator entry) {
+        TmxMap* map = entry->map;
+        // Detach shared textures so UnloadTMX() doesn't unload them from under other maps
+        for (uint32_t i = 0; i < map->tilesetsLength; i++) {
+            if (map->tilesets[i].hasImage && map->tilesets[i].image.texture.id != 0) map->tilesets[i].image.texture = Texture2D{};
+        }
+        for (const std::string& key : entry->textureKeys) {
+            std::map<std::string, SharedTexture>::iterator shared = textures.find(key);
+            if (shared == textures.end() || --shared->second.references > 0) continue;
+            residentBytes -= estimateTextureBytes(shared->second.texture);
+            UnloadTexture(shared->second.texture);
+            textures.erase(shared);
+        }
+
+        if (pinned == map) pinned = NULL;
+        residentBytes -= entry->bytes;
+        UnloadTMX(map);
+        entries.erase(entry);
+    }
+
+    /**
+     * @brief Evicts least recently used maps, never the pinned or most recent one, until the cache fits its budget.
+     */
+    void evictToBudget() {
+        std::list<Entry>::iterator it = entries.end();
+        while (residentBytes > budget && it != entries.begin()) {
+            --it;
+            if (it == entries.begin()) break; // The most recently used map is the one just inserted or acquired
+            if (it->map == pinned) continue;
+            TraceLog(LOG_INFO, "Map cache: evicting %s (%.1f MB resident, budget %.1f MB)", it->fileName.c_str(),
+                     residentBytes / (1024.0 * 1024.0), budget / (1024.0 * 1024.0));
+            std::list<Entry>::iterator victim = it++;
+            remove(victim);
+            evictions++;
+        }
+    }
+};
+
+#endif // MAP_CACHE_H
@@ -0,0 +1,110 @@
+#ifndef MAP_LOADER_H
+#define MAP_LOADER_H
+
+#include "raylib.h"
+#include "raytmx.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+/**
+ * @file MapLoader.h
+ * @brief Loads TMX maps in the background so that switching maps doesn't stall a frame.
+ *
+ * File I/O, XML parsing and image decoding run on a worker thread. Only the
+ * texture upload, which needs the OpenGL context, is left to the main thread.
+ */
+
+/**
+ * @class MapLoader
+ * @brief Loads one map at a time on a worker thread.
+ *
+ * Call request() to start a load, poll isReady() once per frame, then call
+ * finish() on the main thread to take the map. Its textures are still only
+ * decoded images; MapCache::insert() or UploadTMXTextures() uploads them.
+ */
+class MapLoader {
+public:
+    ~MapLoader() {
+        cancel();
+    }
+
+    /**
+     * @brief Starts loading a map on a worker thread.
+     * @param mapFileName Path to the TMX document to load.
+     * @return False if another load is still in progress.
+     */
+    bool request(const std::string& mapFileName) {
+        if (worker.joinable()) return false;
+
+        fileName = mapFileName;
+        ready.store(false, std::memory_order_relaxed);
+        worker = std::thread([this]() {
+            double startTime = GetTime();
+            result = LoadTMXEx(fileName.c_str(), LOAD_FROM_BINARY | LOAD_DEFER_TEXTURES);
+            loadTime = GetTime() - startTime;
+            ready.store(true, std::memory_order_release);
+        });
+        return true;
+    }
+
+    /**
+     * @brief Checks whether a load is in progress or waiting to be finished.
+     * @return True from request() until finish() or cancel().
+     */
+    bool isBusy() const {
+        return worker.joinable();
+    }
+
+    /**
+     * @brief Checks whether the worker has finished, so finish() won't block.
+     * @return True if the requested map is loaded.
+     */
+    bool isReady() const {
+        return ready.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Gets the path of the map most recently requested.
+     * @return The TMX path passed to request().
+     */
+    const std::string& getFileName() const {
+        return fileName;
+    }
+
+    /**
+     * @brief Takes the loaded map, with its textures not yet uploaded.
+     * @return The loaded map, or NULL if loading failed or nothing was requested.
+     */
+    TmxMap* finish() {
+        if (!worker.joinable()) return NULL;
+        worker.join();
+        ready.store(false, std::memory_order_relaxed);
+
+        TmxMap* loaded = result;
+        result = NULL;
+        TraceLog(LOG_DEBUG, "Loaded %s in %.2f ms on the worker", fileName.c_str(), loadTime * 1000.0);
+        return loaded;
+    }
+
+    /**
+     * @brief Waits for any load in progress and discards its map.
+     */
+    void cancel() {
+        if (worker.joinable()) worker.join();
+        if (result) {
+            UnloadTMX(result);
+            result = NULL;
+        }
+        ready.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    std::thread worker;              ///< Thread running the current load, if any.
+    std::atomic<bool> ready{false};  ///< Set by the worker once 'result' is written.
+    TmxMap* result = NULL;           ///< Map loaded by the worker, not yet taken by finish().
+    std::string fileName;            ///< Path of the map being loaded.
+    double loadTime = 0.0;           ///< Seconds the worker spent loading.
+};
+
+#endif // MAP_LOADER_H
@@ -0,0 +1,155 @@
+#ifndef MAP_PREFETCHER_H
+#define MAP_PREFETCHER_H
+
+#include "raylib.h"
+#include "MapCache.h"
+#include "MapLoader.h"
+#include "Portals.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * @file MapPrefetcher.h
+ * @brief Loads the destination of a nearby portal before the samurai reaches it.
+ *
+ * Each frame the portals leading out of the current map are checked against
+ * the samurai's position. When one is within the prefetch distance and its
+ * destination isn't resident, the destination is loaded on a worker thread
+ * and put in the map cache, so the transition finds it already there.
+ */
+
+/**
+ * @class MapPrefetcher
+ * @brief Speculatively loads maps reachable through nearby portals.
+ */
+class MapPrefetcher {
+public:
+    /**
+     * @brief Constructs a prefetcher that fills the given cache.
+     * @param mapCache Cache that prefetched maps are inserted into.
+     * @param portalIndex Portals whose destinations may be prefetched.
+     * @param prefetchDistance Distance, in pixels, from a portal at which its destination starts loading.
+     */
+    MapPrefetcher(MapCache& mapCache, const PortalIndex& portalIndex, float prefetchDistance = 600.0f)
+        : cache(mapCache), portals(portalIndex), distance(prefetchDistance) {}
+
+    /**
+     * @brief Finishes completed prefetches and starts a new one if a portal is close. Call once per frame.
+     * @param currentMap Path of the map being played.
+     * @param position Top-left corner of the samurai's rectangle.
+     */
+    void update(const std::string& currentMap, Vector2 position) {
+        if (loader.isReady()) {
+            TmxMap* loaded = loader.finish();
+            if (loaded) {
+                cache.insert(loader.getFileName(), loaded);
+                if (!isConsumed) unused.push_back(loader.getFileName());
+            } else {
+                wasted++;
+                failed.push_back(loader.getFileName());
+            }
+            isConsumed = false;
+        }
+
+        // Prefetched maps evicted before anyone went through the portal were loaded for nothing
+        for (size_t i = 0; i < unused.size();) {
+            if (cache.contains(unused[i])) {
+                i++;
+            } else {
+                wasted++;
+                unused.erase(unused.begin() + i);
+            }
+        }
+
+        // A failed map is tried again once the samurai has left its portals' range, in case it has been fixed since
+        for (size_t i = 0; i < failed.size();) {
+            bool isInRange = false;
+            for (const Portal* portal : portals.getPortalsFrom(currentMap)) {
+                if (failed[i] != portal->toMap) continue;
+                isInRange = isInRange || distanceToRect(position, portal->trigger) <= distance;
+            }
+            if (isInRange) {
+                i++;
+            } else {
+                failed.erase(failed.begin() + i);
+            }
+        }
+
+        if (loader.isBusy()) return;
+
+        // Prefetch the destination of the closest portal in range that isn't resident yet
+        const Portal* closest = NULL;
+        float closestDistance = distance;
+        for (const Portal* portal : portals.getPortalsFrom(currentMap)) {
+            if (currentMap == portal->toMap) continue;
+            if (std::find(failed.begin(), failed.end(), portal->toMap) != failed.end()) continue; // Don't retry every frame
+
+            float portalDistance = distanceToRect(position, portal->trigger);
+            if (portalDistance <= closestDistance && !cache.contains(portal->toMap)) {
+                closest = portal;
+                closestDistance = portalDistance;
+            }
+        }
+        if (closest && loader.request(closest->toMap)) {
+            issued++;
+            TraceLog(LOG_DEBUG, "Prefetching %s, %.0f px from its portal", closest->toMap, closestDistance);
+        }
+    }
+
+    /**
+     * @brief Checks whether a map is being prefetched right now.
+     * @param fileName Path of the TMX document.
+     * @return True if the worker is loading that map.
+     */
+    bool isLoading(const std::string& fileName) const {
+        return loader.isBusy() && loader.getFileName() == fileName;
+    }
+
+    /**
+     * @brief Records a transition to a map, counting a prefetch hit if the map was prefetched.
+     * @param fileName Path of the map being switched to.
+     */
+    void onTransition(const std::string& fileName) {
+        transitions++;
+        // The transition loads the map itself, so a later failure is its own and not a stale one
+        failed.erase(std::remove(failed.begin(), failed.end(), fileName), failed.end());
+        std::vector<std::string>::iterator it = std::find(unused.begin(), unused.end(), fileName);
+        if (it != unused.end()) {
+            hits++;
+            unused.erase(it);
+        } else if (isLoading(fileName)) {
+            // Still in flight, but already partly loaded by the time the fade started
+            hits++;
+            isConsumed = true;
+        }
+    }
+
+    unsigned int getIssued() const { return issued; }           ///< Prefetches started.
+    unsigned int getHits() const { return hits; }               ///< Transitions to a prefetched map.
+    unsigned int getTransitions() const { return transitions; } ///< Transitions recorded.
+    unsigned int getWasted() const { return wasted; }           ///< Prefetches that failed or were evicted unused.
+
+    /**
+     * @brief Gets the share of transitions whose map had been prefetched.
+     * @return A ratio between 0 and 1, or 0 before any transition.
+     */
+    float getHitRate() const {
+        return transitions > 0 ? (float)hits / transitions : 0.0f;
+    }
+
+private:
+    MapCache& cache;                 ///< Cache that prefetched maps go into.
+    const PortalIndex& portals;      ///< Portals leading out of each map.
+    MapLoader loader;                ///< Worker for the prefetch in flight.
+    float distance;                  ///< Distance, in pixels, that triggers a prefetch.
+    std::vector<std::string> unused; ///< Prefetched maps that haven't been switched to yet.
+    std::vector<std::string> failed; ///< Maps that couldn't be loaded while in range, left to the transition to report.
+    bool isConsumed = false;         ///< Whether a transition already wants the map in flight.
+    unsigned int issued = 0;
+    unsigned int hits = 0;
+    unsigned int transitions = 0;
+    unsigned int wasted = 0;
+};
+
+#endif // MAP_PREFETCHER_H
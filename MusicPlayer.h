@@ -0,0 +1,274 @@
+#ifndef MUSIC_PLAYER_H
+#define MUSIC_PLAYER_H
+
+#include "raylib.h"
+#include "Log.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+/**
+ * @file MusicPlayer.h
+ * @brief Streams music on a thread of its own, so decoding never costs the main loop any time.
+ *
+ * Refilling a music stream is where raylib decodes the next stretch of the
+ * MP3, and doing it at the top of every frame put that work on the render
+ * thread. The music player's worker thread owns every Music stream instead:
+ * it loads them, keeps their buffers topped up and applies volume changes.
+ * The main thread only posts commands, such as crossfading to another track,
+ * into a fixed-size single-producer ring buffer that the worker drains, so
+ * posting never waits on a lock or on the decoder.
+ */
+
+/// Index of a track added to the MusicPlayer.
+typedef int MusicTrack;
+
+const MusicTrack INVALID_MUSIC_TRACK = -1;
+
+/**
+ * @class MusicPlayer
+ * @brief Worker thread that streams music tracks and crossfades between them on request.
+ *
+ * Commands must all be posted from the same thread, normally the main one.
+ */
+class MusicPlayer {
+public:
+    static const int MAX_TRACKS = 8;             ///< Tracks that can be added.
+    static const uint32_t COMMAND_CAPACITY = 64; ///< Commands the ring buffer holds. Must be a power of two.
+    static const uint32_t PATH_LENGTH = 256;     ///< Longest track path kept.
+
+    /**
+     * @brief Starts the worker thread. Tracks can be added once the audio device is initialized.
+     */
+    MusicPlayer() {
+        worker = std::thread(&MusicPlayer::run, this);
+    }
+
+    ~MusicPlayer() {
+        shutdown();
+    }
+
+    MusicPlayer(const MusicPlayer&) = delete;
+    MusicPlayer& operator=(const MusicPlayer&) = delete;
+
+    /**
+     * @brief Has the worker load a track.
+     * @param path Path of the music file.
+     * @param volume Volume of the track when fully faded in, from 0 to 1.
+     * @return The track to refer to it by, or INVALID_MUSIC_TRACK if no more tracks can be added.
+     */
+    MusicTrack addTrack(const char* path, float volume = 1.0f) {
+        if (trackCount == MAX_TRACKS) {
+            GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_GAME, "Music player: no room for %s", path);
+            return INVALID_MUSIC_TRACK;
+        }
+        Command command = { COMMAND_LOAD, trackCount, volume, {} };
+        strncpy(command.path, path, PATH_LENGTH - 1);
+        post(command);
+        return trackCount++;
+    }
+
+    /**
+     * @brief Fades a track in from the start, or from where it was if it is still fading out, and every
+     *        other track out, both over the same time.
+     * @param track Track to switch to.
+     * @param seconds Length of the crossfade, or 0 to cut over at once.
+     */
+    void crossfadeTo(MusicTrack track, float seconds) {
+        post({ COMMAND_CROSSFADE, track, seconds, {} });
+        currentTrack = track;
+    }
+
+    /**
+     * @brief Pauses the track last crossfaded to, or resumes it if it was paused. Tracks fading out carry on, and
+     *        the next crossfade resumes the paused track.
+     */
+    void togglePause() {
+        post({ COMMAND_TOGGLE_PAUSE, INVALID_MUSIC_TRACK, 0.0f, {} });
+    }
+
+    /**
+     * @brief Gets the track last crossfaded to, or INVALID_MUSIC_TRACK if none was.
+     */
+    MusicTrack getCurrentTrack() const {
+        return currentTrack;
+    }
+
+    /**
+     * @brief Stops the worker thread, which stops and unloads every track first. Call before closing the audio
+     *        device. Later commands are ignored.
+     */
+    void shutdown() {
+        if (!worker.joinable()) return;
+        isRunning.store(false, std::memory_order_release);
+        worker.join();
+    }
+
+private:
+    /**
+     * @enum CommandType
+     * @brief What a command asks the worker to do.
+     */
+    enum CommandType {
+        COMMAND_LOAD,         ///< Load the track from path, at the volume in value.
+        COMMAND_CROSSFADE,    ///< Crossfade to the track over the seconds in value.
+        COMMAND_TOGGLE_PAUSE  ///< Pause or resume the current track.
+    };
+
+    /**
+     * @struct Command
+     * @brief A request from the main thread to the worker.
+     */
+    struct Command {
+        CommandType type;
+        MusicTrack track;
+        float value;
+        char path[PATH_LENGTH];
+    };
+
+    /**
+     * @struct Track
+     * @brief A music stream and how far it is faded in. Only touched by the worker.
+     */
+    struct Track {
+        Music music;
+        float volume;   ///< Volume when fully faded in.
+        float gain;     ///< How far the track is faded in, from 0 to 1.
+        float target;   ///< Gain the track is fading towards.
+        float fadeRate; ///< Gain the fade changes by per second.
+        bool isPlaying;
+        bool isPaused;  ///< Paused by a toggle, which holds its fade too.
+    };
+
+    Command commands[COMMAND_CAPACITY];
+    std::atomic<uint32_t> writePosition{0}; ///< Next command the main thread fills.
+    std::atomic<uint32_t> readPosition{0};  ///< Next command the worker reads.
+    std::atomic<bool> isRunning{true};
+    MusicTrack trackCount = 0;                     ///< Only touched by the thread posting commands.
+    MusicTrack currentTrack = INVALID_MUSIC_TRACK; ///< Only touched by the thread posting commands.
+    Track tracks[MAX_TRACKS] = {};                 ///< Only touched by the worker.
+    MusicTrack playingTrack = INVALID_MUSIC_TRACK; ///< Track last crossfaded to. Only touched by the worker.
+    std::thread worker;
+
+    void post(const Command& command) {
+        uint32_t position = writePosition.load(std::memory_order_relaxed);
+        if (position - readPosition.load(std::memory_order_acquire) == COMMAND_CAPACITY) {
+            GAME_LOG(LOG_LEVEL_WARNING, LOG_CATEGORY_GAME, "Music player: command dropped, the ring buffer was full");
+            return;
+        }
+        commands[position & (COMMAND_CAPACITY - 1)] = command;
+        writePosition.store(position + 1, std::memory_order_release); // Hand the command to the worker
+    }
+
+    void run() {
+        std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+        while (isRunning.load(std::memory_order_acquire)) {
+            processCommands();
+
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            float deltaTime = std::chrono::duration<float>(now - last).count();
+            last = now;
+            updateTracks(deltaTime);
+
+            // Well within the time a stream buffer lasts, so refills keep ahead of playback
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+
+        for (MusicTrack i = 0; i < MAX_TRACKS; i++) {
+            if (tracks[i].music.frameCount == 0) continue;
+            StopMusicStream(tracks[i].music);
+            UnloadMusicStream(tracks[i].music);
+            tracks[i].music = Music{};
+        }
+    }
+
+    void processCommands() {
+        uint32_t position = readPosition.load(std::memory_order_relaxed);
+        while (position != writePosition.load(std::memory_order_acquire)) {
+            const Command& command = commands[position & (COMMAND_CAPACITY - 1)];
+            switch (command.type) {
+                case COMMAND_LOAD: load(command.track, command.path, command.value); break;
+                case COMMAND_CROSSFADE: crossfade(command.track, command.value); break;
+                case COMMAND_TOGGLE_PAUSE: togglePlayback(); break;
+            }
+            position++;
+            readPosition.store(position, std::memory_order_release); // Free the slot for the main thread
+        }
+    }
+
+    void load(MusicTrack index, const char* path, float volume) {
+        Track& track = tracks[index];
+        track.music = LoadMusicStream(path);
+        track.volume = volume;
+        if (track.music.frameCount == 0) {
+            GAME_LOG(LOG_LEVEL_ERROR, LOG_CATEGORY_GAME, "Music player: failed to load %s", path);
+        }
+    }
+
+    void crossfade(MusicTrack index, float seconds) {
+        float fadeRate = seconds > 0.0f ? 1.0f / seconds : 0.0f;
+        playingTrack = index;
+        for (MusicTrack i = 0; i < MAX_TRACKS; i++) {
+            Track& track = tracks[i];
+            if (track.music.frameCount == 0) continue;
+
+            track.target = i == index ? 1.0f : 0.0f;
+            track.fadeRate = fadeRate;
+            if (track.isPaused) {
+                // A pause only lasts until the music changes, so a track paused in game can still fade out
+                ResumeMusicStream(track.music);
+                track.isPaused = false;
+            }
+            if (i == index && !track.isPlaying) {
+                track.gain = fadeRate > 0.0f ? 0.0f : 1.0f;
+                SetMusicVolume(track.music, track.gain * track.volume);
+                PlayMusicStream(track.music);
+                track.isPlaying = true;
+            }
+        }
+    }
+
+    void togglePlayback() {
+        if (playingTrack == INVALID_MUSIC_TRACK) return;
+        Track& track = tracks[playingTrack];
+        if (!track.isPlaying) return;
+
+        track.isPaused = !track.isPaused;
+        if (track.isPaused) PauseMusicStream(track.music);
+        else ResumeMusicStream(track.music);
+    }
+
+    void updateTracks(float deltaTime) {
+        for (MusicTrack i = 0; i < MAX_TRACKS; i++) {
+            Track& track = tracks[i];
+            if (!track.isPlaying) continue;
+
+            // Decoding happens here, as the stream's buffers are refilled
+            UpdateMusicStream(track.music);
+            if (track.isPaused || track.gain == track.target) continue;
+
+            float step = track.fadeRate > 0.0f ? track.fadeRate * deltaTime : 1.0f;
+            if (track.gain < track.target) track.gain = std::min(track.gain + step, track.target);
+            else track.gain = std::max(track.gain - step, track.target);
+            SetMusicVolume(track.music, track.gain * track.volume);
+
+            if (track.gain == 0.0f) {
+                StopMusicStream(track.music); // Faded out, so the next crossfade to it starts from the top
+                track.isPlaying = false;
+            }
+        }
+    }
+};
+
+/**
+ * @brief Gets the music player shared by the whole game, starting its worker on first use.
+ */
+inline MusicPlayer& getMusicPlayer() {
+    static MusicPlayer player;
+    return player;
+}
+
+#endif // MUSIC_PLAYER_H
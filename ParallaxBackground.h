@@ -0,0 +1,102 @@
+#ifndef PARALLAX_BACKGROUND_H
+#define PARALLAX_BACKGROUND_H
+
+#include "raylib.h"
+#include <cmath>
+#include <vector>
+
+/**
+ * @file ParallaxBackground.h
+ * @brief Draws repeating background textures behind the map, each scrolling at its own depth.
+ *
+ * A layer isn't drawn tile by tile. Its texture is set to wrap and the part
+ * of the layer under the camera is drawn as one quad, with texture
+ * coordinates that run past the texture's edges where it repeats. Each
+ * layer therefore costs one draw call however large the area it covers.
+ */
+
+/**
+ * @struct ParallaxLayer
+ * @brief A texture repeated over an area of the world.
+ */
+struct ParallaxLayer {
+    Texture2D texture; ///< Texture to repeat, set to wrap when the layer is added.
+    float scale;       ///< Size of one repetition relative to the texture's size.
+    float factor;      ///< How fast the layer scrolls with the camera: 1 moves with the map, 0 stays on the screen.
+    Vector2 origin;    ///< Top-left corner of one of the repetitions, where the pattern is aligned.
+    Rectangle bounds;  ///< Area the layer covers, or zero width or height to cover everything.
+    Color tint;        ///< Tint the texture is drawn with.
+};
+
+/**
+ * @class ParallaxBackground
+ * @brief Layers of repeating textures drawn back to front, culled to the camera's view.
+ */
+class ParallaxBackground {
+public:
+    /**
+     * @brief Adds a layer in front of those added so far.
+     * @param texture Texture to repeat. Its wrap mode is changed to repeat.
+     * @param scale Size of one repetition relative to the texture's size.
+     * @param factor Scrolling speed relative to the map, 1 for none of the parallax effect.
+     * @param origin Top-left corner of one of the repetitions, in the coordinates of the layer.
+     * @param tint Tint the texture is drawn with.
+     * @param bounds Area the layer covers, in the same coordinates as the origin. Leave empty to cover everything.
+     */
+    void addLayer(Texture2D texture, float scale, float factor, Vector2 origin, Color tint,
+                  Rectangle bounds = { 0.0f, 0.0f, 0.0f, 0.0f }) {
+        SetTextureWrap(texture, TEXTURE_WRAP_REPEAT);
+        layers.push_back({ texture, scale, factor, origin, bounds, tint });
+    }
+
+    /**
+     * @brief Draws the visible part of every layer, one quad each. Call between BeginMode2D() and EndMode2D().
+     * @param camera Camera the map is being drawn with.
+     */
+    void draw(const Camera2D& camera) const {
+        Rectangle view;
+        view.x = camera.target.x - camera.offset.x / camera.zoom;
+        view.y = camera.target.y - camera.offset.y / camera.zoom;
+        view.width = GetScreenWidth() / camera.zoom;
+        view.height = GetScreenHeight() / camera.zoom;
+
+        for (const ParallaxLayer& layer : layers) {
+            if (layer.texture.id == 0 || layer.scale <= 0.0f) continue;
+
+            // A layer scrolling slower than the map is dragged along by the part of the camera's movement it lags
+            float shiftX = camera.target.x * (1.0f - layer.factor);
+            float shiftY = camera.target.y * (1.0f - layer.factor);
+
+            Rectangle area = view;
+            if (layer.bounds.width > 0.0f && layer.bounds.height > 0.0f) {
+                Rectangle bounds = { layer.bounds.x + shiftX, layer.bounds.y + shiftY,
+                                     layer.bounds.width, layer.bounds.height };
+                if (!CheckCollisionRecs(view, bounds)) continue;
+                area = GetCollisionRec(view, bounds);
+            }
+
+            // Offset into the pattern at the area's corner, wrapped to one repetition so it stays precise far away
+            float width = layer.texture.width * layer.scale;
+            float height = layer.texture.height * layer.scale;
+            float offsetX = fmodf(area.x - (layer.origin.x + shiftX), width);
+            float offsetY = fmodf(area.y - (layer.origin.y + shiftY), height);
+            if (offsetX < 0.0f) offsetX += width;
+            if (offsetY < 0.0f) offsetY += height;
+
+            Rectangle source = { offsetX / layer.scale, offsetY / layer.scale,
+                                 area.width / layer.scale, area.height / layer.scale };
+            DrawTexturePro(layer.texture, source, area, Vector2{ 0.0f, 0.0f }, 0.0f, layer.tint);
+        }
+    }
+
+    /**
+     * @brief Gets the number of layers, which is also the most draw calls a frame costs.
+     * @return The number of layers added.
+     */
+    size_t getLayerCount() const { return layers.size(); }
+
+private:
+    std::vector<ParallaxLayer> layers; ///< Layers from back to front.
+};
+
+#endif // PARALLAX_BACKGROUND_H
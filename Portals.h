@@ -0,0 +1,184 @@
+#ifndef PORTALS_H
+#define PORTALS_H
+
+#include "raylib.h"
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file Portals.h
+ * @brief Describes which maps lead to which, where the portals between them are and where they come out.
+ *
+ * Together the entries form a directed graph of maps. Trigger areas are in
+ * the world coordinates of the source map and are tested against the
+ * top-left corner of the samurai's rectangle. Adding a room only takes new
+ * entries in PORTALS; PortalIndex buckets them so each frame's lookup costs
+ * the same however many portals there are.
+ */
+
+/**
+ * @enum PortalEvent
+ * @brief Room-specific behaviour that goes with arriving through a portal.
+ */
+enum PortalEvent {
+    PORTAL_EVENT_NONE,       ///< Nothing special happens.
+    PORTAL_EVENT_DEMON_ROOM, ///< The destination is the demon's room: spawn it on the first visit and update it there.
+    PORTAL_EVENT_DIALOGUE    ///< Show one of the "wrong portal" lines once the fade-in ends.
+};
+
+/**
+ * @struct Portal
+ * @brief A one-way connection from an area of one map to a position on another map.
+ */
+struct Portal {
+    const char* fromMap; ///< Map the trigger area is in.
+    Rectangle trigger;   ///< Area the samurai has to reach, edges included.
+    const char* toMap;   ///< Map the portal leads to.
+    Vector2 arrival;     ///< Where the samurai is placed on the destination map.
+    int level;           ///< Main level (1 or 2) the destination map belongs to.
+    PortalEvent event;   ///< What else happens on arrival.
+};
+
+// Areas that are open-ended downwards in the game logic extend to the bottom of the map (500 tiles of 16 pixels)
+const Portal PORTALS[] = {
+    { "maps/LevelDesign.tmx",  { 920.0f, 1502.0f, 10.0f, 0.0f },       "maps/Room2.tmx",
+      { 540.0f, 2222.0f }, 1, PORTAL_EVENT_DEMON_ROOM },
+    { "maps/Room2.tmx",        { 530.0f, 2170.0f, 10.0f, 10.0f },      "maps/LevelDesign.tmx",
+      { 920.0f, 1519.5f }, 1, PORTAL_EVENT_NONE },
+    { "maps/LevelDesign.tmx",  { 5415.0f, 877.0f, 20.0f, 1.0f },       "maps/Room3.tmx",
+      { 1560.0f, 2190.25f }, 1, PORTAL_EVENT_DIALOGUE },
+    { "maps/Room3.tmx",        { 1540.0f, 2173.0f, 30.0f, 2.0f },      "maps/LevelDesign.tmx",
+      { 5895.0f, 892.0f }, 1, PORTAL_EVENT_NONE },
+    { "maps/LevelDesign.tmx",  { 8300.0f, 2173.0f, 20.0f, 3.0f },      "maps/Room4.tmx",
+      { 665.0f, 2222.0f }, 1, PORTAL_EVENT_NONE },
+    { "maps/Room4.tmx",        { 3050.0f, 2170.0f, 20.0f, 5830.0f },   "maps/LevelDesign.tmx",
+      { 9385.0f, 2062.25f }, 1, PORTAL_EVENT_NONE },
+    { "maps/LevelDesign.tmx",  { 18760.0f, 3660.0f, 80.0f, 4340.0f },  "maps/LevelDesign2.tmx",
+      { 200.0f, 1500.0f }, 2, PORTAL_EVENT_NONE },
+    { "maps/LevelDesign2.tmx", { 4400.0f, 2760.0f, 30.0f, 20.0f },     "maps/Lv2RoomOne.tmx",
+      { 0.0f, 224.0f }, 2, PORTAL_EVENT_NONE },
+    { "maps/Lv2RoomOne.tmx",   { 1000.0f, 1200.0f, 100.0f, 100.0f },   "maps/LevelDesign2.tmx",
+      { 3820.0f, 1218.77f }, 2, PORTAL_EVENT_NONE },
+    { "maps/LevelDesign2.tmx", { 5600.0f, 3300.0f, 100.0f, 100.0f },   "maps/Lv2RoomTwo.tmx",
+      { 0.0f, 224.0f }, 2, PORTAL_EVENT_NONE },
+    { "maps/Lv2RoomTwo.tmx",   { 1600.0f, 3300.0f, 10.0f, 200.0f },    "maps/LevelDesign2.tmx",
+      { 8390.0f, 1313.78f }, 2, PORTAL_EVENT_NONE },
+    { "maps/LevelDesign2.tmx", { 7500.0f, 2900.0f, 80.0f, 100.0f },    "maps/Lv2Room3.tmx",
+      { 0.0f, 224.0f }, 2, PORTAL_EVENT_NONE },
+    { "maps/Lv2Room3.tmx",     { 1000.0f, 1200.0f, 100.0f, 100.0f },   "maps/LevelDesign2.tmx",
+      { 3820.0f, 1218.77f }, 2, PORTAL_EVENT_NONE },
+    { "maps/LevelDesign2.tmx", { 9100.0f, 2000.0f, 100.0f, 100.0f },   "maps/Lv2Room4.tmx",
+      { 0.0f, 224.0f }, 2, PORTAL_EVENT_NONE },
+    { "maps/Lv2Room4.tmx",     { 1000.0f, 1200.0f, 100.0f, 100.0f },   "maps/LevelDesign2.tmx",
+      { 3820.0f, 1218.77f }, 2, PORTAL_EVENT_NONE },
+};
+const int PORTAL_COUNT = sizeof(PORTALS) / sizeof(PORTALS[0]);
+
+/**
+ * @brief Computes how far a point is from a rectangle.
+ * @param point The point to measure from.
+ * @param rect The rectangle to measure to.
+ * @return Zero if the point is inside or on the edge of the rectangle, otherwise the distance to its nearest edge.
+ */
+inline float distanceToRect(Vector2 point, Rectangle rect) {
+    float dx = 0.0f;
+    float dy = 0.0f;
+    if (point.x < rect.x) dx = rect.x - point.x;
+    else if (point.x > rect.x + rect.width) dx = point.x - (rect.x + rect.width);
+    if (point.y < rect.y) dy = rect.y - point.y;
+    else if (point.y > rect.y + rect.height) dy = point.y - (rect.y + rect.height);
+    return sqrtf(dx * dx + dy * dy);
+}
+
+/**
+ * @class PortalIndex
+ * @brief Groups portals by source map and buckets their trigger areas into a uniform grid.
+ *
+ * A query only tests the portals whose trigger areas overlap the grid cell
+ * the point falls in, instead of every portal in the game.
+ */
+class PortalIndex {
+public:
+    /**
+     * @brief Builds the index over a table of portals, which must outlive it.
+     * @param portals The portal table.
+     * @param count Number of entries in the table.
+     * @param cellSize Width and height, in pixels, of a grid cell.
+     */
+    PortalIndex(const Portal* portals, int count, float cellSize = 512.0f) : cellSize(cellSize) {
+        for (int i = 0; i < count; i++) {
+            const Portal* portal = &portals[i];
+            MapPortals& mapPortals = maps[portal->fromMap];
+            mapPortals.portals.push_back(portal);
+
+            int minX = cellOf(portal->trigger.x);
+            int minY = cellOf(portal->trigger.y);
+            int maxX = cellOf(portal->trigger.x + portal->trigger.width);
+            int maxY = cellOf(portal->trigger.y + portal->trigger.height);
+            for (int y = minY; y <= maxY; y++) {
+                for (int x = minX; x <= maxX; x++) mapPortals.cells[cellKey(x, y)].push_back(portal);
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the portal whose trigger area contains a point.
+     * @param map Path of the map the point is on.
+     * @param point Position to test, normally the top-left corner of the samurai's rectangle.
+     * @return The first matching portal in table order, or NULL if there is none.
+     */
+    const Portal* query(const std::string& map, Vector2 point) const {
+        std::unordered_map<std::string, MapPortals>::const_iterator mapPortals = maps.find(map);
+        if (mapPortals == maps.end()) return NULL;
+
+        std::unordered_map<uint64_t, std::vector<const Portal*>>::const_iterator cell =
+            mapPortals->second.cells.find(cellKey(cellOf(point.x), cellOf(point.y)));
+        if (cell == mapPortals->second.cells.end()) return NULL;
+
+        for (const Portal* portal : cell->second) {
+            const Rectangle& trigger = portal->trigger;
+            if (point.x >= trigger.x && point.x <= trigger.x + trigger.width &&
+                point.y >= trigger.y && point.y <= trigger.y + trigger.height) {
+                return portal;
+            }
+        }
+        return NULL;
+    }
+
+    /**
+     * @brief Lists the portals leading out of a map.
+     * @param map Path of the source map.
+     * @return The map's portals in table order, empty if it has none.
+     */
+    const std::vector<const Portal*>& getPortalsFrom(const std::string& map) const {
+        static const std::vector<const Portal*> none;
+        std::unordered_map<std::string, MapPortals>::const_iterator mapPortals = maps.find(map);
+        return mapPortals != maps.end() ? mapPortals->second.portals : none;
+    }
+
+private:
+    /**
+     * @struct MapPortals
+     * @brief The portals leading out of one map.
+     */
+    struct MapPortals {
+        std::vector<const Portal*> portals; ///< All of them, in table order.
+        std::unordered_map<uint64_t, std::vector<const Portal*>> cells; ///< Those overlapping each grid cell.
+    };
+
+    std::unordered_map<std::string, MapPortals> maps; ///< Portals by source map path.
+    float cellSize;
+
+    int cellOf(float coordinate) const {
+        return (int)floorf(coordinate / cellSize);
+    }
+
+    static uint64_t cellKey(int x, int y) {
+        return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+    }
+};
+
+#endif // PORTALS_H
@@ -0,0 +1,238 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "raylib.h"
+#include <chrono>
+#include <cstdio>
+
+/**
+ * @file Profiler.h
+ * @brief Times the parts of a frame and shows where the frame time goes.
+ *
+ * PROFILE_SCOPE() times the rest of the enclosing block and adds it to the
+ * current frame's sample. The last FRAME_HISTORY samples are kept in a ring
+ * buffer for the overlay's stacked bar graph, and the last EVENT_HISTORY
+ * timed scopes for a Chrome trace (chrome://tracing or ui.perfetto.dev).
+ * Defining DISABLE_PROFILER before including this file compiles the scopes
+ * out. The profiler is meant for the main thread only.
+ */
+
+/**
+ * @enum ProfileScope
+ * @brief Parts of the frame that are timed.
+ */
+enum ProfileScope {
+    PROFILE_UPDATE_SAMURAI,  ///< Samurai input, movement and animation.
+    PROFILE_TILE_COLLISIONS, ///< Collisions between the samurai and the map.
+    PROFILE_PORTALS,         ///< Prefetching and portal checks.
+    PROFILE_BACKGROUND,      ///< Background layers.
+    PROFILE_RENDER_LEVEL,    ///< Map layers.
+    PROFILE_DEMON_AI,        ///< Demon update and drawing.
+    PROFILE_COMBAT,          ///< Resolving attacks against hurtboxes.
+    PROFILE_END_DRAWING,     ///< Submitting the frame and waiting for the swap.
+    PROFILE_SCOPE_COUNT
+};
+
+const char* const PROFILE_SCOPE_NAMES[PROFILE_SCOPE_COUNT] = {
+    "updateSamurai", "checkTileCollisions", "Portals", "Background", "renderLevel", "Demon AI", "Combat", "EndDrawing"
+};
+const Color PROFILE_SCOPE_COLORS[PROFILE_SCOPE_COUNT] = { GREEN, ORANGE, PURPLE, SKYBLUE, BLUE, RED, PINK, YELLOW };
+
+/**
+ * @class Profiler
+ * @brief Ring buffers of per-frame timings and of individual timed scopes.
+ */
+class Profiler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static const int FRAME_HISTORY = 240;   ///< Frames kept for the overlay.
+    static const int EVENT_HISTORY = 16384; ///< Timed scopes kept for the trace.
+
+    Profiler() : epoch(Clock::now()), frameStart(epoch) {}
+
+    /**
+     * @brief Closes the current frame's sample and starts the next one. Call once at the top of each frame.
+     */
+    void beginFrame() {
+        Clock::time_point now = Clock::now();
+        if (frameCount > 0) {
+            FrameSample& sample = frames[(frameCount - 1) % FRAME_HISTORY];
+            sample.frameMs = toMs(now - frameStart);
+            addEvent(PROFILE_SCOPE_COUNT, frameStart, now);
+        }
+
+        frameStart = now;
+        FrameSample& sample = frames[frameCount % FRAME_HISTORY];
+        for (int i = 0; i < PROFILE_SCOPE_COUNT; i++) sample.scopeMs[i] = 0.0f;
+        sample.frameMs = 0.0f;
+        frameCount++;
+    }
+
+    /**
+     * @brief Adds a timed scope to the current frame.
+     * @param scope Part of the frame that was timed.
+     * @param start When the scope was entered.
+     * @param end When the scope was left.
+     */
+    void record(ProfileScope scope, Clock::time_point start, Clock::time_point end) {
+        if (frameCount > 0) frames[(frameCount - 1) % FRAME_HISTORY].scopeMs[scope] += toMs(end - start);
+        addEvent(scope, start, end);
+    }
+
+    /**
+     * @brief Draws a stacked bar per recorded frame, newest on the right, with a legend of average times.
+     * @param x Left edge of the graph on the screen.
+     * @param y Top edge of the graph on the screen.
+     * @param width Width of the graph in pixels.
+     * @param height Height of the graph in pixels, which spans two 60 FPS frames.
+     */
+    void drawOverlay(int x, int y, int width, int height) const {
+        const float maxMs = 1000.0f / 30.0f;
+        DrawRectangle(x, y, width, height, Fade(BLACK, 0.7f));
+
+        // Only completed frames have a frame time, and the frame in progress takes up one slot
+        int count = frameCount - 1 < FRAME_HISTORY - 1 ? frameCount - 1 : FRAME_HISTORY - 1;
+        float barWidth = (float)width / FRAME_HISTORY;
+        float averageMs[PROFILE_SCOPE_COUNT] = { 0.0f };
+        float averageFrameMs = 0.0f;
+        for (int i = 0; i < count; i++) {
+            const FrameSample& sample = frames[(frameCount - 1 - count + i) % FRAME_HISTORY];
+            float barX = x + width - (count - i) * barWidth;
+            float barBottom = (float)(y + height);
+            for (int scope = 0; scope < PROFILE_SCOPE_COUNT; scope++) {
+                float barHeight = sample.scopeMs[scope] / maxMs * height;
+                if (barBottom - barHeight < y) barHeight = barBottom - y;
+                DrawRectangleRec(Rectangle{ barX, barBottom - barHeight, barWidth, barHeight },
+                                 PROFILE_SCOPE_COLORS[scope]);
+                barBottom -= barHeight;
+                averageMs[scope] += sample.scopeMs[scope] / count;
+            }
+
+            // Whatever the scopes don't cover is stacked on top in gray
+            float frameHeight = sample.frameMs / maxMs * height;
+            if (frameHeight > height) frameHeight = (float)height;
+            if (y + height - frameHeight < barBottom) {
+                DrawRectangleRec(Rectangle{ barX, y + height - frameHeight, barWidth,
+                                            barBottom - (y + height - frameHeight) }, DARKGRAY);
+            }
+            averageFrameMs += sample.frameMs / count;
+        }
+
+        int targetY = y + height - (int)(1000.0f / 60.0f / maxMs * height);
+        DrawLine(x, targetY, x + width, targetY, WHITE);
+        DrawText("16.6 ms", x + 4, targetY - 12, 10, WHITE);
+
+        int lineY = y + height + 4;
+        DrawText(TextFormat("Frame: %.2f ms (F4: save profile.json)", averageFrameMs), x, lineY, 20, WHITE);
+        for (int scope = 0; scope < PROFILE_SCOPE_COUNT; scope++) {
+            lineY += 22;
+            DrawRectangle(x, lineY + 2, 16, 16, PROFILE_SCOPE_COLORS[scope]);
+            DrawText(TextFormat("%s: %.2f ms", PROFILE_SCOPE_NAMES[scope], averageMs[scope]),
+                     x + 22, lineY, 20, WHITE);
+        }
+    }
+
+    /**
+     * @brief Writes the recorded scopes and frames as a Chrome trace.
+     * @param fileName Path of the JSON file to write.
+     * @return True if the file was written.
+     */
+    bool dumpChromeTrace(const char* fileName) const {
+        FILE* file = fopen(fileName, "w");
+        if (!file) {
+            TraceLog(LOG_WARNING, "Profiler: Could not open %s for writing", fileName);
+            return false;
+        }
+
+        int count = eventCount < EVENT_HISTORY ? eventCount : EVENT_HISTORY;
+        fprintf(file, "{\"traceEvents\":[\n");
+        for (int i = 0; i < count; i++) {
+            const Event& event = events[(eventCount - count + i) % EVENT_HISTORY];
+            const char* name = event.scope == PROFILE_SCOPE_COUNT ? "Frame" : PROFILE_SCOPE_NAMES[event.scope];
+            fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}%s\n", name,
+                    event.startUs, event.durationUs, event.scope == PROFILE_SCOPE_COUNT ? 0 : 1,
+                    i + 1 < count ? "," : "");
+        }
+        fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+        fclose(file);
+
+        TraceLog(LOG_INFO, "Profiler: Wrote %d events to %s", count, fileName);
+        return true;
+    }
+
+    bool isVisible = false; ///< Whether the overlay is drawn.
+
+private:
+    /**
+     * @struct FrameSample
+     * @brief Time spent in each scope during one frame.
+     */
+    struct FrameSample {
+        float scopeMs[PROFILE_SCOPE_COUNT]; ///< Total time in each scope, in milliseconds.
+        float frameMs;                      ///< Time from this frame's start to the next's.
+    };
+
+    /**
+     * @struct Event
+     * @brief One timed scope, or a whole frame when the scope is PROFILE_SCOPE_COUNT.
+     */
+    struct Event {
+        int scope;
+        double startUs;   ///< Microseconds since the profiler was created.
+        float durationUs;
+    };
+
+    Clock::time_point epoch;      ///< Time that trace timestamps count from.
+    Clock::time_point frameStart; ///< When the current frame started.
+    FrameSample frames[FRAME_HISTORY];
+    int frameCount = 0;
+    Event events[EVENT_HISTORY];
+    int eventCount = 0;
+
+    static float toMs(Clock::duration duration) {
+        return std::chrono::duration<float, std::milli>(duration).count();
+    }
+
+    void addEvent(int scope, Clock::time_point start, Clock::time_point end) {
+        Event& event = events[eventCount % EVENT_HISTORY];
+        event.scope = scope;
+        event.startUs = std::chrono::duration<double, std::micro>(start - epoch).count();
+        event.durationUs = std::chrono::duration<float, std::micro>(end - start).count();
+        eventCount++;
+    }
+};
+
+/**
+ * @class ScopedTimer
+ * @brief Times its own lifetime and records it in a profiler.
+ */
+class ScopedTimer {
+public:
+    ScopedTimer(Profiler& profiler, ProfileScope scope)
+        : profiler(profiler), scope(scope), start(Profiler::Clock::now()) {}
+
+    ~ScopedTimer() {
+        profiler.record(scope, start, Profiler::Clock::now());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Profiler& profiler;
+    ProfileScope scope;
+    Profiler::Clock::time_point start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#ifndef DISABLE_PROFILER
+/// Times the rest of the enclosing block as the given scope.
+#define PROFILE_SCOPE(profiler, scope) ScopedTimer PROFILE_CONCAT(profileScope, __LINE__)(profiler, scope)
+#else
+#define PROFILE_SCOPE(profiler, scope) ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -2,6 +2,11 @@
 
 #include "raylib.h"
 #include "CollisionSystem.h"
+#include "Log.h"
+#include "AssetManager.h"
+#include "AnimationTable.h"
+#include "AudioMixer.h"
+#include "Input.h"
 #include <vector>
 #include <cstdio>
 #include <thread>
@@ -42,14 +47,37 @@ struct Animation {
     AnimationType type; // Type of animation (loop or oneshot).
 };
 
+// Animations of each state, in state order. Each sheet is a single row of 128x128 frames.
+constexpr AnimationClip SAMURAI_CLIPS[] = {
+    {"assets/Samurai/Dead.png", 128, 128, 0, 3, 0.1f, false, -1, -1},     // DEAD_STATE
+    {"assets/Samurai/Attack_1.png", 128, 128, 0, 6, 0.1f, false, 2, 4},   // ATTACK_STATE - hits on frames 2 to 4
+    {"assets/Samurai/Hurt.png", 128, 128, 0, 2, 0.1f, false, -1, -1},     // HURT_STATE
+    {"assets/Samurai/Idle.png", 128, 128, 0, 6, 0.1f, true, -1, -1},      // IDLE_STATE
+    {"assets/Samurai/Jump.png", 128, 128, 0, 12, 0.1f, false, -1, -1},    // JUMP_STATE
+    {"assets/Samurai/Run.png", 128, 128, 0, 8, 0.1f, true, -1, -1},       // RUN_STATE
+    {"assets/Samurai/Shield.png", 128, 128, 0, 2, 0.1f, false, -1, -1}    // BLOCK_STATE
+};
+constexpr AnimationTable<BLOCK_STATE + 1> SAMURAI_ANIMATIONS(SAMURAI_CLIPS);
+
+// How the mixer limits each of the Samurai's sound effects.
+constexpr SoundSettings SAMURAI_ATTACK_SOUND = {SOUND_CATEGORY_COMBAT, 2, 0.05f};
+constexpr SoundSettings SAMURAI_BLOCK_SOUND = {SOUND_CATEGORY_COMBAT, 2, 0.1f};
+constexpr SoundSettings SAMURAI_JUMP_SOUND = {SOUND_CATEGORY_MOVEMENT, 2, 0.05f};
+constexpr SoundSettings SAMURAI_LAND_SOUND = {SOUND_CATEGORY_MOVEMENT, 1, 0.1f};
+constexpr SoundSettings SAMURAI_RUN_SOUND = {SOUND_CATEGORY_MOVEMENT, 1, 0.05f};
+constexpr SoundSettings SAMURAI_DASH_SOUND = {SOUND_CATEGORY_MOVEMENT, 1, 0.1f};
+constexpr SoundSettings SAMURAI_HURT_SOUND = {SOUND_CATEGORY_VOICE, 1, 0.1f};
+constexpr SoundSettings SAMURAI_DEAD_SOUND = {SOUND_CATEGORY_VOICE, 1, 0.5f};
+
 class Samurai {
 private:
     Rectangle rect; // Character's rectangle for position and size.
+    Rectangle previousRect; // Rectangle at the start of the current simulation step, for interpolated drawing.
     Vector2 velocity; // Velocity of the character for movement.
     Direction direction; // Current facing direction of the character.
     CurrentState state; // Current state of the character (e.g., idle, attack, etc.).
     std::vector<Animation> animations; // List of animations for different states.
-    std::vector<Texture2D> sprites; // List of textures for each state.
+    AssetHandle atlasHandle = INVALID_ASSET_HANDLE; // Atlas with every state's frames, one animation per state.
     float groundLevel; // The Y-coordinate of the ground level.
     float block_damage_reduction = 0.5; //half damage reduction when blocking.
 
@@ -66,8 +94,8 @@ private:
     float dashTimer = 0.0f; // Timer to track current dash duration
     float dashCooldown = 0.5f; // Cooldown period between dashes in seconds
     float dashCooldownTimer = 0.0f; // Timer to track cooldown
-    float lastAKeyPressTime = 0.0f; // Time when A key was last pressed
-    float lastDKeyPressTime = 0.0f; // Time when D key was last pressed
+    float lastAKeyPressTime = -1.0f; // Simulation time when A key was last pressed
+    float lastDKeyPressTime = -1.0f; // Simulation time when D key was last pressed
     float doubleTapTimeThreshold = 0.3f; // Maximum time between taps to count as double tap
     bool canDash = true; // Flag to determine if dash is available
     float dashSoundVolume = 0.8f; // Volume for dash sound (0.0 to 1.0)
@@ -80,19 +108,38 @@ private:
     float invincibilityTimer = 0.0f; // Timer to track invincibility duration
     const float invincibilityDuration = 1.5f; // 1.5 seconds of invincibility after taking damage
 
-    // Define Sound Variables.
-    Sound attackSound;
-    Sound jumpSound;
-    Sound hurtSound;
-    Sound runSound;
-    Sound deadSound;
-    Sound landSound;
-    Sound dashSound;
-    Sound blockSound;
+    // Define Sound Variables. Sounds play through the audio mixer.
+    AssetHandle attackSound = INVALID_ASSET_HANDLE;
+    AssetHandle jumpSound = INVALID_ASSET_HANDLE;
+    AssetHandle hurtSound = INVALID_ASSET_HANDLE;
+    AssetHandle runSound = INVALID_ASSET_HANDLE;
+    AssetHandle deadSound = INVALID_ASSET_HANDLE;
+    AssetHandle landSound = INVALID_ASSET_HANDLE;
+    AssetHandle dashSound = INVALID_ASSET_HANDLE;
+    AssetHandle blockSound = INVALID_ASSET_HANDLE;
+    std::vector<AssetHandle> assetHandles; // References to the atlas and sounds above, released on destruction
 
     bool isRunning = false;
     bool startsAttacking = false;
 
+    // Key presses seen since the last simulation step. A frame can take no steps or several, so presses are
+    // collected once per frame by pollInput() and each is acted on by exactly one step.
+    bool jumpPressed = false;
+    bool leftPressed = false;
+    bool rightPressed = false;
+    bool attackPressed = false;
+    bool healPressed = false;
+    bool damagePressed = false;
+
+    // Keys held down in the latest frame
+    bool leftHeld = false;
+    bool rightHeld = false;
+    bool blockHeld = false;
+
+    // Seconds of simulation this samurai has been through, which timing such as the double tap dash and the attack
+    // cooldown is measured in so that replays play out the same
+    double simulationTime = 0.0;
+
     // Collision boxes for different purposes
     std::vector<CollisionBox> collisionBoxes;
 
@@ -114,7 +161,7 @@ private:
     // Helper method to update the animation frame.
     void updateAnimation(float deltaTime) {
         // Safety check for valid state
-        if (state < 0 || state >= sprites.size()) {
+        if (state < 0 || state >= animations.size()) {
             state = IDLE_STATE;
         }
         
@@ -157,47 +204,10 @@ private:
         }
     }
 
-    // Helper method to get the current animation frame rectangle.
-    Rectangle getAnimationFrame() const {
-        // Safety check for valid state
-        if (state < 0 || state >= sprites.size() || state >= animations.size()) {
-            return Rectangle{0, 0, 128, 128}; // Return a default frame
-        }
-        
-        // Get the sprite dimensions
-        int spriteWidth = sprites[state].width;
-        
-        // Safety check for valid sprite
-        if (spriteWidth <= 0) {
-            return Rectangle{0, 0, 128, 128}; // Return a default frame
-        }
-        
-        // Calculate the number of frames in the sprite sheet
-        int framesPerRow = spriteWidth / 128;
-        
-        // Safety check for valid frames calculation
-        if (framesPerRow <= 0) {
-            return Rectangle{0, 0, 128, 128}; // Return a default frame
-        }
-        
-        // Get the current frame from the animation
-        int currentFrame = animations[state].currentFrame;
-        
-        // Safety check for valid frame
-        if (currentFrame < 0) {
-            currentFrame = 0; // Reset to first frame
-        }
-        
-        // Ensure current frame doesn't exceed the last frame
-        if (currentFrame > animations[state].lastFrame) {
-            currentFrame = animations[state].lastFrame;
-        }
-        
-        // Calculate the position of the frame in the sprite sheet
-        int frameX = (currentFrame % framesPerRow) * 128;
-        int frameY = (currentFrame / framesPerRow) * 128;
-        
-        return Rectangle{(float)frameX, (float)frameY, 128, 128};
+    // Helper method to get the current animation frame from an atlas packed from SAMURAI_ANIMATIONS.
+    // updateAnimation() keeps the state and frame in range, so this is a single lookup.
+    const AtlasFrame& getAnimationFrame(const Atlas& atlas) const {
+        return atlas.frames[SAMURAI_ANIMATIONS.getFrameIndex(state, animations[state].currentFrame)];
     }
 
     // Helper method to handle movement input.
@@ -236,7 +246,7 @@ private:
                 wasInAir = false;
                 canDoubleJump = false;
                 hasDoubleJumped = false;
-                PlaySound(landSound);
+                playSound(landSound, SAMURAI_LAND_SOUND);
             }
         }
         
@@ -250,21 +260,19 @@ private:
         }
 
         if (wasInAir || isDashing) {
-            StopSound(runSound);
+            getAudioMixer().stop(runSound);
         }
         */
         
         // Check for jump input.
         
-        if (IsKeyPressed(KEY_W) && state != ATTACK_STATE) {
-            StopSound(runSound);
+        if (jumpPressed && state != ATTACK_STATE) {
+            getAudioMixer().stop(runSound);
 
             if (!wasInAir) {
                 // First jump
                 velocity.y = -12.0f;
-                if (jumpSound.frameCount > 0) {
-                    PlaySound(jumpSound);
-                }
+                playSound(jumpSound, SAMURAI_JUMP_SOUND);
                 wasInAir = true;
                 canDoubleJump = true;
                 hasDoubleJumped = false;
@@ -276,9 +284,7 @@ private:
             } else if (canDoubleJump && !hasDoubleJumped) {
                 // Double jump with slightly reduced height
                 velocity.y = -10.0f;  // Slightly less than first jump
-                if (jumpSound.frameCount > 0) {
-                    PlaySound(jumpSound);
-                }
+                playSound(jumpSound, SAMURAI_JUMP_SOUND);
                 hasDoubleJumped = true;
                 canDoubleJump = false;  // Prevent further jumps
                 
@@ -303,10 +309,10 @@ private:
         
         
         // Current time for double tap detection
-        float currentTime = GetTime();
+        float currentTime = simulationTime;
         
         // Handle left/right movement with double tap dash
-        if ((IsKeyPressed(KEY_A) || IsKeyPressed(KEY_LEFT)) && state != ATTACK_STATE) {
+        if (leftPressed && state != ATTACK_STATE) {
             state = RUN_STATE;
 
             if (canDash && (currentTime - lastAKeyPressTime) <= doubleTapTimeThreshold) {
@@ -316,12 +322,12 @@ private:
                 dashCooldownTimer = dashCooldown;
                 direction = LEFT;
                 playDashSound();
-                StopSound(runSound);
+                getAudioMixer().stop(runSound);
             }
             lastAKeyPressTime = currentTime;
         }        
         
-        if ((IsKeyPressed(KEY_D) || IsKeyPressed(KEY_RIGHT)) && state != ATTACK_STATE) {
+        if (rightPressed && state != ATTACK_STATE) {
             state = RUN_STATE;
 
             if (canDash && (currentTime - lastDKeyPressTime) <= doubleTapTimeThreshold) {
@@ -331,15 +337,15 @@ private:
                 dashCooldownTimer = dashCooldown;
                 direction = RIGHT;
                 playDashSound();
-                StopSound(runSound);
+                getAudioMixer().stop(runSound);
             }
             lastDKeyPressTime = currentTime;
         }     
         
         // Handle movement based on key press and dash state
-        if ((IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) && !isDashing && state != ATTACK_STATE) {
+        if (leftHeld && !isDashing && state != ATTACK_STATE) {
             if (!isRunning) {
-                PlaySound(runSound);
+                playSound(runSound, SAMURAI_RUN_SOUND);
                 isRunning = true;
             }
             velocity.x = -5.0f;  // Move left normally
@@ -351,9 +357,9 @@ private:
             if (state != JUMP_STATE && state != HURT_STATE && state != DEAD_STATE) {
                 state = RUN_STATE;
             }
-        } else if ((IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) && !isDashing && state != ATTACK_STATE) {
+        } else if (rightHeld && !isDashing && state != ATTACK_STATE) {
             if (!isRunning) {
-                PlaySound(runSound);
+                playSound(runSound, SAMURAI_RUN_SOUND);
                 isRunning = true;
             }
             velocity.x = 5.0f;  // Move right normally
@@ -369,7 +375,7 @@ private:
             velocity.x = 0;
             if (isRunning) {
                 state = IDLE_STATE;
-                StopSound(runSound);
+                getAudioMixer().stop(runSound);
                 isRunning = false;
             }
         }
@@ -380,45 +386,40 @@ private:
         }
 
         // Check for block input
-        if (IsKeyDown(KEY_B) && !blocking && state != ATTACK_STATE && state != HURT_STATE && state != DEAD_STATE) {
+        if (blockHeld && !blocking && state != ATTACK_STATE && state != HURT_STATE && state != DEAD_STATE) {
             velocity.x = 0;
             blocking = true;
-            PlaySound(blockSound);
-            StopSound(runSound);
+            getAudioMixer().stop(runSound);
             state = BLOCK_STATE;
-            if (blockSound.frameCount > 0) {
-                PlaySound(blockSound);
+            if (getAssetManager().getSound(blockSound).frameCount > 0) {
+                playSound(blockSound, SAMURAI_BLOCK_SOUND);
                 blocking = false; //reset block flag.
             } else {
-                printf("Block sound not loaded!\n"); // Debug output
+                GAME_LOG(LOG_LEVEL_WARNING, LOG_CATEGORY_PLAYER, "Block sound not loaded!");
             }
-            printf("Blocking activated!\n"); // Debug output
+            GAME_LOG(LOG_LEVEL_DEBUG, LOG_CATEGORY_PLAYER, "Blocking activated!");
         }
         
         // Check for attack input.
-        if (IsKeyPressed(KEY_SPACE) && state != ATTACK_STATE && state != HURT_STATE && state != DEAD_STATE && !isBlocking() && canAttack()) {
+        if (attackPressed && state != ATTACK_STATE && state != HURT_STATE && state != DEAD_STATE && !isBlocking() && canAttack()) {
             startsAttacking = true;
             velocity.x = 0;
             state = ATTACK_STATE;  // Set to attack state.
             animations[state].currentFrame = 0;  // Reset animation frame.
-            if (attackSound.frameCount > 0) {
-                PlaySound(attackSound);
-                StopSound(runSound);
-            }
-            lastAttackTime = Clock::now();
+            playSound(attackSound, SAMURAI_ATTACK_SOUND);
+            getAudioMixer().stop(runSound);
+            lastAttackTime = simulationTime;
         }
 
         // Apply velocity to position.
         applyVelocity();
     }
 
-    using Clock = std::chrono::steady_clock;
-    std::chrono::time_point<Clock> lastAttackTime = Clock::now();
+    double lastAttackTime = 0.0;
     const float attackCooldownSeconds = 2.0f;  // Change to however many seconds you want
 
     bool canAttack() {
-        auto now = Clock::now();
-        float secondsSinceLastAttack = std::chrono::duration<float>(now - lastAttackTime).count();
+        float secondsSinceLastAttack = (float)(simulationTime - lastAttackTime);
         return secondsSinceLastAttack >= attackCooldownSeconds;
     }
 
@@ -445,14 +446,14 @@ private:
 
     // Helper method to check for healing input.
     void checkForHealing() {
-        if (IsKeyPressed(KEY_H)) {
+        if (healPressed) {
             heal(10);  // Heal by 10 points.
         }
     }
 
     // Helper method to check for damage input (for testing).
     void checkForDamage() {
-        if (IsKeyPressed(KEY_K)) {
+        if (damagePressed) {
             takeDamage(10);  // Take 10 damage.
         }
     }
@@ -492,7 +493,7 @@ private:
                 float attackSize = 32.0f * SPRITE_SCALE;
                 
                 collisionBoxes[1].rect = {rect.x + attackOffsetX, rect.y + attackOffsetY, attackSize, attackSize};
-                collisionBoxes[1].active = (state == ATTACK_STATE && animations[state].currentFrame >= 2 && animations[state].currentFrame <= 4);
+                collisionBoxes[1].active = SAMURAI_CLIPS[state].isHitboxActive(animations[state].currentFrame);
                 
                 // Update hurtbox collision box
                 if (collisionBoxes.size() > 2) {
@@ -510,11 +511,12 @@ private:
 
     // Helper function to play the dash sound with proper volume
     void playDashSound() {
-        if (dashSound.frameCount > 0) {
-            // Play the sound (volume already set through setSoundVolumes)
-            PlaySound(dashSound);
-            
-        }
+        playSound(dashSound, SAMURAI_DASH_SOUND);
+    }
+
+    // Helper function to play one of the sound effects through the mixer at the sound effect volume
+    void playSound(AssetHandle sound, const SoundSettings& settings) {
+        getAudioMixer().play(sound, settings, dashSoundVolume);
     }
 
     // Helper function to set volume for all sound effects
@@ -523,30 +525,21 @@ private:
         if (volume < 0.0f) volume = 0.0f;
         if (volume > 1.0f) volume = 1.0f;
         
-        // Store the dash sound volume for future reference
+        // Store the volume, which every sound effect is played at from now on
         dashSoundVolume = volume;
-        
-        // Set volume for all sound effects
-        if (attackSound.frameCount > 0) SetSoundVolume(attackSound, volume);
-        if (jumpSound.frameCount > 0) SetSoundVolume(jumpSound, volume);
-        if (hurtSound.frameCount > 0) SetSoundVolume(hurtSound, volume);
-        if (runSound.frameCount > 0) SetSoundVolume(runSound, volume);
-        if (deadSound.frameCount > 0) SetSoundVolume(deadSound, volume);
-        if (landSound.frameCount > 0) SetSoundVolume(landSound, volume);
-        if (dashSound.frameCount > 0) SetSoundVolume(dashSound, volume);
     }
 
-    void loadTextures() {
-        sprites.resize(7);
+    // Gets a sound through the asset manager, remembering the reference to release.
+    AssetHandle acquireSound(const char* path) {
+        AssetHandle handle = getAssetManager().acquireSound(path);
+        assetHandles.push_back(handle);
+        return handle;
+    }
 
-        // Load textures for different states (idle, attack, etc.).
-        sprites[DEAD_STATE] = LoadTexture("assets/Samurai/Dead.png");
-        sprites[ATTACK_STATE] = LoadTexture("assets/Samurai/Attack_1.png");
-        sprites[HURT_STATE] = LoadTexture("assets/Samurai/Hurt.png");
-        sprites[IDLE_STATE] = LoadTexture("assets/Samurai/Idle.png");
-        sprites[JUMP_STATE] = LoadTexture("assets/Samurai/Jump.png");
-        sprites[RUN_STATE] = LoadTexture("assets/Samurai/Run.png");
-        sprites[BLOCK_STATE] = LoadTexture("assets/Samurai/Shield.png");
+    void loadTextures() {
+        // Pack the sheets for the different states (idle, attack, etc.) into one atlas, in state order.
+        atlasHandle = getAssetManager().acquireAtlas("samurai", SAMURAI_ANIMATIONS.getSheets());
+        assetHandles.push_back(atlasHandle);
     }
 
 public:
@@ -576,6 +569,7 @@ public:
     // Constructor initializing the Samurai's properties and animations
     Samurai(float x, float y, float groundLevel) {
         rect = (Rectangle){x, y, 64.0f * SPRITE_SCALE, 64.0f * SPRITE_SCALE}; // Scale the sprite size
+        previousRect = rect;
         velocity = (Vector2){0.0f, 0.0f}; // Initialize velocity.
         direction = RIGHT; // Default facing direction.
         state = IDLE_STATE; // Start in idle state.
@@ -587,26 +581,21 @@ public:
         // Load textures for each state.
         loadTextures();
 
-        // Initialize animations for each state.
-        animations = {
-            {0, 2, 0, 0, 0.1f, 0.1f, ONESHOT},    // DEAD_STATE - Changed to use all 3 frames (0, 1, 2)
-            {0, 5, 0, 0, 0.1f, 0.1f, ONESHOT},  // ATTACK_STATE
-            {0, 1, 0, 0, 0.1f, 0.1f, ONESHOT},  // HURT_STATE
-            {0, 5, 0, 0, 0.1f, 0.1f, LOOP},     // IDLE_STATE
-            {0, 11, 0, 0, 0.1f, 0.1f, ONESHOT}, // JUMP_STATE - 12 frames (0-11) based on 1536/128 = 12
-            {0, 7, 0, 0, 0.1f, 0.1f, LOOP},     // RUN_STATE
-            {0, 1, 0, 0, 0.1f, 0.1f, ONESHOT}      // BLOCK_STATE
-        };
+        // Initialize animations for each state from the table.
+        for (const AnimationClip& clip : SAMURAI_CLIPS) {
+            animations.push_back({0, clip.frameCount - 1, 0, 0, clip.frameTime, clip.frameTime,
+                                  clip.isLooping ? LOOP : ONESHOT});
+        }
 
         // Load sound effects with error checking
-        attackSound = LoadSound("sounds/samurai/sword-sound-2-36274.wav");
-        jumpSound = LoadSound("sounds/samurai/female-jump.wav");
-        hurtSound = LoadSound("sounds/samurai/female-hurt-2-94301.wav");
-        runSound = LoadSound("sounds/samurai/running-on-concrete-268478.wav");
-        deadSound = LoadSound("sounds/samurai/female-death.wav");
-        landSound = LoadSound("sounds/samurai/land2-43790.wav");
-        dashSound = LoadSound("sounds/samurai/whoosh (phaser).wav");
-        blockSound = LoadSound("sounds/samurai/block-sound.mp3");
+        attackSound = acquireSound("sounds/samurai/sword-sound-2-36274.wav");
+        jumpSound = acquireSound("sounds/samurai/female-jump.wav");
+        hurtSound = acquireSound("sounds/samurai/female-hurt-2-94301.wav");
+        runSound = acquireSound("sounds/samurai/running-on-concrete-268478.wav");
+        deadSound = acquireSound("sounds/samurai/female-death.wav");
+        landSound = acquireSound("sounds/samurai/land2-43790.wav");
+        dashSound = acquireSound("sounds/samurai/whoosh (phaser).wav");
+        blockSound = acquireSound("sounds/samurai/block-sound.mp3");
 
         // Initialize collision boxes with scaled dimensions
         float bodyOffsetX = 16.0f * SPRITE_SCALE;
@@ -638,41 +627,26 @@ public:
         
         // Initialize block variables
         blocking = false;
-        SetSoundVolume(blockSound, dashSoundVolume);
     }
 
     // Destructor to clean up resources
     ~Samurai() {
-        for (auto& sprite : sprites) {
-            UnloadTexture(sprite); // Unload textures from memory when done.
+        // Textures and sounds are unloaded once nothing else uses them
+        for (AssetHandle handle : assetHandles) {
+            getAssetManager().release(handle);
         }
-        
-        // Unload sounds - make sure they're valid before unloading
-        if (attackSound.frameCount > 0) UnloadSound(attackSound);
-        if (jumpSound.frameCount > 0) UnloadSound(jumpSound);
-        if (hurtSound.frameCount > 0) UnloadSound(hurtSound);
-        if (runSound.frameCount > 0) UnloadSound(runSound);
-        if (deadSound.frameCount > 0) UnloadSound(deadSound);
-        if (landSound.frameCount > 0) UnloadSound(landSound);
-        if (dashSound.frameCount > 0) UnloadSound(dashSound);
     }
 
-    // Draw the character.
-    void draw() const {
-        if (sprites.size() <= state) {
+    // Draw the character, interpolated between the last two simulation steps by alpha (0 to 1).
+    void draw(float alpha = 1.0f) const {
+        const Atlas* atlas = getAssetManager().getAtlas(atlasHandle);
+        if (atlas == NULL || atlas->frames.size() != (size_t)SAMURAI_ANIMATIONS.frameCount) {
             return; // Safety check
         }
-        
-        // Get the frame width for rendering
-        float frameWidth = sprites[state].width / (animations[state].lastFrame + 1);
-        
-        // Calculate source rectangle for the current frame
-        Rectangle source = {
-            animations[state].currentFrame * frameWidth,
-            0.0f,
-            direction == RIGHT ? frameWidth : -frameWidth,
-            (float)sprites[state].height
-        };
+        const AtlasFrame& frame = getAnimationFrame(*atlas);
+
+        Rectangle rect = getInterpolatedRect(alpha); // Where the character is drawn, between two steps
+        bool isFlipped = direction != RIGHT;
         
         // Calculate destination rectangle for rendering
         Rectangle dest = {
@@ -698,7 +672,7 @@ public:
                 float alpha = 0.7f - (i * 0.2f);
                 Color trailTint = {255, 255, 255, (unsigned char)(alpha * 255)};
                 
-                DrawTexturePro(sprites[state], source, trailDest, (Vector2){0, 0}, 0.0f, trailTint);
+                drawAtlasFrame(atlas->texture, frame, trailDest, isFlipped, trailTint);
             }
         }
         
@@ -713,7 +687,7 @@ public:
         }
         
         // Draw the sprite
-        DrawTexturePro(sprites[state], source, dest, (Vector2){0, 0}, 0.0f, tint);
+        drawAtlasFrame(atlas->texture, frame, dest, isFlipped, tint);
         
         // Draw collision boxes for debugging
         if (showCollisionBoxes) {
@@ -754,10 +728,24 @@ public:
         );
     }
 
-    // Update the Samurai's state and position
-    void updateSamurai() {
-        float deltaTime = GetFrameTime();
-        
+    // Collect this frame's key presses and held keys for the next simulation step. Call once per rendered frame.
+    void pollInput(const InputSystem& input) {
+        jumpPressed |= input.isKeyPressed(KEY_W);
+        leftPressed |= input.isKeyPressed(KEY_A) || input.isKeyPressed(KEY_LEFT);
+        rightPressed |= input.isKeyPressed(KEY_D) || input.isKeyPressed(KEY_RIGHT);
+        attackPressed |= input.isKeyPressed(KEY_SPACE);
+        healPressed |= input.isKeyPressed(KEY_H);
+        damagePressed |= input.isKeyPressed(KEY_K);
+
+        leftHeld = input.isKeyDown(KEY_A) || input.isKeyDown(KEY_LEFT);
+        rightHeld = input.isKeyDown(KEY_D) || input.isKeyDown(KEY_RIGHT);
+        blockHeld = input.isKeyDown(KEY_B);
+    }
+
+    // Advance the Samurai's state and position by one simulation step of deltaTime seconds
+    void updateSamurai(float deltaTime) {
+        simulationTime += deltaTime;
+
         // Always update animation regardless of whether the samurai is dead or alive
         updateAnimation(deltaTime);
         
@@ -782,6 +770,21 @@ public:
         // Always check for healing and damage
         checkForHealing();
         checkForDamage();
+
+        // This step has acted on the key presses
+        jumpPressed = leftPressed = rightPressed = attackPressed = healPressed = damagePressed = false;
+    }
+
+    // Remember the current rectangle as the one drawing interpolates from. Call at the start of each simulation
+    // step, and after teleporting so the jump isn't drawn as a slide.
+    void storePreviousRect() {
+        previousRect = rect;
+    }
+
+    // Get the rectangle between the previous and current simulation steps, alpha being 0 for the previous one
+    Rectangle getInterpolatedRect(float alpha) const {
+        return Rectangle{ previousRect.x + (rect.x - previousRect.x) * alpha,
+                          previousRect.y + (rect.y - previousRect.y) * alpha, rect.width, rect.height };
     }
 
     // Get the Samurai's rectangle for collision detection
@@ -794,6 +797,11 @@ public:
         return currentHealth;
     }
 
+    // Get all of the Samurai's collision boxes
+    const std::vector<CollisionBox>& getCollisionBoxes() const {
+        return collisionBoxes;
+    }
+
     // Get a collision box of a specific type
     CollisionBox* getCollisionBox(CollisionBoxType type) {
         for (auto& box : collisionBoxes) {
@@ -814,7 +822,7 @@ public:
             if (state == BLOCK_STATE) {
                 // 50% chance to completely block damage
                 if (GetRandomValue(0, 1) == 0) {
-                    PlaySound(blockSound);
+                    playSound(blockSound, SAMURAI_BLOCK_SOUND);
                     //no damage.
                     damage = 0;
                     return;
@@ -830,17 +838,13 @@ public:
                 isDead = true;
                 animations[state].currentFrame = 0;  // Reset death animation to start from the beginning
                 animations[state].timer = 0;  // Reset timer for smooth animation
-                if (deadSound.frameCount > 0) {
-                    PlaySound(deadSound);
-                    StopSound(runSound);
-                }
+                playSound(deadSound, SAMURAI_DEAD_SOUND);
+                getAudioMixer().stop(runSound);
             } else {
                 state = HURT_STATE;
                 animations[state].currentFrame = 0;  // Reset hurt animation.
-                if (hurtSound.frameCount > 0) {
-                    PlaySound(hurtSound);
-                    StopSound(runSound);
-                }
+                playSound(hurtSound, SAMURAI_HURT_SOUND);
+                getAudioMixer().stop(runSound);
                 
                 // Activate invincibility frames
                 isInvincible = true;
@@ -851,22 +855,22 @@ public:
 
     // Pauses all character-related sounds
     void pauseSounds() { 
-        PauseSound(runSound);
-        PauseSound(attackSound);
-        PauseSound(hurtSound);
-        PauseSound(deadSound);
-        PauseSound(dashSound);
-        PauseSound(jumpSound);
+        getAudioMixer().pause(runSound);
+        getAudioMixer().pause(attackSound);
+        getAudioMixer().pause(hurtSound);
+        getAudioMixer().pause(deadSound);
+        getAudioMixer().pause(dashSound);
+        getAudioMixer().pause(jumpSound);
     }
 
     // Resumes all character-related sounds
     void resumeSound() { 
-        ResumeSound(runSound);
-        ResumeSound(attackSound);
-        ResumeSound(hurtSound);
-        ResumeSound(deadSound);
-        ResumeSound(dashSound);
-        ResumeSound(jumpSound);
+        getAudioMixer().resume(runSound);
+        getAudioMixer().resume(attackSound);
+        getAudioMixer().resume(hurtSound);
+        getAudioMixer().resume(deadSound);
+        getAudioMixer().resume(dashSound);
+        getAudioMixer().resume(jumpSound);
     }
 
     // Sets the player's position and size (hitbox)
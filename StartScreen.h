@@ -2,6 +2,7 @@
 #define START_SCREEN_H
 
 #include "raylib.h"
+#include "Input.h"
 
 /**
  * @class StartScreen
@@ -32,14 +33,16 @@ public:
      *
      * Detects mouse hover and clicks, changing button colors accordingly.
      * Sets game state variables when buttons are clicked.
+     *
+     * @param input This frame's input.
      */
-    void Update() {
-        Vector2 mouse = GetMousePosition();
+    void Update(const InputSystem& input) {
+        Vector2 mouse = input.getMousePosition();
 
         // Play button interaction
         if (CheckCollisionPointRec(mouse, playButton)) {
             playButtonColor = (Color){ 255, 223, 100, 255 }; // Faint gold for hover
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            if (input.isMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                 startGame = true;
             }
         } else {
@@ -49,7 +52,7 @@ public:
         // Exit button interaction
         if (CheckCollisionPointRec(mouse, exitButton)) {
             exitButtonColor = (Color){ 255, 0, 0, 255 }; // Blood red for hover
-            if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+            if (input.isMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
                 exitGame = true;
             }
         } else {
@@ -0,0 +1,97 @@
+/**
+ * @file csv_decode.cpp
+ * @brief Measures how fast raytmx decodes the CSV tile data of every map in a directory.
+ *
+ * The decoder is picked when raytmx is compiled, so build the benchmark once
+ * per decoder and run each build from the repository root:
+ *
+ *     g++ -std=c++17 -O2 -mavx2 -I. bench/csv_decode.cpp -lraylib -o csv_decode_avx2
+ *     g++ -std=c++17 -O2 -I. bench/csv_decode.cpp -lraylib -o csv_decode_sse2
+ *     g++ -std=c++17 -O2 -DRAYTMX_NO_SIMD -I. bench/csv_decode.cpp -lraylib -o csv_decode_scalar
+ *
+ * Usage: csv_decode [directory] [iterations]. Every build must report the
+ * same checksum, since the decoders must produce the same GIDs.
+ */
+
+#define RAYTMX_IMPLEMENTATION
+#include "raytmx.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined RAYTMX_CSV_AVX2
+static const char* DECODER_NAME = "AVX2";
+#elif defined RAYTMX_CSV_SSE2
+static const char* DECODER_NAME = "SSE2";
+#else
+static const char* DECODER_NAME = "scalar";
+#endif
+
+/**
+ * @brief Finds the contents of every <data encoding="csv"> element of a TMX document.
+ */
+static std::vector<std::string> extractCsvData(const char* text) {
+    static const char* OPENING = "encoding=\"csv\">";
+    std::vector<std::string> blocks;
+    const char* start = strstr(text, OPENING);
+    while (start != NULL) {
+        start += strlen(OPENING);
+        const char* end = strstr(start, "</data>");
+        if (end == NULL) break;
+        blocks.push_back(std::string(start, end - start));
+        start = strstr(end, OPENING);
+    }
+    return blocks;
+}
+
+int main(int argc, char** argv) {
+    const char* directory = argc > 1 ? argv[1] : "maps";
+    int iterations = argc > 2 ? atoi(argv[2]) : 50;
+    if (iterations < 1) iterations = 1;
+    SetTraceLogLevel(LOG_WARNING);
+
+    RaytmxState state;
+    memset(&state, 0, sizeof(RaytmxState));
+
+    FilePathList files = LoadDirectoryFilesEx(directory, ".tmx", false);
+    double totalBytes = 0.0, totalSeconds = 0.0;
+    uint64_t checksum = 0;
+    printf("CSV decoder: %s, %d iterations\n", DECODER_NAME, iterations);
+    for (unsigned int i = 0; i < files.count; i++) {
+        char* text = LoadFileText(files.paths[i]);
+        if (text == NULL) continue;
+        std::vector<std::string> blocks = extractCsvData(text);
+        UnloadFileText(text);
+
+        double bytes = 0.0, seconds = 0.0;
+        uint32_t gids = 0;
+        for (const std::string& csv : blocks) {
+            // Every value but the last takes at least two characters, so this never grows during the timed loop
+            ReserveTileLayerTiles(&state, (uint32_t)(csv.size() / 2 + 1));
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (int k = 0; k < iterations; k++) {
+                state.layerTilesLength = 0;
+                DecodeCsvTileLayerTiles(&state, csv.c_str(), csv.size());
+            }
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            bytes += (double)csv.size() * iterations;
+            gids += state.layerTilesLength;
+            for (uint32_t j = 0; j < state.layerTilesLength; j++) checksum = checksum * 31 + state.layerTiles[j];
+        }
+        if (blocks.empty()) continue;
+
+        printf("%-32s %3d layers %9u GIDs %8.2f MB %9.1f MB/s\n", GetFileName(files.paths[i]), (int)blocks.size(),
+               gids, bytes / iterations / 1e6, seconds > 0.0 ? bytes / seconds / 1e6 : 0.0);
+        totalBytes += bytes;
+        totalSeconds += seconds;
+    }
+    printf("Total %8.2f MB decoded at %.1f MB/s, checksum %016llx\n", totalBytes / iterations / 1e6,
+           totalSeconds > 0.0 ? totalBytes / totalSeconds / 1e6 : 0.0, (unsigned long long)checksum);
+
+    if (state.layerTiles != NULL) MemFree(state.layerTiles);
+    UnloadDirectoryFiles(files);
+    return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * @file tile_iterate.cpp
+ * @brief Compares iterating a tile layer with IterateTileLayer() and NextTileLayerSpan() against the cursor they
+ *        replaced.
+ *
+ * The old iterator, copied below as it was, kept its cursor in function-level
+ * statics and returned one tile per call. The current one returns an iterator
+ * owned by the caller and hands out a row of tiles per call, walking only the
+ * runs of non-empty tiles when the layer has them indexed. Each is timed over
+ * the whole layer and over an area the size of the game's view. Build and run
+ * from the repository root:
+ *
+ *     g++ -std=c++17 -O2 -I. bench/tile_iterate.cpp -lraylib -o tile_iterate
+ *
+ * Usage: tile_iterate [map]. Every iterator must report the same number of
+ * non-empty tiles and the same checksum for an area.
+ */
+
+#define RAYTMX_IMPLEMENTATION
+#include "raytmx.h"
+#include <chrono>
+#include <cstdio>
+
+/**
+ * @brief IterateTileLayer() before its cursor moved into a caller-owned iterator, minus the unused tile output.
+ */
+static bool legacyIterateTileLayer(const TmxMap* map, const TmxTileLayer* layer, Rectangle screenRect,
+                                   uint32_t* rawGid, Rectangle* tileRect) {
+    static const TmxTileLayer* currentLayer = NULL;
+    static int fromX = 0, fromY = 0, toX = 0, toY = 0, currentX = 0, currentY = 0;
+
+    if (map == NULL || map->width == 0 || map->height == 0 || map->tileWidth == 0 || map->tileHeight == 0 ||
+        layer == NULL || layer->tilesLength == 0)
+        return false;
+
+    if (currentLayer != layer) {
+        currentLayer = layer;
+        switch (map->renderOrder) {
+            case RENDER_ORDER_RIGHT_DOWN:
+                fromX = (int)screenRect.x / (int)map->tileWidth;
+                fromY = (int)screenRect.y / (int)map->tileHeight;
+                toX = (int)(screenRect.x + screenRect.width) / (int)map->tileWidth;
+                toY = (int)(screenRect.y + screenRect.height) / (int)map->tileHeight;
+                break;
+            case RENDER_ORDER_RIGHT_UP:
+                fromX = (int)screenRect.x / (int)map->tileWidth;
+                fromY = (int)(screenRect.y + screenRect.height) / (int)map->tileHeight;
+                toX = (int)(screenRect.x + screenRect.width) / (int)map->tileWidth;
+                toY = (int)screenRect.y / (int)map->tileHeight;
+                break;
+            case RENDER_ORDER_LEFT_DOWN:
+                fromX = (int)(screenRect.x + screenRect.width) / (int)map->tileWidth;
+                fromY = (int)screenRect.y / (int)map->tileHeight;
+                toX = (int)screenRect.x / (int)map->tileWidth;
+                toY = (int)(screenRect.y + screenRect.height) / (int)map->tileHeight;
+                break;
+            case RENDER_ORDER_LEFT_UP:
+                fromX = (int)(screenRect.x + screenRect.width) / (int)map->tileWidth;
+                fromY = (int)(screenRect.y + screenRect.height) / (int)map->tileHeight;
+                toX = (int)screenRect.x / (int)map->tileWidth;
+                toY = (int)screenRect.y / (int)map->tileHeight;
+                break;
+        }
+        fromX = Clampi(fromX, 0, (int)map->width - 1);
+        fromY = Clampi(fromY, 0, (int)map->height - 1);
+        toX = Clampi(toX, 0, (int)map->width - 1);
+        toY = Clampi(toY, 0, (int)map->height - 1);
+        currentX = fromX;
+        currentY = fromY;
+    } else if (currentX == toX) {
+        currentX = fromX;
+        currentY += SIGN(toY - fromY);
+    } else {
+        currentX += SIGN(toX - fromX);
+    }
+
+    if ((toY - fromY > 0 && currentY > toY) || (toY - fromY < 0 && currentY < toY)) {
+        currentLayer = NULL;
+        fromX = fromY = toX = toY = currentX = currentY = 0;
+        return false;
+    }
+
+    int index = (currentY * (int)map->width) + currentX;
+    if (index < 0 || index >= (int)layer->tilesLength) {
+        currentLayer = NULL;
+        fromX = fromY = toX = toY = currentX = currentY = 0;
+        return false;
+    }
+
+    *rawGid = layer->tiles[index];
+    tileRect->x = (float)((uint32_t)currentX * map->tileWidth);
+    tileRect->y = (float)((uint32_t)currentY * map->tileHeight);
+    tileRect->width = (float)map->tileWidth;
+    tileRect->height = (float)map->tileHeight;
+    return true;
+}
+
+/**
+ * @enum Method
+ * @brief Way of iterating a tile layer being timed.
+ */
+enum Method {
+    METHOD_LEGACY, ///< The old static cursor, one tile per call.
+    METHOD_DENSE,  ///< The caller-owned iterator, one whole row per call.
+    METHOD_SPARSE  ///< The caller-owned iterator, walking only runs of non-empty tiles when they are indexed.
+};
+
+static const char* METHOD_NAMES[] = { "static cursor", "iterator, rows", "iterator, runs" };
+
+/**
+ * @brief Iterates an area of a layer a number of times.
+ * @param tiles Output. Non-empty tiles found by each pass.
+ * @return A checksum of every non-empty tile's GID and pixel X, the same for every method.
+ */
+static uint64_t iterate(Method method, const TmxMap* map, const TmxTileLayer* layer, Rectangle area, int passes,
+                        uint64_t* tiles) {
+    uint64_t checksum = 0;
+    *tiles = 0;
+    for (int pass = 0; pass < passes; pass++) {
+        uint64_t found = 0;
+        if (method == METHOD_LEGACY) {
+            uint32_t rawGid;
+            Rectangle tileRect;
+            while (legacyIterateTileLayer(map, layer, area, &rawGid, &tileRect)) {
+                if (rawGid == 0) continue;
+                checksum += rawGid + (uint64_t)tileRect.x;
+                found++;
+            }
+        } else {
+            RaytmxTileLayerIterator iterator = IterateTileLayer(map, layer, area);
+            if (method == METHOD_DENSE) iterator.isSparse = false;
+            RaytmxTileSpan span;
+            while (NextTileLayerSpan(&iterator, &span)) {
+                for (uint32_t i = 0; i < span.length; i++) {
+                    if (span.rawGids[i] == 0) continue;
+                    checksum += span.rawGids[i] + (uint64_t)(span.x + (int)i) * map->tileWidth;
+                    found++;
+                }
+            }
+        }
+        *tiles = found;
+    }
+    return checksum;
+}
+
+int main(int argc, char** argv) {
+    const char* fileName = argc > 1 ? argv[1] : "maps/LevelDesign2.tmx";
+    SetTraceLogLevel(LOG_WARNING);
+    TmxMap* map = LoadTMX(fileName);
+    if (map == NULL) {
+        fprintf(stderr, "Unable to load %s\n", fileName);
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < map->layersLength; i++) {
+        if (map->layers[i].type != LAYER_TYPE_TILE_LAYER) continue;
+        const TmxTileLayer* layer = &map->layers[i].exact.tileLayer;
+
+        struct { const char* name; Rectangle area; int passes; } areas[] = {
+            { "whole layer", { 0.0f, 0.0f, (float)(map->width * map->tileWidth) - 1.0f,
+                               (float)(map->height * map->tileHeight) - 1.0f }, 20 },
+            { "582x327 view", { 3000.0f, 1200.0f, 582.0f, 327.0f }, 20000 }
+        };
+        for (const auto& area : areas) {
+            printf("%s, layer \"%s\", %s:\n", GetFileName(fileName), map->layers[i].name, area.name);
+            for (int method = METHOD_LEGACY; method <= METHOD_SPARSE; method++) {
+                uint64_t tiles;
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                uint64_t checksum = iterate((Method)method, map, layer, area.area, area.passes, &tiles);
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                // Rates count every tile in the area, empty or not, so the methods are compared on the same work
+                double areaTiles = (double)((int)(area.area.width / map->tileWidth) + 1) *
+                                   ((int)(area.area.height / map->tileHeight) + 1) * area.passes;
+                printf("  %-15s %9llu tiles, checksum %016llx, %8.1f Mtiles/s\n", METHOD_NAMES[method],
+                       (unsigned long long)tiles, (unsigned long long)checksum,
+                       seconds > 0.0 ? areaTiles / seconds / 1e6 : 0.0);
+            }
+        }
+    }
+
+    UnloadTMX(map);
+    return 0;
+}
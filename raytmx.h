@@ -30,10 +30,10 @@ OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 #ifndef RAYTMX_H
     #define RAYTMX_H
 
-#include <ctype.h> /* isspace() */
-#include <math.h> /* floor(), INFINITY */
+#include <ctype.h> /* isalnum(), isspace(), tolower() */
+#include <math.h> /* floor(), fmaxf(), fminf(), INFINITY */
 #include <stddef.h> /* NULL */
-#include <stdint.h> /* int32_t, uint32_t */
+#include <stdint.h> /* int32_t, uint32_t, UINT32_MAX */
 #include <stdlib.h> /* atoi(), strtoul() */
 #include <string.h> /* memcpy(), memset(), strcpy(), strcpy_s() strlen(), strncpy(), strncpy_s() */
 
@@ -51,6 +51,15 @@ OF OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
 /***************/
 /* Definitions */
 
+/**
+ * Bit flags passed to LoadTMXEx() that alter how a map is loaded.
+ */
+enum tmx_load_flags {
+    LOAD_FROM_BINARY = 1, /**< Load from, and bake, the binary file beside the TMX document as LoadTMXBinary() does. */
+    LOAD_DEFER_TEXTURES = 2 /**< Decode images into RAM but leave uploading them to UploadTMXTextures(). Loading
+                                 makes no graphics calls with this flag so it may be done on a thread other than the
+                                 one that owns the graphics context. */
+};
 /**
  * Bit flags passed to SetTraceLogFlagsTMX() that optionally disable the logging of specific TMX elements.
  */
@@ -90,6 +99,20 @@ typedef enum tmx_property_type {
     PROPERTY_TYPE_OBJECT /**< Object (<object>) within the map as an integer ID. */
 } TmxPropertyType;
 
+/**
+ * Flags for the gameplay roles a layer can be tagged with. Roles are assigned when the map is loaded, from the layer's
+ * "role" string property if it has one, else from its class, else from any role names that appear as words in its name
+ * (e.g. "Hazard Spikes"). Properties and classes may list several roles separated by commas or spaces. Role names are
+ * matched case-insensitively.
+ */
+typedef enum tmx_layer_role {
+    LAYER_ROLE_NONE = 0, /**< The layer has no role. */
+    LAYER_ROLE_COLLISION = 1 << 0, /**< Solid geometry that characters stand on and bump into. Role name "collision". */
+    LAYER_ROLE_HAZARD = 1 << 1, /**< Areas that hurt characters touching them. Role name "hazard". */
+    LAYER_ROLE_PORTAL = 1 << 2, /**< Areas that take characters elsewhere. Role name "portal". */
+    LAYER_ROLE_DECORATION = 1 << 3 /**< Drawn with no effect on gameplay. Role name "decoration". */
+} TmxLayerRole;
+
 /**
  * Identifiers for the possible draw orders applicable to object layers.
  */
@@ -170,6 +193,8 @@ typedef enum tmx_render_order {
 /* Forward declarations of TMX types */
 typedef struct tmx_image TmxImage;
 typedef struct tmx_tile_layer TmxTileLayer;
+typedef struct tmx_tile_run TmxTileRun;
+typedef struct tmx_object_bvh_node TmxObjectBvhNode;
 typedef struct tmx_object_group TmxObjectGroup;
 typedef struct tmx_image_layer TmxImageLayer;
 typedef struct tmx_layer TmxLayer;
@@ -194,8 +219,29 @@ typedef struct tmx_image {
     uint32_t width; /**< Width of the image in pixels. */
     uint32_t height; /**< Height of the image in pixels. */
     Texture2D texture; /**< The image as a raylib texture loaded into VRAM, if loading was successful. */
+    Image pendingImage; /**< (Optional) the image decoded into RAM by LoadTMXEx() with LOAD_DEFER_TEXTURES that has
+                             yet to be uploaded into 'texture' by UploadTMXTextures(). Its 'data' is NULL otherwise. */
 } TmxImage;
 
+/**
+ * A run of adjacent, non-empty tiles within one row of a tile layer. Built when the layer is loaded.
+ */
+typedef struct tmx_tile_run {
+    uint32_t x; /**< Column, in tiles, of the run's first tile. */
+    uint32_t length; /**< Number of tiles in the run. */
+} TmxTileRun;
+
+/**
+ * A node of an object group's bounding volume hierarchy (BVH). Nodes are stored in depth-first order, so an inner
+ * node's first child directly follows it. Built when the layer is loaded.
+ */
+typedef struct tmx_object_bvh_node {
+    Rectangle aabb; /**< Union of the Axis-Aligned Bounding Boxes (AABB) of every object beneath this node. */
+    uint32_t first; /**< Index into the group's 'bvhObjects' of a leaf's first object. Zero for inner nodes. */
+    uint32_t count; /**< Number of objects in a leaf, or zero for an inner node. */
+    uint32_t skip; /**< Index of the node following this node's subtree, where a search resumes after a miss. */
+} TmxObjectBvhNode;
+
 /**
  * Model of a <layer> element when combined with the 'TmxLayer' model. Defines a tile layer with a fixed-size list of
  * tile Global IDs (GIDs).
@@ -207,6 +253,14 @@ typedef struct tmx_tile_layer {
     char* compression; /**< (Optional) compression used to compress tiles. May be NULL, "gzip," "zlib," or "zstd." */
     uint32_t* tiles; /**< Array of tile Global IDs (GIDs) contained by this tile layer. */
     uint32_t tilesLength; /**< Length of the 'tiles' array. */
+    TmxTileRun* runs; /**< (Optional) runs of non-empty tiles in row-major order, letting iteration skip empty cells.
+                           May be NULL if the layer's dimensions don't match the map's. */
+    uint32_t runsLength; /**< Length of the 'runs' array. */
+    uint32_t* rowRuns; /**< (Optional) array of 'height' + 1 indexes into 'runs' where the runs of row Y are found from
+                            rowRuns[Y] up to, but not including, rowRuns[Y + 1]. NULL when 'runs' is. */
+    struct raytmx_render_chunk_set* renderChunks; /**< (Internal) render textures caching chunks of this layer's
+                                                       tiles. Created by the first draw when the chunk cache is enabled
+                                                       with SetTMXChunkCache(), may be NULL. */
 } TmxTileLayer;
 
 /**
@@ -222,6 +276,10 @@ typedef struct tmx_object_group {
     TmxObject* objects; /**< Array of objects contained by this object layer. */
     uint32_t objectsLength; /**< Length of the 'objects' array. */
     uint32_t* ySortedObjects; /**< Array of indexes of 'objects' sorted by the objects' y-coordinates. */
+    TmxObjectBvhNode* bvh; /**< (Optional) bounding volume hierarchy over the objects' AABBs that lets collision checks
+                                skip distant objects. NULL for groups that aren't layers, such as a tile's. */
+    uint32_t bvhLength; /**< Length of the 'bvh' array. */
+    uint32_t* bvhObjects; /**< (Optional) array of indexes of 'objects' ordered so each leaf of 'bvh' covers a range. */
 } TmxObjectGroup;
 
 /**
@@ -257,6 +315,7 @@ typedef struct tmx_layer {
     uint32_t propertiesLength; /**< Length of the 'properties' array. */
     TmxLayer* layers; /**< (Optional) array of child layers, may be NULL. This array is only used by group layers. */
     uint32_t layersLength; /**< Length of the 'layers' array. */
+    uint32_t roles; /**< Logically OR'd TmxLayerRole flags the layer is tagged with, assigned when it's loaded. */
     union layer_type_union {
         TmxTileLayer tileLayer;
         TmxObjectGroup objectGroup;
@@ -438,8 +497,34 @@ typedef struct tmx_map {
     TmxTile* gidsToTiles; /**< Array of pre-calculated tile metadata with all the values needed to quickly draw a tile
                                given its GID. Allocated such that gidsToTiles[1] returns the data of tile GID 1. */
     uint32_t gidsToTilesLength; /**< Length of the 'gidsToTiles' array. */
+    void* binaryData; /**< (Optional) contents of the baked binary file the map was loaded from by LoadTMXBinary(), or
+                           NULL if the map was parsed from TMX. Tile layers' 'tiles' arrays point into this memory. */
+    size_t binaryDataLength; /**< Length of 'binaryData' in bytes. */
+    struct raytmx_layer_index_entry* layerIndex; /**< (Internal) hash table of the map's layers, nested layers
+                                                      included, by name. Built when the map is loaded. */
+    uint32_t layerIndexLength; /**< (Internal) number of slots in 'layerIndex', a power of two. */
 } TmxMap;
 
+/**
+ * Statistics of the cache of render textures that tile layers are drawn from. See SetTMXChunkCache().
+ */
+typedef struct tmx_chunk_cache_stats {
+    uint32_t residentChunks; /**< Number of chunks currently rasterized into render textures. */
+    size_t residentBytes; /**< Estimated VRAM, in bytes, used by resident chunks. */
+    size_t budgetBytes; /**< VRAM, in bytes, that resident chunks may use before the least recent are evicted. */
+    uint32_t drawnChunks; /**< Number of chunks drawn by the most recent DrawTMX() or DrawTMXLayers() call. */
+    uint32_t rasterizedChunks; /**< Total number of chunks rasterized since the cache was enabled. */
+    uint32_t evictedChunks; /**< Total number of chunks unloaded to stay within the budget. */
+} TmxChunkCacheStats;
+
+/**
+ * Statistics of the batches that tiles of tile layers are drawn in. See GetTMXTileBatchStats().
+ */
+typedef struct tmx_tile_batch_stats {
+    uint32_t submittedQuads; /**< Number of tile quads submitted by the latest DrawTMX() or DrawTMXLayers() call. */
+    uint32_t submittedBatches; /**< Number of batches, each a single texture and draw, those quads were submitted in. */
+} TmxTileBatchStats;
+
 /**
  * Given a path to TMX document, parse it and create an equivalent model that can be, among other uses, quickly drawn.
  * This function allocates memory and loads textures into VRAM. To clean up, use UnloadTMX().
@@ -449,6 +534,27 @@ typedef struct tmx_map {
  */
 RAYTMX_DEC TmxMap* LoadTMX(const char* fileName);
 
+/**
+ * Given a path to a TMX document, load it like LoadTMX() or LoadTMXBinary() do with the behavior altered by the given
+ * flags. With LOAD_DEFER_TEXTURES, loading only reads files and allocates memory so it can run on a worker thread while
+ * the main thread keeps drawing. The map must then be passed to UploadTMXTextures(), on the thread that owns the
+ * graphics context, before it is drawn.
+ *
+ * @param fileName File name and/or path referencing a TMX document on disk to be loaded.
+ * @param flags Bit flags from 'tmx_load_flags' combined with bitwise OR, or zero to behave like LoadTMX().
+ * @return A model of the map as defined by the given TMX document, or NULL if loading failed for any reason.
+ */
+RAYTMX_DEC TmxMap* LoadTMXEx(const char* fileName, int flags);
+
+/**
+ * Upload the images of a map loaded by LoadTMXEx() with LOAD_DEFER_TEXTURES into VRAM and free the decoded images.
+ * Maps whose textures are already uploaded are left as they are. This must be called from the thread that owns the
+ * graphics context.
+ *
+ * @param map A loaded map model whose images are to be uploaded as textures.
+ */
+RAYTMX_DEC void UploadTMXTextures(TmxMap* map);
+
 /**
  * Unload a given map model by freeing memory allocations and unloading textures. In other words, free the resources
  * reserved by LoadTMX().
@@ -457,6 +563,31 @@ RAYTMX_DEC TmxMap* LoadTMX(const char* fileName);
  */
 RAYTMX_DEC void UnloadTMX(TmxMap* map);
 
+/**
+ * Given a path to a TMX document, load the map from the baked binary file beside it (the TMX file name with a 'b'
+ * appended, e.g. "map.tmx" -> "map.tmxb") if one exists and is up to date. The binary file is memory-mapped and tile
+ * layers' tiles are read directly from the mapped pages. If the binary file is missing, was baked from an older version
+ * of the TMX document or its external tilesets, or cannot be read, the TMX document is parsed with LoadTMX() instead
+ * and the binary file is (re)baked with ExportTMXBinary() for next time.
+ * The resulting map is unloaded with UnloadTMX() either way.
+ *
+ * @param fileName File name and/or path referencing a TMX document on disk to be loaded.
+ * @return A model of the map as defined by the given TMX document, or NULL if loading failed for any reason.
+ */
+RAYTMX_DEC TmxMap* LoadTMXBinary(const char* fileName);
+
+/**
+ * Bake a map previously loaded from the given TMX document into a compact, versioned binary file beside it that
+ * LoadTMXBinary() can load without parsing any XML. Tile arrays, object groups with their AABBs, and the GID-to-tile
+ * table are stored. Maps using features the binary format doesn't cover (properties, group layers, image layers, text
+ * objects, or tilesets with explicit tiles) are not baked and will keep being parsed from TMX.
+ *
+ * @param map A map model loaded from the given TMX document.
+ * @param fileName File name and/or path referencing the TMX document the map was loaded from.
+ * @return True if the binary file was written, or false if the map cannot be baked or writing failed.
+ */
+RAYTMX_DEC bool ExportTMXBinary(const TmxMap* map, const char* fileName);
+
 /**
  * Draw the entirety of the given map at the given position.
  * When a camera is also passed to this function, parallaxed scrolling can be applied to layers with parallax factors
@@ -492,6 +623,43 @@ RAYTMX_DEC void DrawTMX(const TmxMap* map, const Camera2D* camera, int posX, int
 RAYTMX_DEC void DrawTMXLayers(const TmxMap* map, const Camera2D* camera, const TmxLayer* layers, uint32_t layersLength,
     int posX, int posY, Color tint);
 
+/**
+ * Enable, disable, or reconfigure the cache of render textures that tile layers are drawn from.
+ * When enabled, tile layers are split into square chunks of tiles. Each chunk is rasterized once into a render texture
+ * and from then on drawn as a single textured quad whenever it intersects the screen, rather than tile by tile. The
+ * least recently drawn chunks are unloaded once the cache exceeds its VRAM budget. Layers with animated tiles or with
+ * parallax factors other than 1.0 are still drawn tile by tile. The cache is disabled by default.
+ * Chunks are rasterized during DrawTMX() and DrawTMXLayers(), which then must not be called while a render texture is
+ * the active target.
+ *
+ * @param chunkSize Width and height of a chunk in tiles, or 0 to disable the cache.
+ * @param budgetBytes VRAM, in bytes, that resident chunks may use.
+ */
+RAYTMX_DEC void SetTMXChunkCache(uint32_t chunkSize, size_t budgetBytes);
+
+/**
+ * Get the statistics of the cache of render textures that tile layers are drawn from.
+ *
+ * @return The number of resident chunks, their estimated VRAM usage, and counters of chunk activity.
+ */
+RAYTMX_DEC TmxChunkCacheStats GetTMXChunkCacheStats(void);
+
+/**
+ * Get the statistics of the batches that tiles of tile layers are drawn in. Rather than being drawn one at a time, the
+ * visible tiles of a layer are collected into one batch of quads per tileset texture and each batch is submitted as a
+ * single draw once the layer is done. Tiles drawn from the chunk cache's render textures are not included.
+ *
+ * @return The number of tile quads and batches submitted by the most recent DrawTMX() or DrawTMXLayers() call.
+ */
+RAYTMX_DEC TmxTileBatchStats GetTMXTileBatchStats(void);
+
+/**
+ * Free the batches that tiles of tile layers are collected into, along with their quads. Batches are kept across
+ * frames, one per texture, and UnloadTMX() frees those of the textures the unloaded map drew with, so this is only
+ * needed to release the memory early, such as after unloading textures that maps still reference.
+ */
+RAYTMX_DEC void ResetTMXTileBatches(void);
+
 /**
  * Progress the animations of the given map in real-time. This is intended to be called once per frame, or once per
  * BeginDrawing() an EndDrawing() call. If called more or less frequently, animation speeds will be affected.
@@ -500,6 +668,31 @@ RAYTMX_DEC void DrawTMXLayers(const TmxMap* map, const Camera2D* camera, const T
  */
 RAYTMX_DEC void AnimateTMX(TmxMap* map);
 
+/**
+ * Find a layer of the given map by name, including layers nested within groups. Layers are indexed by name when the map
+ * is loaded so this is a hash lookup rather than a comparison against every layer's name. If several layers share the
+ * name, the first one in document order is returned.
+ *
+ * @param map A loaded map model to find the layer in.
+ * @param name Name of the layer to be found.
+ * @return A pointer to the layer within the map, or NULL if the map has no layer with the given name.
+ */
+RAYTMX_DEC TmxLayer* GetTMXLayer(const TmxMap* map, const char* name);
+
+/**
+ * Gather the layers of the given map, including layers nested within groups, that are tagged with any of the given
+ * roles. The pointers remain valid until the map is unloaded, so gameplay code can look layers up once per map.
+ *
+ * @param map A loaded map model to gather the layers of.
+ * @param roles Logically OR'd TmxLayerRole flags, any of which a layer must be tagged with to be gathered.
+ * @param outputLayers Output array assigned with pointers to the gathered layers, in document order. May be NULL if
+ *                     only the count is wanted.
+ * @param outputLength Length of the 'outputLayers' array. Layers beyond it are counted but not assigned.
+ * @return The number of layers tagged with any of the given roles, which may exceed 'outputLength.'
+ */
+RAYTMX_DEC uint32_t GetTMXLayersWithRole(const TmxMap* map, uint32_t roles, TmxLayer** outputLayers,
+    uint32_t outputLength);
+
 /**
  * Check for collisions between two objects of arbitrary type. Objects that are not primitive shapes, namely text and
  * tiles, are treated as rectangles.
@@ -603,6 +796,21 @@ RAYTMX_DEC bool CheckCollisionTMXLayersPolyEx(const TmxMap* map, const TmxLayer*
  */
 RAYTMX_DEC bool CheckCollisionTMXObjectGroupRec(TmxObjectGroup group, Rectangle rec, TmxObject* outputObject);
 
+/**
+ * Find every object in the given object group, with 0+ objects of arbitrary shape, that collides with the given
+ * rectangle rather than only the first.
+ * Note: This function assumes the map is positioned at (0, 0). If the map is drawn with an offset, normalize.
+ *
+ * @param group The object group whose 0+ objects will be checked for collisions.
+ * @param rec The rectangle to perform collision checks on.
+ * @param outputObjects Output array assigned with the objects the rectangle collided with, in no particular order. May
+ *                      be NULL if only the count is wanted.
+ * @param outputLength Length of the 'outputObjects' array. Collisions beyond it are counted but not assigned.
+ * @return The number of objects in the object group the rectangle collides with, which may exceed 'outputLength.'
+ */
+RAYTMX_DEC uint32_t CheckCollisionTMXObjectGroupRecAll(TmxObjectGroup group, Rectangle rec, TmxObject* outputObjects,
+    uint32_t outputLength);
+
 /**
  * Check for collisions between the given object group, with 0+ objects of arbitrary shape, and the given circle.
  * Note: This function assumes the map is positioned at (0, 0). If the map is drawn with an offset, normalize.
@@ -685,11 +893,52 @@ RAYTMX_DEC void SetTraceLogFlagsTMX(int logFlags);
 #endif
 #include "hoxml.h"
 
+/* CSV tile data is decoded several GIDs at a time with SIMD instructions where the target supports them. Define */
+/* RAYTMX_NO_SIMD to force the portable, one-character-at-a-time decoder. */
+#if !defined RAYTMX_NO_SIMD && defined __AVX2__
+    #define RAYTMX_CSV_AVX2
+    #define RAYTMX_CSV_SSE2 /* Every AVX2 target also supports SSE2 which is used for the shorter tail */
+    #include <immintrin.h> /* __m256i, _mm256_*() */
+#elif !defined RAYTMX_NO_SIMD && (defined __SSE2__ || defined _M_X64 || (defined _M_IX86_FP && _M_IX86_FP >= 2))
+    #define RAYTMX_CSV_SSE2
+    #include <emmintrin.h> /* __m128i, _mm_*() */
+#endif
+
+/* Helpers that return paths in static buffers make them thread-local so that maps can be loaded on worker threads */
+#if defined __cplusplus
+    #define RAYTMX_THREAD_LOCAL thread_local
+#elif defined _MSC_VER
+    #define RAYTMX_THREAD_LOCAL __declspec(thread)
+#elif defined __STDC_VERSION__ && __STDC_VERSION__ >= 201112L
+    #define RAYTMX_THREAD_LOCAL _Thread_local
+#else
+    #define RAYTMX_THREAD_LOCAL __thread
+#endif
+
+/* Baked binary maps are memory-mapped where POSIX mmap() is available. On Windows, raylib's LoadFileData() is used */
+/* instead since <windows.h> conflicts with raylib.h. */
+#ifndef _WIN32
+    #include <fcntl.h> /* open(), O_RDONLY */
+    #include <sys/mman.h> /* mmap(), munmap() */
+    #include <sys/stat.h> /* fstat() */
+    #include <unistd.h> /* close() */
+#endif
+#include <stdio.h> /* remove(), rename(), snprintf() */
+
 /******************/
 /* Implementation */
 
 #define TMX_LINE_THICKNESS 3.0f /* Thickness, in pixels, that outlines of specific objects are drawn with */
 
+#ifndef RAYTMX_ARENA_BLOCK_SIZE
+    #define RAYTMX_ARENA_BLOCK_SIZE 65536 /* Size, in bytes, of each block reserved by the parser's scratch arena */
+#endif
+#define RAYTMX_ARENA_ALIGNMENT 16 /* Alignment, in bytes, of every allocation made from the parser's scratch arena */
+
+#define RAYTMX_BINARY_MAGIC 0x42584D54 /* "TMXB" read as a little-endian integer, rejecting the other byte order */
+#define RAYTMX_BINARY_VERSION 2 /* Incremented whenever the layout of baked binary maps changes */
+#define RAYTMX_BINARY_ALIGNMENT 16 /* Alignment, in bytes, of arrays within baked binary maps */
+
 /* Bit flags that GIDs may be masked with in order to indicate transformations for individual tiles */
 enum tmx_flip_flags {
     FLIP_FLAG_HORIZONTAL = 0x80000000,
@@ -708,11 +957,25 @@ typedef struct raytmx_tileset_node RaytmxTilesetNode;
 typedef struct raytmx_tileset_tile_node RaytmxTilesetTileNode;
 typedef struct raytmx_animation_frame_node RaytmxAnimationFrameNode;
 typedef struct raytmx_layer_node RaytmxLayerNode;
-typedef struct raytmx_tile_layer_tile_node RaytmxTileLayerTileNode;
 typedef struct raytmx_object_node RaytmxObjectNode;
 typedef struct raytmx_object_sorting_node RaytmxObjectSortingNode;
 typedef struct raytmx_poly_point_node RaytmxPolyPointNode;
 typedef struct raytmx_text_line_node RaytmxTextLineNode;
+typedef struct raytmx_arena_block RaytmxArenaBlock;
+typedef struct raytmx_binary_buffer RaytmxBinaryBuffer;
+typedef struct raytmx_binary_header RaytmxBinaryHeader;
+typedef struct raytmx_binary_tileset RaytmxBinaryTileset;
+typedef struct raytmx_binary_template RaytmxBinaryTemplate;
+typedef struct raytmx_binary_layer RaytmxBinaryLayer;
+typedef struct raytmx_binary_object RaytmxBinaryObject;
+typedef struct raytmx_binary_tile RaytmxBinaryTile;
+typedef struct raytmx_layer_index_entry RaytmxLayerIndexEntry;
+typedef struct raytmx_render_chunk RaytmxRenderChunk;
+typedef struct raytmx_render_chunk_set RaytmxRenderChunkSet;
+typedef struct raytmx_tile_layer_iterator RaytmxTileLayerIterator;
+typedef struct raytmx_tile_span RaytmxTileSpan;
+typedef struct raytmx_tile_quad RaytmxTileQuad;
+typedef struct raytmx_tile_batch RaytmxTileBatch;
 typedef enum raytmx_document_format {
     FORMAT_TMX = 0, /* Tilemap with tilesets, layers, etc. */
     FORMAT_TSX, /* External tilesets */
@@ -730,8 +993,56 @@ typedef struct raytmx_object_template {
 typedef struct raytmx_cached_texture {
     char* fileName;
     Texture2D texture;
+    Image image; /* Decoded image awaiting upload when the texture upload is deferred */
     RaytmxCachedTextureNode* next;
 } RaytmxCachedTextureNode; /* Associates a file name with a Texture2D allowing for the reuse of textures in VRAM */
+typedef struct raytmx_render_chunk {
+    RenderTexture2D target; /* Rasterized tiles of the chunk, or an ID of 0 when the chunk isn't resident */
+    uint32_t lastDrawn; /* Draw call counter value at which the chunk was last drawn */
+    RaytmxRenderChunk* moreRecent; /* Neighbors in the least-recently-used list of resident chunks */
+    RaytmxRenderChunk* lessRecent;
+} RaytmxRenderChunk;
+typedef struct raytmx_tile_layer_iterator {
+    const TmxTileLayer* layer; /* Tile layer being iterated */
+    uint32_t stride; /* Number of tiles in a row of the layer, the map's width */
+    int fromX; /* Leftmost column, in tiles, of each span */
+    int toX; /* Rightmost column, in tiles, of each span */
+    int nextY; /* Row, in tiles, of the span returned by the next call */
+    int toY; /* Row, in tiles, of the final span */
+    int stepY; /* Either +1 or -1 depending on whether rows are iterated downward or upward */
+    bool isRightToLeft; /* When true, the render order draws each row from right to left */
+    bool isDone; /* When true, every row has been returned */
+    bool isSparse; /* When true, rows are walked through the layer's runs of non-empty tiles */
+    int runY; /* Row, in tiles, whose runs are being returned */
+    int nextRun; /* Index in the layer's 'runs' of the run to be returned next */
+    int endRun; /* Index in the layer's 'runs' at which the current row's runs end */
+    int runStep; /* Either +1 or -1 depending on whether runs are returned left to right or right to left */
+} RaytmxTileLayerIterator; /* Iteration state over the rows of a tile layer overlapping an area, owned by the caller */
+typedef struct raytmx_tile_span {
+    const uint32_t* rawGids; /* Contiguous raw Global IDs (GIDs), with possible flip flags, from left to right */
+    uint32_t length; /* Length of the 'rawGids' array */
+    int x; /* Column, in tiles, of the leftmost tile */
+    int y; /* Row, in tiles, of every tile */
+    bool isRightToLeft; /* When true, the render order draws the span from its last tile to its first */
+} RaytmxTileSpan; /* Run of adjacent tiles within a single row of a tile layer */
+typedef struct raytmx_tile_quad {
+    Vector2 positions[4]; /* Corners on the screen in the order top-left, bottom-left, bottom-right, top-right */
+    Vector2 texCoords[4]; /* Texture coordinates of those corners with any flips already applied */
+    Color tint;
+} RaytmxTileQuad; /* Textured quad of a single tile, ready to be submitted */
+typedef struct raytmx_tile_batch {
+    unsigned int textureId; /* Texture shared by every quad in the batch */
+    RaytmxTileQuad* quads; /* Quads queued since the last flush */
+    uint32_t quadsLength; /* Number of queued quads */
+    uint32_t quadsCapacity; /* Number of quads the 'quads' array has room for */
+} RaytmxTileBatch; /* Tile quads sharing a texture, waiting to be drawn together */
+typedef struct raytmx_render_chunk_set {
+    uint32_t chunkSize; /* Width and height of each chunk in tiles */
+    uint32_t columns; /* Number of chunks horizontally */
+    uint32_t rows; /* Number of chunks vertically */
+    bool isCacheable; /* When false, the layer has animated tiles and is always drawn tile by tile */
+    RaytmxRenderChunk* chunks; /* Array of 'columns' * 'rows' chunks in row-major order */
+} RaytmxRenderChunkSet; /* Render textures caching a tile layer, in chunks */
 typedef struct raytmx_cached_template {
     char* fileName;
     RaytmxObjectTemplate objectTemplate;
@@ -758,10 +1069,6 @@ typedef struct raytmx_layer_node {
     uint32_t childrenLength;
     RaytmxLayerNode *next, *parent, *childrenRoot, *childrenTail;
 } RaytmxLayerNode;
-typedef struct raytmx_tile_layer_tile_node {
-    uint32_t gid;
-    RaytmxTileLayerTileNode* next;
-} RaytmxTileLayerTileNode;
 typedef struct raytmx_object_node {
     TmxObject object;
     RaytmxObjectNode* next;
@@ -779,10 +1086,72 @@ typedef struct raytmx_text_line_node {
     TmxTextLine line;
     RaytmxTextLineNode* next;
 } RaytmxTextLineNode;
+typedef struct raytmx_arena_block {
+    size_t capacity, used; /* Total bytes in the block, including this header, and bytes handed out so far */
+    RaytmxArenaBlock* next;
+} RaytmxArenaBlock; /* Header of a block of scratch memory - the usable bytes immediately follow the header */
+typedef struct raytmx_binary_buffer {
+    unsigned char* data;
+    size_t length, capacity;
+} RaytmxBinaryBuffer; /* Growable buffer a baked binary map is written into before being saved */
+/* Baked binary maps are the following records, in native byte order, with every array aligned to 16 bytes: */
+/* a header, the tilesets, the object templates, the top-level layers, each layer's tiles or objects (and their points and Y-sorted */
+/* indexes), the GID-to-tile table, and finally a string table. Strings are referenced by their offset within the */
+/* string table plus one so that zero can stand for NULL. Offsets of everything else are from the start of the file. */
+typedef struct raytmx_binary_header {
+    uint32_t magic, version;
+    int64_t sourceModTime, sourceLength; /* Modification time and length of the TMX document that was baked */
+    uint32_t orientation, renderOrder, width, height, tileWidth, tileHeight;
+    int32_t parallaxOriginX, parallaxOriginY;
+    Color backgroundColor;
+    uint32_t hasBackgroundColor;
+    uint32_t tilesetsLength, templatesLength, layersLength, gidsToTilesLength, stringsLength;
+    uint64_t tilesetsOffset, templatesOffset, layersOffset, gidsToTilesOffset, stringsOffset;
+} RaytmxBinaryHeader;
+typedef struct raytmx_binary_tileset {
+    uint32_t firstGid, lastGid, tileWidth, tileHeight, spacing, margin, tileCount, columns, objectAlignment;
+    int32_t tileOffsetX, tileOffsetY;
+    uint32_t source, name, classString; /* String table references */
+    uint32_t imageSource, imagePath; /* String table references, the latter relative to the TMX document */
+    uint32_t imageWidth, imageHeight;
+    int64_t sourceModTime; /* Modification time of the TSX document of an external tileset, or zero */
+} RaytmxBinaryTileset;
+typedef struct raytmx_binary_template {
+    uint32_t source; /* String table reference to the TX document, relative to the TMX document */
+    int64_t sourceModTime; /* Modification time of the TX document, which objects' baked values depend on */
+} RaytmxBinaryTemplate;
+typedef struct raytmx_binary_layer {
+    uint32_t type, id, name, classString, visible, hasTintColor;
+    Color tintColor;
+    int32_t offsetX, offsetY;
+    double opacity, parallaxX, parallaxY;
+    uint32_t width, height, tilesLength; /* Tile layers only */
+    Color color; /* Object groups only, as are the next three */
+    uint32_t hasColor, drawOrder, objectsLength;
+    uint64_t dataOffset; /* Offset of the tile layer's GIDs or of the object group's objects */
+    uint64_t ySortedObjectsOffset;
+} RaytmxBinaryLayer;
+typedef struct raytmx_binary_object {
+    uint32_t type, id, name, typeString, gid, visible, pointsLength;
+    double x, y, width, height, rotation;
+    Rectangle aabb;
+    uint64_t pointsOffset;
+} RaytmxBinaryObject;
+typedef struct raytmx_binary_tile {
+    uint32_t gid;
+    int32_t tilesetIndex; /* Index of the tileset whose texture the tile is drawn with, or -1 if it has none */
+    Rectangle sourceRect;
+    Vector2 offset;
+} RaytmxBinaryTile;
+typedef struct raytmx_layer_index_entry {
+    uint32_t hash; /* Hash of the layer's name, compared before the names themselves */
+    TmxLayer* layer; /* NULL for an empty slot */
+} RaytmxLayerIndexEntry;
 typedef struct raytmx_state {
     RaytmxDocumentFormat format;
     char documentDirectory[512];
     bool isSuccess;
+    bool isTextureUploadDeferred; /* When true, images are only decoded and are uploaded later by UploadTMXTextures() */
 
     /* Variables intended for TMX (map) parsing */
     RaytmxCachedTextureNode* texturesRoot;
@@ -810,20 +1179,26 @@ typedef struct raytmx_state {
     TmxObject* object;
 
     /* These variables are linked lists containing various elements where an arbitrary amount are allowed, such as */
-    /* 1+ <object> elements in an <objectgroup>, that will be copied to arrays of known sizes later on */
+    /* 1+ <object> elements in an <objectgroup>, that will be copied to arrays of known sizes later on. The nodes */
+    /* are allocated from 'arena' and are never freed individually - the whole arena is released by FreeState(). */
+    RaytmxArenaBlock* arena;
     RaytmxPropertyNode *propertiesRoot, *propertiesTail;
     RaytmxTilesetNode *tilesetsRoot, *tilesetsTail;
     RaytmxTilesetTileNode *tilesetTilesRoot, *tilesetTilesTail;
     RaytmxAnimationFrameNode *animationFramesRoot, *animationFramesTail;
     RaytmxLayerNode *layersRoot, *layersTail, *groupNode;
-    RaytmxTileLayerTileNode *layerTilesRoot, *layerTilesTail;
     RaytmxObjectNode *objectsRoot, *objectsTail;
     uint32_t tilesetsLength, tilesetTilesLength, animationFramesLength, propertiesLength, layersLength,
-        layerTilesLength, objectsLength, propertiesDepth;
+        objectsLength, propertiesDepth;
+
+    /* The GIDs of the tile layer currently being parsed. Unlike the lists above, this is a plain array that is */
+    /* reserved up front from the layer's 'width' and 'height' and handed to the TmxTileLayer without copying. */
+    uint32_t* layerTiles;
+    uint32_t layerTilesLength, layerTilesCapacity;
 } RaytmxState; /* Intermediate data used internally to parse TMX (map), TSX (tileset), and TX (template) files */
 
-RaytmxExternalTileset LoadTSX(const char* fileName);
-RaytmxObjectTemplate LoadTX(const char* fileName);
+RaytmxExternalTileset LoadTSX(const char* fileName, bool isTextureUploadDeferred);
+RaytmxObjectTemplate LoadTX(const char* fileName, bool isTextureUploadDeferred);
 void ParseDocument(RaytmxState* raytmxState, const char* fileName);
 void HandleElementBegin(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext);
 void HandleAttribute(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext);
@@ -834,10 +1209,58 @@ void FreeTileset(TmxTileset tileset);
 void FreeProperty(TmxProperty property);
 void FreeLayer(TmxLayer layer);
 void FreeObject(TmxObject object);
-bool IterateTileLayer(const TmxMap* map, const TmxTileLayer* layer, Rectangle screenRect, uint32_t* rawGid,
-    TmxTile* tile, Rectangle* tileRect);
+bool IsTMXBinarySupported(const TmxMap* map);
+TmxMap* LoadBakedTMX(const char* fileName, const unsigned char* data, size_t length, bool isTextureUploadDeferred);
+Texture2D LoadTextureOrImage(const char* fileName, bool isTextureUploadDeferred, Image* pendingImage);
+uint32_t GatherTMXImages(TmxMap* map, TmxImage** images);
+uint32_t GatherTMXLayerImages(TmxLayer* layers, uint32_t layersLength, TmxImage** images);
+void UnloadPendingImages(TmxImage** images, uint32_t imagesLength);
+bool IsBinaryRangeValid(size_t length, uint64_t offset, uint64_t count, size_t size);
+char* CopyBinaryString(const unsigned char* data, const RaytmxBinaryHeader* header, uint32_t reference);
+void AppendBinaryData(RaytmxBinaryBuffer* buffer, const void* data, size_t size);
+void AlignBinaryData(RaytmxBinaryBuffer* buffer);
+uint32_t AppendBinaryString(RaytmxBinaryBuffer* strings, const char* str);
+unsigned char* MapBinaryFile(const char* fileName, size_t* length);
+void UnmapBinaryFile(void* data, size_t length);
+char* GetBinaryFileName(const char* fileName);
+bool ReplaceBinaryFile(const char* fileName, unsigned char* data, size_t length);
+void IndexTMXTileRuns(TmxMap* map);
+void IndexTileLayerRuns(const TmxMap* map, TmxLayer* layers, uint32_t layersLength, uint64_t* occupied,
+    uint64_t* total);
+void IndexTMXObjectGroups(TmxMap* map);
+void IndexTMXLayers(TmxMap* map);
+uint32_t CountLayers(const TmxLayer* layers, uint32_t layersLength);
+void IndexLayerList(TmxMap* map, TmxLayer* layers, uint32_t layersLength);
+uint32_t HashLayerName(const char* name);
+uint32_t GetLayerRoles(const TmxLayer* layer);
+uint32_t ParseLayerRoles(const char* text);
+uint32_t GatherLayersWithRole(TmxLayer* layers, uint32_t layersLength, uint32_t roles, TmxLayer** outputLayers,
+    uint32_t outputLength, uint32_t count);
+void IndexObjectGroupLayers(TmxLayer* layers, uint32_t layersLength, uint32_t* nodes);
+void BuildObjectGroupBvh(TmxObjectGroup* group);
+uint32_t BuildObjectBvhNode(TmxObjectGroup* group, const Vector2* centers, uint32_t first, uint32_t count);
+void SelectObjectsByCenter(uint32_t* indexes, const Vector2* centers, uint32_t count, uint32_t nth, bool isAxisX);
+RaytmxTileLayerIterator IterateTileLayer(const TmxMap* map, const TmxTileLayer* layer, Rectangle screenRect);
+bool NextTileLayerSpan(RaytmxTileLayerIterator* iterator, RaytmxTileSpan* span);
+void DrawTMXLayerList(const TmxMap* map, const Camera2D* camera, const TmxLayer* layers, uint32_t layersLength,
+    int posX, int posY, Color tint);
 void DrawTMXTileLayer(const TmxMap* map, Rectangle screenRect, TmxLayer layer, int posX, int posY, Color tint);
+bool DrawTMXTileLayerChunks(const TmxMap* map, Rectangle screenRect, TmxLayer* layer, int posX, int posY, Color tint);
+RaytmxRenderChunkSet* GetRenderChunkSet(const TmxMap* map, TmxTileLayer* tileLayer);
+Rectangle GetRenderChunkRect(const TmxMap* map, const TmxLayer* layer, const RaytmxRenderChunkSet* chunkSet, int x,
+    int y);
+void RasterizeRenderChunk(const TmxMap* map, TmxLayer layer, RaytmxRenderChunk* chunk, Rectangle chunkRect);
+void TouchRenderChunk(RaytmxRenderChunk* chunk);
+void UnloadRenderChunk(RaytmxRenderChunk* chunk);
+void FreeRenderChunkSet(RaytmxRenderChunkSet* chunkSet);
+void EvictRenderChunks(void);
 void DrawTMXLayerTile(const TmxMap* map, Rectangle screenRect, uint32_t rawGid, int posX, int posY, Color tint);
+void SetTileQuad(RaytmxTileQuad* quad, Texture2D texture, Rectangle source, Rectangle dest, bool flipX, bool flipY,
+    bool flipDiag, Color tint);
+void BatchTextureTile(Texture2D texture, Rectangle source, Rectangle dest, bool flipX, bool flipY, bool flipDiag,
+    Color tint);
+void FlushTileBatches(void);
+void DropTileBatches(const TmxMap* map);
 void DrawTMXObjectTile(const TmxMap* map, Rectangle screenRect, uint32_t rawGid, int posX, int posY, float width,
     float height, Color tint);
 void DrawTMXObjectGroup(const TmxMap* map, Rectangle screenRect, TmxLayer layer, int posX, int posY, Color tint);
@@ -845,6 +1268,8 @@ void DrawTMXImageLayer(const TmxMap* map, Rectangle screenRect, TmxLayer layer,
 bool CheckCollisionTMXTileLayerObject(const TmxMap* map, const TmxLayer* layers, uint32_t layersLength,
     TmxObject object, TmxObject* outputObject);
 bool CheckCollisionTMXObjectGroupObject(TmxObjectGroup group, TmxObject object, TmxObject* outputObject);
+uint32_t CheckCollisionTMXObjectGroupObjects(TmxObjectGroup group, TmxObject object, TmxObject* outputObjects,
+    uint32_t outputLength, uint32_t* firstIndex);
 void TraceLogTMXTilesets(int logLevel, TmxOrientation orientation, TmxTileset* tilesets, uint32_t tilesetsLength,
     int numSpaces);
 void TraceLogTMXProperties(int logLevel, TmxProperty* properties, uint32_t propertiesLength, int numSpaces);
@@ -852,7 +1277,10 @@ void TraceLogTMXLayers(int logLevel, TmxLayer* layers, uint32_t layersLength, in
 void TraceLogTMXObject(int logLevel, TmxObject object, int numSpaces);
 void StringCopy(char* destination, const char* source);
 TmxProperty* AddProperty(RaytmxState* raytmxState);
+void ReserveTileLayerTiles(RaytmxState* raytmxState, uint32_t capacity);
 void AddTileLayerTile(RaytmxState* raytmxState, uint32_t gid);
+void TakeTileLayerTiles(RaytmxState* raytmxState);
+uint32_t DecodeCsvTileLayerTiles(RaytmxState* raytmxState, const char* csv, size_t csvLength);
 TmxTileset* AddTileset(RaytmxState* raytmxState);
 TmxTilesetTile* AddTilesetTile(RaytmxState* raytmxState);
 TmxAnimationFrame* AddAnimationFrame(RaytmxState* raytmxState);
@@ -865,6 +1293,8 @@ Color GetColorFromHexString(const char* hex);
 uint32_t GetGid(uint32_t rawGid, bool* isFlippedHorizontally, bool* isFlippedVertically, bool* isFlippedDiagonally,
     bool* isRotatedHexagonal120);
 void* MemAllocZero(unsigned int size);
+void* ArenaAllocZero(RaytmxState* raytmxState, size_t size);
+void FreeArena(RaytmxState* raytmxState);
 char* GetDirectoryPath2(const char* filePath);
 char* JoinPath(const char* prefix, const char* suffix);
 void StringCopyN(char* destination, const char* source, size_t number);
@@ -874,9 +1304,41 @@ void StringConcatenate(char* destination, const char* source);
 /* Public implementation.                                                                                             */
 
 RAYTMX_DEC TmxMap* LoadTMX(const char* fileName) {
+    return LoadTMXEx(fileName, 0);
+}
+
+RAYTMX_DEC TmxMap* LoadTMXEx(const char* fileName, int flags) {
+    if (fileName == NULL)
+        return NULL;
+
+    if (flags & LOAD_FROM_BINARY) {
+        char binaryFileName[260]; /* Max path length on Windows, the bottleneck, is 260 characters */
+        StringCopy(binaryFileName, GetBinaryFileName(fileName));
+
+        size_t length = 0;
+        unsigned char* data = MapBinaryFile(binaryFileName, &length);
+        if (data != NULL) {
+            double startTime = GetTime();
+            TmxMap* map = LoadBakedTMX(fileName, data, length, (flags & LOAD_DEFER_TEXTURES) != 0);
+            if (map != NULL) {
+                IndexTMXTileRuns(map);
+                IndexTMXObjectGroups(map);
+                IndexTMXLayers(map);
+                TraceLog(LOG_DEBUG, "RAYTMX: Loaded baked map \"%s\" (%u bytes) in %.3f ms", binaryFileName,
+                    (unsigned int)length, (GetTime() - startTime) * 1000.0);
+                return map;
+            }
+            UnmapBinaryFile(data, length);
+            TraceLog(LOG_INFO, "RAYTMX: Baked map \"%s\" is out of date or invalid, parsing \"%s\" instead",
+                binaryFileName, fileName);
+        }
+        /* Fall through to parsing the TMX document, baked at the end so that the next load can skip the XML */
+    }
+
     RaytmxState raytmxState[1];
     memset(raytmxState, 0, sizeof(RaytmxState)); /* Initialize all values to zero, NULL, or an equivalent enum value */
     raytmxState->format = FORMAT_TMX;
+    raytmxState->isTextureUploadDeferred = (flags & LOAD_DEFER_TEXTURES) != 0;
 
     /* Initialize the map object */
     TmxMap* map = (TmxMap*)MemAllocZero(sizeof(TmxMap));
@@ -885,6 +1347,7 @@ RAYTMX_DEC TmxMap* LoadTMX(const char* fileName) {
     /* equivalent TMX, TSX, and/or TX elements. */
     ParseDocument(raytmxState, fileName);
     if (!raytmxState->isSuccess) {
+        FreeState(raytmxState);
         UnloadTMX(map);
         return NULL;
     }
@@ -1030,13 +1493,77 @@ RAYTMX_DEC TmxMap* LoadTMX(const char* fileName) {
     /* Free the linked lists and zeroize related values */
     FreeState(raytmxState);
 
+    IndexTMXTileRuns(map);
+    IndexTMXObjectGroups(map);
+    IndexTMXLayers(map);
+
+    if (flags & LOAD_FROM_BINARY)
+        ExportTMXBinary(map, fileName);
+
     return map;
 }
 
+RAYTMX_DEC void UploadTMXTextures(TmxMap* map) {
+    if (map == NULL)
+        return;
+
+    uint32_t imagesLength = GatherTMXImages(map, NULL);
+    if (imagesLength == 0)
+        return;
+    TmxImage** images = (TmxImage**)MemAllocZero(sizeof(TmxImage*) * imagesLength);
+    GatherTMXImages(map, images);
+
+    /* Within a document, images referencing the same file share decoded pixels. Upload those pixels only once and */
+    /* hand every sharer the same texture, just as LoadTMX() does with its texture cache. */
+    for (uint32_t i = 0; i < imagesLength; i++) {
+        if (images[i]->pendingImage.data == NULL)
+            continue;
+        uint32_t j = 0;
+        while (j < i && images[j]->pendingImage.data != images[i]->pendingImage.data)
+            j += 1;
+        if (j < i) /* If an earlier image shares the pixels and has already uploaded them */
+            images[i]->texture = images[j]->texture;
+        else {
+            images[i]->texture = LoadTextureFromImage(images[i]->pendingImage);
+            if (images[i]->texture.id == 0)
+                TraceLog(LOG_ERROR, "RAYTMX: Unable to upload texture \"%s\"", images[i]->source);
+        }
+    }
+    UnloadPendingImages(images, imagesLength);
+    MemFree(images);
+
+    /* The GID-to-tile table holds copies of the textures made while they were placeholders so update them */
+    for (uint32_t i = 0; i < map->tilesetsLength; i++) {
+        const TmxTileset* tileset = &map->tilesets[i];
+        if (tileset->hasImage) {
+            for (uint32_t id = 0; id < tileset->tileCount; id++) {
+                uint32_t gid = tileset->firstGid + id;
+                if (gid < map->gidsToTilesLength && !map->gidsToTiles[gid].hasAnimation)
+                    map->gidsToTiles[gid].texture = tileset->image.texture;
+            }
+        } else {
+            for (uint32_t j = 0; j < tileset->tilesLength; j++) {
+                uint32_t gid = tileset->firstGid + tileset->tiles[j].id;
+                if (tileset->tiles[j].hasImage && gid < map->gidsToTilesLength)
+                    map->gidsToTiles[gid].texture = tileset->tiles[j].image.texture;
+            }
+        }
+    }
+}
+
 RAYTMX_DEC void UnloadTMX(TmxMap* map) {
     if (map == NULL)
         return;
 
+    /* Free images that were decoded for, but never uploaded by, UploadTMXTextures() */
+    uint32_t imagesLength = GatherTMXImages(map, NULL);
+    if (imagesLength > 0) {
+        TmxImage** images = (TmxImage**)MemAllocZero(sizeof(TmxImage*) * imagesLength);
+        GatherTMXImages(map, images);
+        UnloadPendingImages(images, imagesLength);
+        MemFree(images);
+    }
+
     if (map->fileName != NULL)
         MemFree(map->fileName);
 
@@ -1053,17 +1580,244 @@ RAYTMX_DEC void UnloadTMX(TmxMap* map) {
     }
 
     if (map->layers != NULL) {
-        for (uint32_t i = 0; i < map->layersLength; i++)
+        for (uint32_t i = 0; i < map->layersLength; i++) {
+            /* Tiles of maps loaded from baked binary files belong to the mapped file rather than the heap */
+            if (map->binaryData != NULL && map->layers[i].type == LAYER_TYPE_TILE_LAYER)
+                map->layers[i].exact.tileLayer.tiles = NULL;
             FreeLayer(map->layers[i]);
+        }
         MemFree(map->layers);
     }
 
-    if (map->gidsToTiles != NULL)
+    if (map->gidsToTiles != NULL) {
+        DropTileBatches(map); /* Their textures are gone or going, and their IDs may be reused by other textures */
         MemFree(map->gidsToTiles);
+    }
+
+    if (map->layerIndex != NULL)
+        MemFree(map->layerIndex);
+
+    if (map->binaryData != NULL)
+        UnmapBinaryFile(map->binaryData, map->binaryDataLength);
 
     MemFree(map);
 }
 
+RAYTMX_DEC TmxMap* LoadTMXBinary(const char* fileName) {
+    return LoadTMXEx(fileName, LOAD_FROM_BINARY);
+}
+
+RAYTMX_DEC bool ExportTMXBinary(const TmxMap* map, const char* fileName) {
+    if (map == NULL || fileName == NULL)
+        return false;
+    if (map->binaryData != NULL)
+        return true; /* The map was loaded from an up-to-date binary file already */
+    if (!IsTMXBinarySupported(map))
+        return false;
+
+    RaytmxBinaryBuffer buffer = { NULL, 0, 0 }, strings = { NULL, 0, 0 };
+    AppendBinaryData(&strings, "", 1); /* Leading terminator so that every reference is one past a terminator */
+
+    RaytmxBinaryHeader header;
+    memset(&header, 0, sizeof(RaytmxBinaryHeader));
+    header.magic = RAYTMX_BINARY_MAGIC;
+    header.version = RAYTMX_BINARY_VERSION;
+    header.sourceModTime = (int64_t)GetFileModTime(fileName);
+    header.sourceLength = (int64_t)GetFileLength(fileName);
+    header.orientation = (uint32_t)map->orientation;
+    header.renderOrder = (uint32_t)map->renderOrder;
+    header.width = map->width;
+    header.height = map->height;
+    header.tileWidth = map->tileWidth;
+    header.tileHeight = map->tileHeight;
+    header.parallaxOriginX = map->parallaxOriginX;
+    header.parallaxOriginY = map->parallaxOriginY;
+    header.backgroundColor = map->backgroundColor;
+    header.hasBackgroundColor = map->hasBackgroundColor;
+    header.tilesetsLength = map->tilesetsLength;
+    header.layersLength = map->layersLength;
+    header.gidsToTilesLength = map->gidsToTilesLength;
+    AppendBinaryData(&buffer, NULL, sizeof(RaytmxBinaryHeader)); /* Reserved, written last once offsets are known */
+
+    /* Tilesets. The image's path is stored relative to the TMX document so it can be loaded without the TSX. */
+    AlignBinaryData(&buffer);
+    header.tilesetsOffset = buffer.length;
+    for (uint32_t i = 0; i < map->tilesetsLength; i++) {
+        const TmxTileset* tileset = &map->tilesets[i];
+        RaytmxBinaryTileset record;
+        memset(&record, 0, sizeof(RaytmxBinaryTileset));
+        record.firstGid = tileset->firstGid;
+        record.lastGid = tileset->lastGid;
+        record.tileWidth = tileset->tileWidth;
+        record.tileHeight = tileset->tileHeight;
+        record.spacing = tileset->spacing;
+        record.margin = tileset->margin;
+        record.tileCount = tileset->tileCount;
+        record.columns = tileset->columns;
+        record.objectAlignment = (uint32_t)tileset->objectAlignment;
+        record.tileOffsetX = tileset->tileOffsetX;
+        record.tileOffsetY = tileset->tileOffsetY;
+        record.source = AppendBinaryString(&strings, tileset->source);
+        record.name = AppendBinaryString(&strings, tileset->name);
+        record.classString = AppendBinaryString(&strings, tileset->classString);
+        record.imageSource = AppendBinaryString(&strings, tileset->image.source);
+        record.imageWidth = tileset->image.width;
+        record.imageHeight = tileset->image.height;
+
+        char imagePath[260]; /* Max path length on Windows, the bottleneck, is 260 characters */
+        imagePath[0] = '\0';
+        if (tileset->source != NULL) { /* If external, the image is relative to the TSX rather than the TMX */
+            const char* tmxDirectory = GetDirectoryPath2(fileName);
+            record.sourceModTime = (int64_t)GetFileModTime(JoinPath(tmxDirectory, tileset->source));
+            StringCopy(imagePath, tileset->source);
+            char* iterator = imagePath + strlen(imagePath);
+            while (iterator != imagePath && *(iterator - 1) != '/' && *(iterator - 1) != '\\')
+                iterator -= 1;
+            *iterator = '\0'; /* Keep only the TSX's directory, with its trailing slash, if it has one */
+        }
+        StringConcatenate(imagePath, tileset->image.source);
+        record.imagePath = AppendBinaryString(&strings, imagePath);
+        AppendBinaryData(&buffer, &record, sizeof(RaytmxBinaryTileset));
+    }
+
+    /* Object templates, each once. Their values were merged into the objects, so only their times are kept. */
+    AlignBinaryData(&buffer);
+    header.templatesOffset = buffer.length;
+    for (uint32_t i = 0; i < map->layersLength; i++) {
+        if (map->layers[i].type != LAYER_TYPE_OBJECT_GROUP)
+            continue;
+        const TmxObjectGroup* objectGroup = &map->layers[i].exact.objectGroup;
+        for (uint32_t j = 0; j < objectGroup->objectsLength; j++) {
+            const char* templateString = objectGroup->objects[j].templateString;
+            if (templateString == NULL)
+                continue;
+            bool isKnown = false;
+            for (uint32_t k = 0; !isKnown && k < header.templatesLength; k++) {
+                const RaytmxBinaryTemplate* known = (const RaytmxBinaryTemplate*)(buffer.data +
+                    header.templatesOffset) + k;
+                isKnown = strcmp((const char*)strings.data + known->source - 1, templateString) == 0;
+            }
+            if (isKnown)
+                continue;
+            RaytmxBinaryTemplate record;
+            memset(&record, 0, sizeof(RaytmxBinaryTemplate));
+            record.source = AppendBinaryString(&strings, templateString);
+            record.sourceModTime = (int64_t)GetFileModTime(JoinPath(GetDirectoryPath2(fileName), templateString));
+            AppendBinaryData(&buffer, &record, sizeof(RaytmxBinaryTemplate));
+            header.templatesLength += 1;
+        }
+    }
+
+    /* Layer records, filled in below once the offsets of their arrays are known */
+    AlignBinaryData(&buffer);
+    header.layersOffset = buffer.length;
+    AppendBinaryData(&buffer, NULL, sizeof(RaytmxBinaryLayer) * map->layersLength);
+    for (uint32_t i = 0; i < map->layersLength; i++) {
+        const TmxLayer* layer = &map->layers[i];
+        RaytmxBinaryLayer record;
+        memset(&record, 0, sizeof(RaytmxBinaryLayer));
+        record.type = (uint32_t)layer->type;
+        record.id = layer->id;
+        record.name = AppendBinaryString(&strings, layer->name);
+        record.classString = AppendBinaryString(&strings, layer->classString);
+        record.visible = layer->visible;
+        record.tintColor = layer->tintColor;
+        record.hasTintColor = layer->hasTintColor;
+        record.offsetX = layer->offsetX;
+        record.offsetY = layer->offsetY;
+        record.opacity = layer->opacity;
+        record.parallaxX = layer->parallaxX;
+        record.parallaxY = layer->parallaxY;
+
+        AlignBinaryData(&buffer);
+        record.dataOffset = buffer.length;
+        if (layer->type == LAYER_TYPE_TILE_LAYER) {
+            const TmxTileLayer* tileLayer = &layer->exact.tileLayer;
+            record.width = tileLayer->width;
+            record.height = tileLayer->height;
+            record.tilesLength = tileLayer->tilesLength;
+            AppendBinaryData(&buffer, tileLayer->tiles, sizeof(uint32_t) * tileLayer->tilesLength);
+        } else { /* LAYER_TYPE_OBJECT_GROUP */
+            const TmxObjectGroup* objectGroup = &layer->exact.objectGroup;
+            record.color = objectGroup->color;
+            record.hasColor = objectGroup->hasColor;
+            record.drawOrder = (uint32_t)objectGroup->drawOrder;
+            record.objectsLength = objectGroup->objectsLength;
+            AppendBinaryData(&buffer, NULL, sizeof(RaytmxBinaryObject) * objectGroup->objectsLength);
+            for (uint32_t j = 0; j < objectGroup->objectsLength; j++) {
+                const TmxObject* object = &objectGroup->objects[j];
+                RaytmxBinaryObject objectRecord;
+                memset(&objectRecord, 0, sizeof(RaytmxBinaryObject));
+                objectRecord.type = (uint32_t)object->type;
+                objectRecord.id = object->id;
+                objectRecord.name = AppendBinaryString(&strings, object->name);
+                objectRecord.typeString = AppendBinaryString(&strings, object->typeString);
+                objectRecord.gid = object->gid;
+                objectRecord.visible = object->visible;
+                objectRecord.x = object->x;
+                objectRecord.y = object->y;
+                objectRecord.width = object->width;
+                objectRecord.height = object->height;
+                objectRecord.rotation = object->rotation;
+                objectRecord.aabb = object->aabb;
+                if (object->points != NULL) {
+                    AlignBinaryData(&buffer);
+                    objectRecord.pointsOffset = buffer.length;
+                    objectRecord.pointsLength = object->pointsLength;
+                    AppendBinaryData(&buffer, object->points, sizeof(Vector2) * object->pointsLength);
+                }
+                memcpy(buffer.data + record.dataOffset + sizeof(RaytmxBinaryObject) * j, &objectRecord,
+                    sizeof(RaytmxBinaryObject));
+            }
+            if (objectGroup->ySortedObjects != NULL) {
+                AlignBinaryData(&buffer);
+                record.ySortedObjectsOffset = buffer.length;
+                AppendBinaryData(&buffer, objectGroup->ySortedObjects, sizeof(uint32_t) * objectGroup->objectsLength);
+            }
+        }
+        memcpy(buffer.data + header.layersOffset + sizeof(RaytmxBinaryLayer) * i, &record, sizeof(RaytmxBinaryLayer));
+    }
+
+    /* The GID-to-tile table with textures replaced by the index of the tileset they belong to. Textures may still */
+    /* be placeholders awaiting UploadTMXTextures() so the tileset is found by its range of GIDs instead. */
+    AlignBinaryData(&buffer);
+    header.gidsToTilesOffset = buffer.length;
+    for (uint32_t gid = 0; gid < map->gidsToTilesLength; gid++) {
+        const TmxTile* tile = &map->gidsToTiles[gid];
+        RaytmxBinaryTile record;
+        memset(&record, 0, sizeof(RaytmxBinaryTile));
+        record.gid = tile->gid;
+        record.tilesetIndex = -1;
+        for (uint32_t i = 0; tile->gid != 0 && i < map->tilesetsLength; i++) {
+            if (gid >= map->tilesets[i].firstGid && gid <= map->tilesets[i].lastGid) {
+                record.tilesetIndex = (int32_t)i;
+                break;
+            }
+        }
+        record.sourceRect = tile->sourceRect;
+        record.offset = tile->offset;
+        AppendBinaryData(&buffer, &record, sizeof(RaytmxBinaryTile));
+    }
+
+    AlignBinaryData(&buffer);
+    header.stringsOffset = buffer.length;
+    header.stringsLength = (uint32_t)strings.length;
+    AppendBinaryData(&buffer, strings.data, strings.length);
+    memcpy(buffer.data, &header, sizeof(RaytmxBinaryHeader));
+
+    char* binaryFileName = GetBinaryFileName(fileName);
+    bool isSuccess = ReplaceBinaryFile(binaryFileName, buffer.data, buffer.length);
+    if (isSuccess)
+        TraceLog(LOG_INFO, "RAYTMX: Baked \"%s\" into \"%s\" (%u bytes)", fileName, binaryFileName,
+            (unsigned int)buffer.length);
+    else
+        TraceLog(LOG_WARNING, "RAYTMX: Unable to write baked map \"%s\"", binaryFileName);
+
+    MemFree(buffer.data);
+    MemFree(strings.data);
+    return isSuccess;
+}
+
 RAYTMX_DEC void DrawTMX(const TmxMap* map, const Camera2D* camera, int posX, int posY, Color tint) {
     if (map == NULL)
         return;
@@ -1076,11 +1830,48 @@ RAYTMX_DEC void DrawTMX(const TmxMap* map, const Camera2D* camera, int posX, int
     DrawTMXLayers(map, camera, map->layers, map->layersLength, posX, posY, tint);
 }
 
+static uint32_t tmxChunkSize = 0; /* Width and height of render chunks in tiles, or 0 if the cache is disabled */
+static uint32_t tmxChunkDrawCounter = 0; /* Incremented by each DrawTMXLayers() call to tell which chunks are in use */
+static TmxChunkCacheStats tmxChunkStats = { 0 };
+static RaytmxRenderChunk* tmxMostRecentChunk = NULL; /* Ends of the least-recently-used list of resident chunks */
+static RaytmxRenderChunk* tmxLeastRecentChunk = NULL;
+static RaytmxTileBatch* tmxTileBatches = NULL; /* One batch per texture seen so far, reused across frames */
+static uint32_t tmxTileBatchesLength = 0;
+static uint32_t tmxTileBatchesCapacity = 0;
+static uint32_t tmxTileBatchesQueued = 0; /* Number of queued quads across all batches */
+static TmxTileBatchStats tmxTileBatchStats = { 0 };
+
 RAYTMX_DEC void DrawTMXLayers(const TmxMap* map, const Camera2D* camera, const TmxLayer* layers, uint32_t layersLength,
         int posX, int posY, Color tint) {
     if (map == NULL || layers == NULL || layersLength == 0)
         return;
 
+    tmxChunkDrawCounter += 1;
+    tmxChunkStats.drawnChunks = 0;
+    tmxTileBatchStats.submittedQuads = 0;
+    tmxTileBatchStats.submittedBatches = 0;
+    DrawTMXLayerList(map, camera, layers, layersLength, posX, posY, tint);
+    /* Evict only after drawing so that chunks visible this frame are never unloaded and rasterized again */
+    EvictRenderChunks();
+}
+
+RAYTMX_DEC void SetTMXChunkCache(uint32_t chunkSize, size_t budgetBytes) {
+    /* Chunk sets of a different size are rebuilt on their next draw, so only the resident chunks need dropping */
+    if (chunkSize != tmxChunkSize) {
+        while (tmxLeastRecentChunk != NULL)
+            UnloadRenderChunk(tmxLeastRecentChunk);
+    }
+    tmxChunkSize = chunkSize;
+    tmxChunkStats.budgetBytes = budgetBytes;
+    EvictRenderChunks();
+}
+
+RAYTMX_DEC TmxChunkCacheStats GetTMXChunkCacheStats(void) {
+    return tmxChunkStats;
+}
+
+void DrawTMXLayerList(const TmxMap* map, const Camera2D* camera, const TmxLayer* layers, uint32_t layersLength,
+        int posX, int posY, Color tint) {
     for (uint32_t i = 0; i < layersLength; i++) {
         TmxLayer layer = layers[i];
         if (!layers[i].visible) /* If the layer is not visible */
@@ -1113,8 +1904,13 @@ RAYTMX_DEC void DrawTMXLayers(const TmxMap* map, const Camera2D* camera, const T
 
         switch (layer.type) {
         case LAYER_TYPE_TILE_LAYER:
-            DrawTMXTileLayer(map, screenRect, layer, posX + layer.offsetX + parallaxOffsetX,
-                posY + layer.offsetY + parallaxOffsetY, layerTint);
+            /* Layers that move with the camera can be drawn from render chunks. The layer is passed by pointer, */
+            /* casting away 'const', because its chunks are created on first draw. */
+            if (parallaxOffsetX != 0 || parallaxOffsetY != 0 || !DrawTMXTileLayerChunks(map, screenRect,
+                    (TmxLayer*)&layers[i], posX + layer.offsetX, posY + layer.offsetY, layerTint)) {
+                DrawTMXTileLayer(map, screenRect, layer, posX + layer.offsetX + parallaxOffsetX,
+                    posY + layer.offsetY + parallaxOffsetY, layerTint);
+            }
             break;
         case LAYER_TYPE_OBJECT_GROUP:
             DrawTMXObjectGroup(map, screenRect, layer, posX + layer.offsetX + parallaxOffsetX,
@@ -1125,13 +1921,38 @@ RAYTMX_DEC void DrawTMXLayers(const TmxMap* map, const Camera2D* camera, const T
                 posY + layer.offsetY + parallaxOffsetY, layerTint);
         break;
         case LAYER_TYPE_GROUP:
-            DrawTMXLayers(map, camera, layer.layers, layer.layersLength, posX + layer.offsetX + parallaxOffsetX,
+            DrawTMXLayerList(map, camera, layer.layers, layer.layersLength, posX + layer.offsetX + parallaxOffsetX,
                 posY + layer.offsetY + parallaxOffsetY, layerTint);
             break;
         }
     }
 }
 
+RAYTMX_DEC TmxLayer* GetTMXLayer(const TmxMap* map, const char* name) {
+    if (map == NULL || name == NULL || map->layerIndex == NULL)
+        return NULL;
+
+    /* Probe linearly from the slot the name hashes to until the layer or an empty slot is found */
+    uint32_t hash = HashLayerName(name);
+    uint32_t mask = map->layerIndexLength - 1;
+    for (uint32_t slot = hash & mask; map->layerIndex[slot].layer != NULL; slot = (slot + 1) & mask) {
+        const RaytmxLayerIndexEntry* entry = &map->layerIndex[slot];
+        if (entry->hash == hash && strcmp(entry->layer->name, name) == 0)
+            return entry->layer;
+    }
+
+    return NULL;
+}
+
+RAYTMX_DEC uint32_t GetTMXLayersWithRole(const TmxMap* map, uint32_t roles, TmxLayer** outputLayers,
+        uint32_t outputLength) {
+    if (map == NULL || roles == LAYER_ROLE_NONE)
+        return 0;
+
+    return GatherLayersWithRole(map->layers, map->layersLength, roles, outputLayers,
+        outputLayers != NULL ? outputLength : 0, 0);
+}
+
 RAYTMX_DEC void AnimateTMX(TmxMap* map) {
     if (map == NULL)
         return;
@@ -1324,6 +2145,16 @@ RAYTMX_DEC bool CheckCollisionTMXObjectGroupRec(TmxObjectGroup group, Rectangle
     return CheckCollisionTMXObjectGroupObject(group, CreateRectangularTMXObject(rec), outputObject);
 }
 
+RAYTMX_DEC uint32_t CheckCollisionTMXObjectGroupRecAll(TmxObjectGroup group, Rectangle rec, TmxObject* outputObjects,
+        uint32_t outputLength) {
+    if (group.objectsLength == 0 || rec.width < 0.0f || rec.height < 0.0f)
+        return 0; /* Early-out opportunity. These cases would always return zero. */
+
+    /* Collect every object in the group that collides with the rectangle */
+    return CheckCollisionTMXObjectGroupObjects(group, CreateRectangularTMXObject(rec), outputObjects,
+        outputObjects != NULL ? outputLength : 0, NULL);
+}
+
 RAYTMX_DEC bool CheckCollisionTMXObjectGroupCircle(TmxObjectGroup group, Vector2 center, float radius,
         TmxObject* outputObject) {
     if (group.objectsLength == 0 || radius < 0.0f)
@@ -1404,10 +2235,11 @@ RAYTMX_DEC void SetTraceLogFlagsTMX(int logFlags) {
 /**********************************************************************************************************************/
 /* Private implementation.                                                                                            */
 
-RaytmxExternalTileset LoadTSX(const char* fileName) {
+RaytmxExternalTileset LoadTSX(const char* fileName, bool isTextureUploadDeferred) {
     RaytmxState raytmxState[1];
     memset(raytmxState, 0, sizeof(RaytmxState)); /* Initialize all values to zero, NULL, or an equivalent enum value */
     raytmxState->format = FORMAT_TSX;
+    raytmxState->isTextureUploadDeferred = isTextureUploadDeferred;
 
     /* Initialize an external tileset object */
     RaytmxExternalTileset externalTileset;
@@ -1416,8 +2248,10 @@ RaytmxExternalTileset LoadTSX(const char* fileName) {
     /* Do format-agnostic parsing of the document. The state object will be populated with raytmx's models of the */
     /* equivalent TMX, TSX, and/or TX elements. */
     ParseDocument(raytmxState, fileName);
-    if (!raytmxState->isSuccess)
+    if (!raytmxState->isSuccess) {
+        FreeState(raytmxState);
         return externalTileset; /* Will have 'isSuccess' set to false to indicate a failure */
+    }
 
     if (raytmxState->tilesetsRoot != NULL) { /* If there is at least one tileset */
         /* Copy the root tileset so it can be returned */
@@ -1438,10 +2272,11 @@ RaytmxExternalTileset LoadTSX(const char* fileName) {
     return externalTileset;
 }
 
-RaytmxObjectTemplate LoadTX(const char* fileName) {
+RaytmxObjectTemplate LoadTX(const char* fileName, bool isTextureUploadDeferred) {
     RaytmxState raytmxState[1];
     memset(raytmxState, 0, sizeof(RaytmxState)); /* Initialize all values to zero, NULL, or an equivalent enum value */
     raytmxState->format = FORMAT_TX;
+    raytmxState->isTextureUploadDeferred = isTextureUploadDeferred;
 
     /* Initialize an object template object */
     RaytmxObjectTemplate objectTemplate;
@@ -1450,8 +2285,10 @@ RaytmxObjectTemplate LoadTX(const char* fileName) {
     /* Do format-agnostic parsing of the document. The state object will be populated with raytmx's models of the */
     /* equivalent TMX, TSX, and/or TX elements. */
     ParseDocument(raytmxState, fileName);
-    if (!raytmxState->isSuccess)
+    if (!raytmxState->isSuccess) {
+        FreeState(raytmxState);
         return objectTemplate; /* Will have 'isSuccess' set to false to indicate a failure */
+    }
 
     if (raytmxState->objectsRoot != NULL) { /* If there is at least one object */
         /* Copy the root object so it can be returned */
@@ -1753,7 +2590,7 @@ void HandleAttribute(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                 StringCopy(raytmxState->tileset->source, hoxmlContext->value);
                 /* 'source' points to an external TSX file that defines the majority of the tileset. Try to load it. */
                 RaytmxExternalTileset externalTileset = LoadTSX(JoinPath(raytmxState->documentDirectory,
-                    hoxmlContext->value));
+                    hoxmlContext->value), raytmxState->isTextureUploadDeferred);
                 if (externalTileset.isSuccess) {
                     /* A <tileset> within a <map> will have two attributes: 'firstgid' and 'source.' The rest of */
                     /* the tileset's details are in the external TSX that 'source' points to. They need to be merged. */
@@ -1823,8 +2660,10 @@ void HandleAttribute(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                 raytmxState->image->source = (char*)MemAllocZero((unsigned int)strlen(hoxmlContext->value) + 1);
                 StringCopy(raytmxState->image->source, hoxmlContext->value);
                 RaytmxCachedTextureNode* cachedTexture = LoadCachedTexture(raytmxState, hoxmlContext->value);
-                if (cachedTexture != NULL)
+                if (cachedTexture != NULL) {
                      raytmxState->image->texture = cachedTexture->texture;
+                     raytmxState->image->pendingImage = cachedTexture->image;
+                }
             } else if (strcmp(hoxmlContext->attribute, "trans") == 0) {
                 raytmxState->image->trans = GetColorFromHexString(hoxmlContext->value);
                 raytmxState->image->hasTrans = true;
@@ -1975,7 +2814,8 @@ void HandleAttribute(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                 StringCopyN(y, iterator, terminator - iterator); /* Copy 'iterator' up to but excluding 'terminator' */
                 y[terminator - iterator] = '\0';
                 /* Create a linked list node to hold the point and append it to the linked list */
-                RaytmxPolyPointNode* node = (RaytmxPolyPointNode*)MemAllocZero(sizeof(RaytmxPolyPointNode));
+                RaytmxPolyPointNode* node = (RaytmxPolyPointNode*)ArenaAllocZero(raytmxState,
+                    sizeof(RaytmxPolyPointNode));
                 /* Note: These values may be negative. A poly(gon|line) object's position is determined by the first */
                 /* vertex added leading to the first entry to be "0,0" and all other vertices relative to it. */
                 node->point.x = (float)atof(x);
@@ -2010,15 +2850,13 @@ void HandleAttribute(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                     points[0].x = vertexSum.x / (pointsLength - 2);
                     points[0].y = vertexSum.y / (pointsLength - 2);
                 }
-                /* Copy the points as Vector2s into the array and free the nodes while we're at it */
+                /* Copy the points as Vector2s into the array. The nodes belong to the arena and are freed with it. */
                 RaytmxPolyPointNode* iteratorNode = pointsRoot;
                 uint32_t i = isPolygon ? 1 : 0; /* Skip over the first element, the centroid, for polygons only */
                 while (iteratorNode != NULL) {
                     points[i] = iteratorNode->point;
-                    RaytmxPolyPointNode* parent = iteratorNode;
                     iteratorNode = iteratorNode->next;
                     i += 1;
-                    MemFree(parent);
                 }
                 /* End the list with the first point. Both polygons and polylines use this when drawing. */
                 points[pointsLength - 1].x = points[isPolygon ? 1 : 0].x;
@@ -2152,13 +2990,11 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
             return;
         /* Allocate the array and assign NULL to every index to be safe */
         TmxProperty* properties = (TmxProperty*)MemAllocZero(sizeof(TmxProperty) * raytmxState->propertiesLength);
-        /* Copy the TmxProperty pointers into the array and free the nodes while we're at it */
+        /* Copy the TmxProperty pointers into the array. The nodes belong to the arena and are freed with it. */
         RaytmxPropertyNode* iterator = raytmxState->propertiesRoot;
         for (uint32_t i = 0; i < raytmxState->propertiesLength; i++) {
             properties[i] = iterator->property;
-            RaytmxPropertyNode* parent = iterator;
             iterator = iterator->next;
-            MemFree(parent);
         }
         /* Add the properties array to the element it applies to */
         /* A <property>, or rather its parent <properties>, can be within 10+ other elements. The order of the checks */
@@ -2285,13 +3121,11 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                 /* Allocate the array and zeroize every index as initialization */
                 TmxTilesetTile* tiles = (TmxTilesetTile*)MemAllocZero(sizeof(TmxTilesetTile) *
                     raytmxState->tilesetTilesLength);
-                /* Copy the TmxTilesetTile pointers into the array and free the nodes while we're at it */
+                /* Copy the TmxTilesetTile pointers into the array. The nodes are freed along with the arena. */
                 RaytmxTilesetTileNode* iterator = raytmxState->tilesetTilesRoot;
                 for (uint32_t i = 0; i < raytmxState->tilesetTilesLength; i++) {
                     tiles[i] = iterator->tile;
-                    RaytmxTilesetTileNode* parent = iterator;
                     iterator = iterator->next;
-                    MemFree(parent);
                 }
                 /* Add the tiles array to the tileset */
                 raytmxState->tileset->tiles = tiles;
@@ -2313,13 +3147,11 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
             /* Allocate the array and zeroize every index as initialization */
             TmxAnimationFrame* frames = (TmxAnimationFrame*)MemAllocZero(sizeof(TmxAnimationFrame) *
                 raytmxState->animationFramesLength);
-            /* Copy the TmxAnimationFrame pointers into the array and free the nodes while we're at it */
+            /* Copy the TmxAnimationFrame pointers into the array. The nodes are freed along with the arena. */
             RaytmxAnimationFrameNode* iterator = raytmxState->animationFramesRoot;
             for (uint32_t i = 0; i < raytmxState->animationFramesLength; i++) {
                 frames[i] = iterator->frame;
-                RaytmxAnimationFrameNode* parent = iterator;
                 iterator = iterator->next;
-                MemFree(parent);
             }
             /* Add the frames array to the tile's animation */
             raytmxState->tilesetTile->animation.frames = frames;
@@ -2333,37 +3165,17 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
     else if (strcmp(hoxmlContext->tag, "frame") == 0)
         raytmxState->animationFrame = NULL;
     else if (strcmp(hoxmlContext->tag, "layer") == 0) {
-        if (raytmxState->tileLayer != NULL) {
+        if (raytmxState->tileLayer != NULL && raytmxState->layerTiles != NULL) {
             /* If there were 1+ <tile>s within this <layer> but this <layer> already has tiles (from a <data>?) */
-            if (raytmxState->layerTilesRoot != NULL && raytmxState->tileLayer->tiles != NULL) {
+            if (raytmxState->tileLayer->tiles != NULL) {
                 TraceLog(LOG_WARNING, "RAYTMX: layer \"%s\" has more than one source of tile data - the latter tiles "
                     "for this layer will be dropped", raytmxState->layer->name);
-                /* Free the nodes and tiles therein */
-                RaytmxTileLayerTileNode* iterator = raytmxState->layerTilesRoot;
-                while (iterator != NULL) {
-                    RaytmxTileLayerTileNode* parent = iterator;
-                    iterator = iterator->next;
-                    MemFree(parent);
-                }
-            } else {
-                /* Allocate the array and zeroize every index as initialization */
-                uint32_t* tiles = (uint32_t*)MemAllocZero(sizeof(uint32_t) * raytmxState->layerTilesLength);
-                /* Copy the GID into the array and free the nodes while we're at it */
-                RaytmxTileLayerTileNode* iterator = raytmxState->layerTilesRoot;
-                for (uint32_t i = 0; i < raytmxState->layerTilesLength; i++) {
-                    tiles[i] = iterator->gid;
-                    RaytmxTileLayerTileNode* parent = iterator;
-                    iterator = iterator->next;
-                    MemFree(parent);
-                }
-                /* Add the tiles array to the tile layer */
-                raytmxState->tileLayer->tiles = tiles;
-                raytmxState->tileLayer->tilesLength = raytmxState->layerTilesLength;
-            }
-            /* Clean up the state object */
-            raytmxState->layerTilesRoot = NULL;
-            raytmxState->layerTilesTail = NULL;
-            raytmxState->layerTilesLength = 0;
+                MemFree(raytmxState->layerTiles);
+                raytmxState->layerTiles = NULL;
+                raytmxState->layerTilesLength = 0;
+                raytmxState->layerTilesCapacity = 0;
+            } else
+                TakeTileLayerTiles(raytmxState); /* Hand the array of GIDs to the tile layer as-is */
         }
         raytmxState->tileLayer = NULL;
         raytmxState->layer = NULL;
@@ -2389,7 +3201,6 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
             TraceLog(LOG_WARNING, "RAYTMX: layer \"%s\" has more than one source of tile data - the latter tiles for "
                 "this layer will be dropped", raytmxState->layer->name);
         } else if (raytmxState->tileLayer != NULL && raytmxState->tileLayer->encoding != NULL) {
-            RaytmxTileLayerTileNode* tiles = NULL;
             if (strcmp(raytmxState->tileLayer->encoding, "base64") == 0) {
                 /* The layer's data is a series of unsigned, 32-bit integers encoded as a Base64 string. But, XML */
                 /* considers everything between <data> and </data> to be content meaning there is probably some */
@@ -2408,6 +3219,7 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                     if (raytmxState->tileLayer->compression == NULL) { /* If the Base64-encoded data is uncompressed */
                         /* Iterate through N bytes ('decodedLength') with every four bytes being a single GID */
                         /* resulting in N / 4 tiles */
+                        ReserveTileLayerTiles(raytmxState, (uint32_t)decodedLength / 4);
                         uint32_t* iterator = (uint32_t*)decoded;
                         for (int i = 0; i < decodedLength / 4; i++) {
                             AddTileLayerTile(raytmxState, *iterator);
@@ -2452,6 +3264,7 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                                 unsigned char* decompressed = DecompressData(postHeaderDecoded, decodedLength,
                                     &decompressedLength);
                                 if (decompressed != NULL && decompressedLength > 0) {
+                                    ReserveTileLayerTiles(raytmxState, (uint32_t)decompressedLength / 4);
                                     uint32_t* iterator = (uint32_t*)decompressed;
                                     for (int i = 0; i < decompressedLength / 4; i++) {
                                         AddTileLayerTile(raytmxState, *iterator);
@@ -2478,42 +3291,13 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
             } /* strcmp(raytmxState->tileLayer->encoding, "base64") == 0 */
             else if (strcmp(raytmxState->tileLayer->encoding, "csv") == 0) {
                 /* The Comma-Separated Value (CSV) list herein is a series of Global IDs (GIDs) of tiles in the form */
-                /* "31,32,33" where 31, 32, and 33 are GIDs */
-                char valueAsString[16]; /* Needs to fit all digits of a single value - should be more than enough */
-                char* iterator = hoxmlContext->content;
-                while (*iterator != '\0') { /* While not pointing to the end of the end of the string */
-                    memset(valueAsString, '\0', 16); /* Reset the value-as-a-string buffer with all zeroes */
-                    /* Copy each character into the buffer until either a comma or the terminator is reached */
-                    for (int i = 0; *iterator != ',' && *iterator != '\0'; i++) {
-                        valueAsString[i] = *iterator;
-                        iterator++;
-                    }
-                    if (*iterator == ',') /* If iteration was paused by a comma */
-                        iterator++; /* Advance one character so the comma isn't parsed with the value next iteration */
-                    AddTileLayerTile(raytmxState, atoi(valueAsString)); /* Read the value as an integer GID */
-                }
+                /* "31,32,33" where 31, 32, and 33 are GIDs. There is one value per cell of the layer. */
+                ReserveTileLayerTiles(raytmxState, raytmxState->tileLayer->width * raytmxState->tileLayer->height);
+                DecodeCsvTileLayerTiles(raytmxState, hoxmlContext->content, strlen(hoxmlContext->content));
             } /* strcmp(raytmxState->tileLayer->encoding, "csv") == 0 */
 
-            if (tiles != NULL) { /* If there was no error in parsing the data and there's a linked list of tiles */
-                /* Allocate the array and assign 0 to every index to be safe */
-                uint32_t* tiles = (uint32_t*)MemAlloc(sizeof(uint32_t) * raytmxState->layerTilesLength);
-                memset(tiles, 0, sizeof(uint32_t) * raytmxState->layerTilesLength);
-                /* Copy the GIDs into the array and free the nodes while we're at it */
-                RaytmxTileLayerTileNode* layerTilesIterator = raytmxState->layerTilesRoot;
-                for (uint32_t i = 0; i < raytmxState->layerTilesLength; i++) {
-                    tiles[i] = layerTilesIterator->gid;
-                    RaytmxTileLayerTileNode* layerTilesTemp = layerTilesIterator;
-                    layerTilesIterator = layerTilesIterator->next;
-                    MemFree(layerTilesTemp);
-                }
-                /* Add the tiles array to the element it applies to */
-                raytmxState->tileLayer->tiles = tiles;
-                raytmxState->tileLayer->tilesLength = raytmxState->layerTilesLength;
-                /* Clean up the state object */
-                raytmxState->layerTilesRoot = NULL;
-                raytmxState->layerTilesTail = NULL;
-                raytmxState->layerTilesLength = 0;
-            }
+            if (raytmxState->layerTiles != NULL) /* If there was no error in parsing the data and there are tiles */
+                TakeTileLayerTiles(raytmxState); /* Hand the array of GIDs to the tile layer as-is */
         } /* raytmxState->tileLayer != NULL && raytmxState->tileLayer->encoding != NULL */
     } /* strcmp(hoxmlContext->tag, "data") == 0 */
     else if (strcmp(hoxmlContext->tag, "objectgroup") == 0) {
@@ -2523,14 +3307,14 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
             /* Allocate the arrays and zeroize every index as initialization */
             TmxObject* objects = (TmxObject*)MemAllocZero(sizeof(TmxObject) * raytmxState->objectsLength);
             uint32_t* ySortedObjects = (uint32_t*)MemAllocZero(sizeof(uint32_t) * raytmxState->objectsLength);
-            /* Create a contiguous array of TmxObjects, create a sorted linked list of indexes within that array of */
-            /* TmxObjects (sorted by ascending y-coordinate), and free the object linked list */
-            RaytmxObjectNode *objectsIterator = raytmxState->objectsRoot, *objectsTemp;
-            RaytmxObjectSortingNode *sortingRoot = NULL, *sortingIterator, *sortingTemp, *newSortingNode;
+            /* Create a contiguous array of TmxObjects and a sorted linked list of indexes within that array of */
+            /* TmxObjects (sorted by ascending y-coordinate). Both lists' nodes are freed along with the arena. */
+            RaytmxObjectNode* objectsIterator = raytmxState->objectsRoot;
+            RaytmxObjectSortingNode *sortingRoot = NULL, *sortingIterator, *newSortingNode;
             for (uint32_t i = 0; objectsIterator != NULL; i++) {
                 objects[i] = objectsIterator->object;
                 /* Add a new node into the sorted list */
-                newSortingNode = (RaytmxObjectSortingNode*)MemAllocZero(sizeof(RaytmxObjectSortingNode));
+                newSortingNode = (RaytmxObjectSortingNode*)ArenaAllocZero(raytmxState, sizeof(RaytmxObjectSortingNode));
                 newSortingNode->y = objects[i].y;
                 newSortingNode->index = i;
                 if (sortingRoot == NULL) /* If this is the first node */
@@ -2545,19 +3329,14 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                     newSortingNode->next = sortingIterator->next;
                     sortingIterator->next = newSortingNode;
                 }
-                /* Free the object node */
-                objectsTemp = objectsIterator;
                 objectsIterator = objectsIterator->next;
-                MemFree(objectsTemp);
             }
             /* Create a contiguous array from the sorted linked list such that index 0 of this array points to the */
             /* TmxObject (via its index in 'objects') with the lowest (visually, highest) y-coordinate */
             sortingIterator = sortingRoot;
             for (uint32_t i = 0; sortingIterator != NULL; i++) {
                 ySortedObjects[i] = sortingIterator->index;
-                sortingTemp = sortingIterator;
                 sortingIterator = sortingIterator->next;
-                MemFree(sortingTemp);
             }
             /* Add the objects and ySortedObjects array to the object layer */
             raytmxState->objectGroup->objects = objects;
@@ -2642,7 +3421,7 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                             uint32_t propertiesLength = 0;
                             /* Add the properties from the instanced <object> */
                             for (uint32_t i = 0; i < raytmxState->object->propertiesLength; i++) {
-                                node = (RaytmxPropertyNode*)MemAllocZero(sizeof(RaytmxPropertyNode));
+                                node = (RaytmxPropertyNode*)ArenaAllocZero(raytmxState, sizeof(RaytmxPropertyNode));
                                 node->property = raytmxState->object->properties[i];
                                 if (propertiesRoot == NULL)
                                     propertiesRoot = node;
@@ -2664,7 +3443,7 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                                     propertiesIterator = propertiesIterator->next;
                                 }
                                 if (isNew) {
-                                    node = (RaytmxPropertyNode*)MemAllocZero(sizeof(RaytmxPropertyNode));
+                                    node = (RaytmxPropertyNode*)ArenaAllocZero(raytmxState, sizeof(RaytmxPropertyNode));
                                     node->property = objectTemplate.object.properties[i];
                                     if (propertiesRoot == NULL)
                                         propertiesRoot = node;
@@ -2680,13 +3459,11 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                             raytmxState->object->properties =
                                 (TmxProperty*)MemAllocZero(sizeof(TmxProperty) * propertiesLength);
                             raytmxState->object->propertiesLength = propertiesLength;
-                            /* Copy the TmxProperty entires into the array and free the nodes while we're at it */
+                            /* Copy the TmxProperty entires into the array. The nodes are freed along with the arena. */
                             RaytmxPropertyNode* propertiesIterator = propertiesRoot;
                             for (uint32_t i = 0; propertiesIterator != NULL; i++) {
                                 raytmxState->object->properties[i] = propertiesIterator->property;
-                                RaytmxPropertyNode* propertiesTemp = propertiesIterator;
                                 propertiesIterator = propertiesIterator->next;
-                                MemFree(propertiesTemp);
                             }
                         }
                     }
@@ -2851,7 +3628,8 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                         line.spacing = spacing;
                         /* Note: The number of lines is not yet known but needs to be for Y positioning */
 
-                        RaytmxTextLineNode* node = (RaytmxTextLineNode*)MemAllocZero(sizeof(RaytmxTextLineNode));
+                        RaytmxTextLineNode* node = (RaytmxTextLineNode*)ArenaAllocZero(raytmxState,
+                            sizeof(RaytmxTextLineNode));
                         node->line = line;
                         if (linesRoot == NULL)
                             linesRoot = node;
@@ -2882,7 +3660,7 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                 if (linesRoot != NULL) {
                     /* Allocate the array and zero out every value as initialization */
                     TmxTextLine* lines = (TmxTextLine*)MemAllocZero(sizeof(TmxTextLine) * linesLength);
-                    /* Copy the TmxTextLines into the array and free the nodes while we're at it */
+                    /* Copy the TmxTextLines into the array. The nodes are freed along with the arena. */
                     RaytmxTextLineNode* iterator = linesRoot;
                     for (uint32_t i = 0; i < linesLength; i++) {
                         lines[i] = iterator->line;
@@ -2958,9 +3736,7 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
                         } else /* if (objectText->valign == VERTICAL_ALIGNMENT_TOP) */
                             lines[i].position.y = (float)object->y + (float)(objectText->pixelSize * i);
 
-                        RaytmxTextLineNode* parent = iterator;
                         iterator = iterator->next;
-                        MemFree(parent);
                     }
                     /* Add the lines array to the text object */
                     objectText->lines = lines;
@@ -2979,18 +3755,6 @@ void HandleElementEnd(RaytmxState* raytmxState, hoxml_context_t* hoxmlContext) {
     }
 }
 
-void FreeStateLayers(RaytmxLayerNode* layers) {
-    RaytmxLayerNode *layersIterator = layers, *layersTemp;
-    while (layersIterator != NULL) {
-        /* Group layers may have children, forming a tree-like structure. Free the children. */
-        FreeStateLayers(layersIterator->childrenRoot);
-        /* Iterate to the next node and free this one */
-        layersTemp = layersIterator;
-        layersIterator = layersIterator->next;
-        MemFree(layersTemp);
-    }
-}
-
 void FreeState(RaytmxState* raytmxState) {
     if (raytmxState == NULL)
         return;
@@ -3030,85 +3794,36 @@ void FreeState(RaytmxState* raytmxState) {
     raytmxState->imageLayer = NULL;
     raytmxState->object = NULL;
 
-    /* Free each property in the linked list of properties */
-    RaytmxPropertyNode *propertiesIterator = raytmxState->propertiesRoot, *propertiesTemp;
-    while (propertiesIterator != NULL) {
-        propertiesTemp = propertiesIterator;
-        propertiesIterator = propertiesIterator->next;
-        MemFree(propertiesTemp);
-    }
-    /* Zeroize this linked list's properties */
+    /* Every node of every linked list (properties, tilesets, tileset tiles, animation frames, layers, objects, */
+    /* etc.) was allocated from the arena so they are all released here in one shot */
+    FreeArena(raytmxState);
+    /* Zeroize the linked lists' properties */
     raytmxState->propertiesRoot = NULL;
     raytmxState->propertiesTail = NULL;
     raytmxState->propertiesLength = 0;
-
-    /* Free each node in the linked list of tilesets */
-    RaytmxTilesetNode *tilesetsIterator = raytmxState->tilesetsRoot, *tilesetsTemp;
-    while (tilesetsIterator != NULL) {
-        tilesetsTemp = tilesetsIterator;
-        tilesetsIterator = tilesetsIterator->next;
-        MemFree(tilesetsTemp);
-    }
-    /* Zeroize this linked list's properties */
     raytmxState->tilesetsRoot = NULL;
     raytmxState->tilesetsTail = NULL;
     raytmxState->tilesetsLength = 0;
-
-    /* Free each node in the linked list of tileset tiles */
-    RaytmxTilesetTileNode *tilesetTilesIterator = raytmxState->tilesetTilesRoot, *tilesetTilesTemp;
-    while (tilesetTilesIterator != NULL) {
-        tilesetTilesTemp = tilesetTilesIterator;
-        tilesetTilesIterator = tilesetTilesIterator->next;
-        MemFree(tilesetTilesTemp);
-    }
-    /* Zeroize this linked list's properties */
     raytmxState->tilesetTilesRoot = NULL;
     raytmxState->tilesetTilesTail = NULL;
     raytmxState->tilesetTilesLength = 0;
-
-    /* Free each node in the linked list of animation frames */
-    RaytmxAnimationFrameNode *animationFramesIterator = raytmxState->animationFramesRoot, *animationFramesTemp;
-    while (animationFramesIterator != NULL) {
-        animationFramesTemp = animationFramesIterator;
-        animationFramesIterator = animationFramesIterator->next;
-        MemFree(animationFramesTemp);
-    }
-    /* Zeroize this linked list's properties */
     raytmxState->animationFramesRoot = NULL;
     raytmxState->animationFramesTail = NULL;
     raytmxState->animationFramesLength = 0;
-
-    /* Layers may be groups. The resulting collection isn't a link list as much as it is a tree. So freeing layers is */
-    /* best done with a recursive approach. */
-    FreeStateLayers(raytmxState->layersRoot);
-    /* Zeroize this linked list's properties */
     raytmxState->layersRoot = NULL;
     raytmxState->layersTail = NULL;
+    raytmxState->groupNode = NULL;
     raytmxState->layersLength = 0;
-
-    /* Free each node in the linked list of layer tiles */
-    RaytmxTileLayerTileNode *layerTilesIterator = raytmxState->layerTilesRoot, *layerTilesTemp;
-    while (layerTilesIterator != NULL) {
-        layerTilesTemp = layerTilesIterator;
-        layerTilesIterator = layerTilesIterator->next;
-        MemFree(layerTilesTemp);
-    }
-    /* Zeroize this linked list's properties */
-    raytmxState->layerTilesRoot = NULL;
-    raytmxState->layerTilesTail = NULL;
-    raytmxState->layerTilesLength = 0;
-
-    /* Free each node in the linked list of objects */
-    RaytmxObjectNode *objectsIterator = raytmxState->objectsRoot, *objectsTemp;
-    while (objectsIterator != NULL) {
-        objectsTemp = objectsIterator;
-        objectsIterator = objectsIterator->next;
-        MemFree(objectsTemp);
-    }
-    /* Zeroize this linked list's properties */
     raytmxState->objectsRoot = NULL;
     raytmxState->objectsTail = NULL;
     raytmxState->objectsLength = 0;
+
+    /* Free the GIDs of a tile layer that were parsed but never handed to a layer (e.g. due to a parsing error) */
+    if (raytmxState->layerTiles != NULL)
+        MemFree(raytmxState->layerTiles);
+    raytmxState->layerTiles = NULL;
+    raytmxState->layerTilesLength = 0;
+    raytmxState->layerTilesCapacity = 0;
 }
 
 void inline FreeString(char* str) {
@@ -3163,11 +3878,17 @@ void FreeLayer(TmxLayer layer) {
         FreeString(layer.exact.tileLayer.encoding);
         FreeString(layer.exact.tileLayer.compression);
         MemFree(layer.exact.tileLayer.tiles);
+        MemFree(layer.exact.tileLayer.runs);
+        MemFree(layer.exact.tileLayer.rowRuns);
+        FreeRenderChunkSet(layer.exact.tileLayer.renderChunks);
     break;
     case LAYER_TYPE_OBJECT_GROUP:
         for (uint32_t j = 0; j < layer.exact.objectGroup.objectsLength; j++)
             FreeObject(layer.exact.objectGroup.objects[j]);
         MemFree(layer.exact.objectGroup.objects);
+        MemFree(layer.exact.objectGroup.ySortedObjects);
+        MemFree(layer.exact.objectGroup.bvh);
+        MemFree(layer.exact.objectGroup.bvhObjects);
     break;
     case LAYER_TYPE_IMAGE_LAYER:
         if (layer.exact.imageLayer.hasImage)
@@ -3196,163 +3917,1241 @@ void FreeObject(TmxObject object) {
     } /* object.text != NULL */
 }
 
-#define SIGN(x) (x < 0 ? -1 : +1)
+bool IsTMXBinarySupported(const TmxMap* map) {
+    /* The binary format covers what maps typically need to be drawn and collided with: image-based tilesets, and */
+    /* top-level tile layers and object groups. Anything else is left to the TMX document. */
+    const char* reason = NULL;
+    if (map->propertiesLength > 0)
+        reason = "map properties";
+    for (uint32_t i = 0; reason == NULL && i < map->tilesetsLength; i++) {
+        const TmxTileset* tileset = &map->tilesets[i];
+        if (!tileset->hasImage)
+            reason = "image collection tilesets";
+        else if (tileset->tilesLength > 0)
+            reason = "explicitly-defined tileset tiles";
+        else if (tileset->propertiesLength > 0)
+            reason = "tileset properties";
+    }
+    for (uint32_t i = 0; reason == NULL && i < map->layersLength; i++) {
+        const TmxLayer* layer = &map->layers[i];
+        if (layer->type == LAYER_TYPE_IMAGE_LAYER || layer->type == LAYER_TYPE_GROUP)
+            reason = "image and group layers";
+        else if (layer->propertiesLength > 0)
+            reason = "layer properties";
+        else if (layer->type == LAYER_TYPE_OBJECT_GROUP) {
+            for (uint32_t j = 0; reason == NULL && j < layer->exact.objectGroup.objectsLength; j++) {
+                const TmxObject* object = &layer->exact.objectGroup.objects[j];
+                if (object->type == OBJECT_TYPE_TEXT)
+                    reason = "text objects";
+                else if (object->propertiesLength > 0)
+                    reason = "object properties";
+            }
+        }
+    }
 
-/**
- * Helper function that keeps an integer within the given range.
- * Note: A function named Clamp() exists in raylib but uses floats, hence Clampi().
- * 
- * @param value The preferred value that will be used as long as it is between the minimum and maximum values.
- * @param minimum The smallest acceptable value, inclusive.
- * @param maximum The largest acceptable value, inclusive.
- * @return The preferred value if within the range or the nearest acceptable value.
- */
-int Clampi(int value, int minimum, int maximum) {
-    if (value < minimum)
-        return minimum;
-    else if (value > maximum)
-        return maximum;
-    return value;
+    if (reason != NULL)
+        TraceLog(LOG_INFO, "RAYTMX: Map \"%s\" is not baked because the binary format doesn't support %s",
+            map->fileName, reason);
+    return reason == NULL;
 }
 
-/**
- * Scary-looking helper function that does something kind of simple: iterates through the tiles of the given tile layer
- * overlapping with the given screen rectangle, one tile per call. This function returns true while iteration is still
- * ongoing and false when done. This allows the function to be used e.g. "while (IterateTileLayer( { ...} ))". Details
- * of the current tile are returned to the caller with output parameters. Iteration is done row-by-row.
- *
- * @param map A loaded map model containing the given tile layer.
- * @param layer The tile layer within the given map whose tiles will be iterated.
- * @param screenRect A rectangle representing the screen. This could also be considered a search area.
- * @param rawGid Optional output. The Global ID (GID) with possible flip flags. Pass NULL if not wanted.
- * @param tile Optional output. Metadata of the current tile. Pass NULL if not wanted.
- * @param tileRect Optional output. The destination rectangle, in pixels, of the current tile. Pass NULL if not wanted.
- * @return True if the next tile is being provided via the output parameters, or false if iteration is done.
- */
-bool IterateTileLayer(const TmxMap* map, const TmxTileLayer* layer, Rectangle screenRect, uint32_t* rawGid,
-        TmxTile* tile, Rectangle* tileRect) {
-    /* Static variables whose values will persist between calls. These are needed to initialize and iterate. */
-    static const TmxTileLayer* currentLayer = NULL; /* Tile layer being iterated */
-    static int fromX = 0; /* Initial X position, tile not pixel, that row-by-row iteration begins at */
-    static int fromY = 0; /* Initial Y position, tile not pixel, that row-by-row iteration begins at */
-    static int toX = 0; /* Final X position, tile not pixel, that iteration ends at */
-    static int toY = 0; /* Final Y position, tile not pixel, that iteration ends at */
-    static int currentX = 0; /* Current tile X position (column) within the iteration */
-    static int currentY = 0; /* Current tile Y position (row) within the iteration */
-
-    if (map == NULL || map->width == 0 || map->height == 0 || map->tileWidth == 0 || map->tileHeight == 0 ||
-            layer == NULL || layer->tilesLength == 0)
-        return false;
+TmxMap* LoadBakedTMX(const char* fileName, const unsigned char* data, size_t length, bool isTextureUploadDeferred) {
+    /* Validate the header and that every array it references lies within the file */
+    if (length < sizeof(RaytmxBinaryHeader))
+        return NULL;
+    const RaytmxBinaryHeader* header = (const RaytmxBinaryHeader*)data;
+    if (header->magic != RAYTMX_BINARY_MAGIC || header->version != RAYTMX_BINARY_VERSION)
+        return NULL;
+    if (!IsBinaryRangeValid(length, header->tilesetsOffset, header->tilesetsLength, sizeof(RaytmxBinaryTileset)) ||
+            !IsBinaryRangeValid(length, header->templatesOffset, header->templatesLength,
+                sizeof(RaytmxBinaryTemplate)) ||
+            !IsBinaryRangeValid(length, header->layersOffset, header->layersLength, sizeof(RaytmxBinaryLayer)) ||
+            !IsBinaryRangeValid(length, header->gidsToTilesOffset, header->gidsToTilesLength,
+                sizeof(RaytmxBinaryTile)) ||
+            !IsBinaryRangeValid(length, header->stringsOffset, header->stringsLength, 1) ||
+            header->stringsLength == 0 || data[header->stringsOffset + header->stringsLength - 1] != '\0')
+        return NULL;
 
-    if (currentLayer != layer) { /* If the layer has changed (i.e. iteration should initialize) */
-        currentLayer = layer; /* Remember this layer */
-        switch (map->renderOrder) {
-        case RENDER_ORDER_RIGHT_DOWN:
-            /* Start at the top-left, iterate right, then iterate down, ending at the bottom-right. */
-            /* In other words, this is the order in which English is read. */
-            fromX = (int)screenRect.x / (int)map->tileWidth;
-            fromY = (int)screenRect.y / (int)map->tileHeight;
-            toX = (int)(screenRect.x + screenRect.width) / (int)map->tileWidth;
-            toY = (int)(screenRect.y + screenRect.height) / (int)map->tileHeight;
-        break;
-        case RENDER_ORDER_RIGHT_UP:
-            /* Start at the bottom-left, iterate right, then iterate up, ending at the top-right */
-            fromX = (int)screenRect.x / (int)map->tileWidth;
-            fromY = (int)(screenRect.y + screenRect.height) / (int)map->tileHeight;
-            toX = (int)(screenRect.x + screenRect.width) / (int)map->tileWidth;
-            toY = (int)screenRect.y / (int)map->tileHeight;
-        break;
-        case RENDER_ORDER_LEFT_DOWN:
-            /* Start at the top-right, iterate left, then iterate down, ending at the bottom-left */
-            fromX = (int)(screenRect.x + screenRect.width) / (int)map->tileWidth;
-            fromY = (int)screenRect.y / (int)map->tileHeight;
-            toX = (int)screenRect.x / (int)map->tileWidth;
-            toY = (int)(screenRect.y + screenRect.height) / (int)map->tileHeight;
-        break;
-        case RENDER_ORDER_LEFT_UP:
-            /* Start at the bottom-right, iterate left, then iterate up, ending at the top-left */
-            fromX = (int)(screenRect.x + screenRect.width) / (int)map->tileWidth;
-            fromY = (int)(screenRect.y + screenRect.height) / (int)map->tileHeight;
-            toX = (int)screenRect.x / (int)map->tileWidth;
-            toY = (int)screenRect.y / (int)map->tileHeight;
-        break;
-        } /* switch (map->renderOrder) */
-        /* Restrain the the tile positions to those within the map in case of rounding mistakes */
-        fromX = Clampi(fromX, 0, (int)map->width - 1);
-        fromY = Clampi(fromY, 0, (int)map->height - 1);
-        toX = Clampi(toX, 0, (int)map->width - 1);
-        toY = Clampi(toY, 0, (int)map->height - 1);
-        /* Begin iteration from both "from" tile positions */
-        currentX = fromX;
-        currentY = fromY;
-    } else if (currentX == toX) { /* If the end of the current row was reached */
-        /* Rendering is done row-by-row. This row is done so move to the next one. */
-        currentX = fromX;
-        currentY += SIGN(toY - fromY); /* Either +1 or -1 */
-    } else { /* If still iterating through the current row */
-        /* Move to the right or left by one tile */
-        currentX += SIGN(toX - fromX); /* Either +1 or -1 */
+    /* The bake is stale if the TMX document, any external tileset or any object template has changed since */
+    if (header->sourceModTime != (int64_t)GetFileModTime(fileName) ||
+            header->sourceLength != (int64_t)GetFileLength(fileName))
+        return NULL;
+    const RaytmxBinaryTileset* tilesetRecords = (const RaytmxBinaryTileset*)(data + header->tilesetsOffset);
+    const char* tmxDirectory = GetDirectoryPath2(fileName);
+    for (uint32_t i = 0; i < header->tilesetsLength; i++) {
+        if (tilesetRecords[i].source == 0)
+            continue;
+        char* source = CopyBinaryString(data, header, tilesetRecords[i].source);
+        int64_t modTime = (int64_t)GetFileModTime(JoinPath(tmxDirectory, source));
+        MemFree(source);
+        if (modTime != tilesetRecords[i].sourceModTime)
+            return NULL;
     }
-
-    /* If iteration has gone beyond the final row */
-    if ((toY - fromY > 0 && currentY > toY) || (toY - fromY < 0 && currentY < toY)) {
-        /* This is the termination condition. Zero all values and return false so the caller exits its loop. */
-        currentLayer = NULL;
-        fromX = fromY = toX = toY = currentX = currentY = 0;
-        return false;
+    const RaytmxBinaryTemplate* templateRecords = (const RaytmxBinaryTemplate*)(data + header->templatesOffset);
+    for (uint32_t i = 0; i < header->templatesLength; i++) {
+        char* source = CopyBinaryString(data, header, templateRecords[i].source);
+        if (source == NULL)
+            return NULL;
+        int64_t modTime = (int64_t)GetFileModTime(JoinPath(tmxDirectory, source));
+        MemFree(source);
+        if (modTime != templateRecords[i].sourceModTime)
+            return NULL;
     }
 
-    /* Calculate the index in the tile layer from knowing the tile's X and Y position (in tiles, not pixels) */
-    int index = (currentY * (int)map->width) + currentX;
-    if (index < 0 || index >= (int)layer->tilesLength) { /* Bounds check */
-        currentLayer = NULL;
-        fromX = fromY = toX = toY = currentX = currentY = 0;
-        return false;
+    const RaytmxBinaryLayer* layerRecords = (const RaytmxBinaryLayer*)(data + header->layersOffset);
+    for (uint32_t i = 0; i < header->layersLength; i++) {
+        const RaytmxBinaryLayer* record = &layerRecords[i];
+        if (record->type == LAYER_TYPE_TILE_LAYER) {
+            /* Drawing and collision index tiles by the map's dimensions, so the layer must match them exactly */
+            if (record->width != header->width || record->height != header->height ||
+                    record->tilesLength != (uint64_t)record->width * record->height ||
+                    !IsBinaryRangeValid(length, record->dataOffset, record->tilesLength, sizeof(uint32_t)))
+                return NULL;
+        } else if (record->type == LAYER_TYPE_OBJECT_GROUP) {
+            if (!IsBinaryRangeValid(length, record->dataOffset, record->objectsLength, sizeof(RaytmxBinaryObject)) ||
+                    (record->ySortedObjectsOffset != 0 && !IsBinaryRangeValid(length, record->ySortedObjectsOffset,
+                    record->objectsLength, sizeof(uint32_t))))
+                return NULL;
+            if (record->ySortedObjectsOffset != 0) { /* Drawing indexes the objects with these */
+                const uint32_t* ySortedObjects = (const uint32_t*)(data + record->ySortedObjectsOffset);
+                for (uint32_t j = 0; j < record->objectsLength; j++) {
+                    if (ySortedObjects[j] >= record->objectsLength)
+                        return NULL;
+                }
+            }
+            const RaytmxBinaryObject* objectRecords = (const RaytmxBinaryObject*)(data + record->dataOffset);
+            for (uint32_t j = 0; j < record->objectsLength; j++) {
+                if (objectRecords[j].pointsLength > 0 && !IsBinaryRangeValid(length, objectRecords[j].pointsOffset,
+                        objectRecords[j].pointsLength, sizeof(Vector2)))
+                    return NULL;
+            }
+        } else
+            return NULL;
     }
 
-    /* Get the raw Global ID (GID) of the tile at this position from the layer's list of tiles. This list's order */
-    /* matches the map's render order. */
-    uint32_t localRawGid = layer->tiles[index];
-    if (rawGid != NULL)
-        *rawGid = localRawGid; /* Assign the value to he output parameter */
-    if (tile != NULL) {
-        /* The raw GID may have bit flags on it. They need to be removed in order to get the actual GID value.*/
-        uint32_t gid = GetGid(localRawGid, NULL, NULL, NULL, NULL);
-        /* Get the tile's metadata from knowing its GID */
-        *tile = map->gidsToTiles[gid];
+    TmxMap* map = (TmxMap*)MemAllocZero(sizeof(TmxMap));
+    map->binaryData = (void*)data;
+    map->binaryDataLength = length;
+    map->fileName = (char*)MemAllocZero((unsigned int)strlen(fileName) + 1);
+    StringCopy(map->fileName, GetFileName(fileName));
+    map->orientation = (TmxOrientation)header->orientation;
+    map->renderOrder = (TmxRenderOrder)header->renderOrder;
+    map->width = header->width;
+    map->height = header->height;
+    map->tileWidth = header->tileWidth;
+    map->tileHeight = header->tileHeight;
+    map->parallaxOriginX = header->parallaxOriginX;
+    map->parallaxOriginY = header->parallaxOriginY;
+    map->backgroundColor = header->backgroundColor;
+    map->hasBackgroundColor = header->hasBackgroundColor != 0;
+
+    if (header->tilesetsLength > 0) {
+        map->tilesets = (TmxTileset*)MemAllocZero(sizeof(TmxTileset) * header->tilesetsLength);
+        map->tilesetsLength = header->tilesetsLength;
     }
-    if (tileRect != NULL) {
-        /* Calculate the tile's destination rectangle, in pixels */
-        *tileRect = (Rectangle) {
-            .x = (float)((uint32_t)currentX * map->tileWidth),
-            .y = (float)((uint32_t)currentY * map->tileHeight),
-            .width = (float)map->tileWidth,
-            .height = (float)map->tileHeight
-        };
+    for (uint32_t i = 0; i < header->tilesetsLength; i++) {
+        const RaytmxBinaryTileset* record = &tilesetRecords[i];
+        TmxTileset* tileset = &map->tilesets[i];
+        tileset->firstGid = record->firstGid;
+        tileset->lastGid = record->lastGid;
+        tileset->source = CopyBinaryString(data, header, record->source);
+        tileset->name = CopyBinaryString(data, header, record->name);
+        tileset->classString = CopyBinaryString(data, header, record->classString);
+        tileset->tileWidth = record->tileWidth;
+        tileset->tileHeight = record->tileHeight;
+        tileset->spacing = record->spacing;
+        tileset->margin = record->margin;
+        tileset->tileCount = record->tileCount;
+        tileset->columns = record->columns;
+        tileset->objectAlignment = (TmxObjectAlignment)record->objectAlignment;
+        tileset->tileOffsetX = record->tileOffsetX;
+        tileset->tileOffsetY = record->tileOffsetY;
+        tileset->hasImage = true;
+        tileset->image.source = CopyBinaryString(data, header, record->imageSource);
+        tileset->image.width = record->imageWidth;
+        tileset->image.height = record->imageHeight;
+
+        char* imagePath = CopyBinaryString(data, header, record->imagePath);
+        char* fullPath = JoinPath(tmxDirectory, imagePath != NULL ? imagePath : "");
+        tileset->image.texture = LoadTextureOrImage(fullPath, isTextureUploadDeferred, &tileset->image.pendingImage);
+        if (tileset->image.texture.width == 0)
+            TraceLog(LOG_ERROR, "RAYTMX: Unable to load texture \"%s\"", fullPath);
+        FreeString(imagePath);
     }
 
-    return true;
-}
-
-void DrawTMXTileLayer(const TmxMap* map, Rectangle screenRect, TmxLayer layer, int posX, int posY, Color tint) {
+    if (header->layersLength > 0) {
+        map->layers = (TmxLayer*)MemAllocZero(sizeof(TmxLayer) * header->layersLength);
+        map->layersLength = header->layersLength;
+    }
+    for (uint32_t i = 0; i < header->layersLength; i++) {
+        const RaytmxBinaryLayer* record = &layerRecords[i];
+        TmxLayer* layer = &map->layers[i];
+        layer->type = (TmxLayerType)record->type;
+        layer->id = record->id;
+        layer->name = CopyBinaryString(data, header, record->name);
+        layer->classString = CopyBinaryString(data, header, record->classString);
+        layer->visible = record->visible != 0;
+        layer->opacity = record->opacity;
+        layer->tintColor = record->tintColor;
+        layer->hasTintColor = record->hasTintColor != 0;
+        layer->offsetX = record->offsetX;
+        layer->offsetY = record->offsetY;
+        layer->parallaxX = record->parallaxX;
+        layer->parallaxY = record->parallaxY;
+
+        if (layer->type == LAYER_TYPE_TILE_LAYER) {
+            TmxTileLayer* tileLayer = &layer->exact.tileLayer;
+            tileLayer->width = record->width;
+            tileLayer->height = record->height;
+            /* The GIDs are used in place. The mapping is read-only, and nothing writes to 'tiles' after loading. */
+            tileLayer->tiles = (uint32_t*)(data + record->dataOffset);
+            tileLayer->tilesLength = record->tilesLength;
+        } else { /* LAYER_TYPE_OBJECT_GROUP */
+            TmxObjectGroup* objectGroup = &layer->exact.objectGroup;
+            objectGroup->color = record->color;
+            objectGroup->hasColor = record->hasColor != 0;
+            objectGroup->drawOrder = (TmxObjectGroupDrawOrder)record->drawOrder;
+            objectGroup->objectsLength = record->objectsLength;
+            if (record->objectsLength > 0)
+                objectGroup->objects = (TmxObject*)MemAllocZero(sizeof(TmxObject) * record->objectsLength);
+            const RaytmxBinaryObject* objectRecords = (const RaytmxBinaryObject*)(data + record->dataOffset);
+            for (uint32_t j = 0; j < record->objectsLength; j++) {
+                const RaytmxBinaryObject* objectRecord = &objectRecords[j];
+                TmxObject* object = &objectGroup->objects[j];
+                object->type = (TmxObjectType)objectRecord->type;
+                object->id = objectRecord->id;
+                object->name = CopyBinaryString(data, header, objectRecord->name);
+                object->typeString = CopyBinaryString(data, header, objectRecord->typeString);
+                object->x = objectRecord->x;
+                object->y = objectRecord->y;
+                object->width = objectRecord->width;
+                object->height = objectRecord->height;
+                object->rotation = objectRecord->rotation;
+                object->gid = objectRecord->gid;
+                object->visible = objectRecord->visible != 0;
+                object->aabb = objectRecord->aabb;
+                if (objectRecord->pointsLength > 0) {
+                    unsigned int pointsSize = (unsigned int)(sizeof(Vector2) * objectRecord->pointsLength);
+                    object->points = (Vector2*)MemAllocZero(pointsSize);
+                    memcpy(object->points, data + objectRecord->pointsOffset, pointsSize);
+                    object->pointsLength = objectRecord->pointsLength;
+                    object->drawPoints = (Vector2*)MemAllocZero(pointsSize);
+                }
+            }
+            if (record->ySortedObjectsOffset != 0 && record->objectsLength > 0) {
+                unsigned int ySortedSize = (unsigned int)(sizeof(uint32_t) * record->objectsLength);
+                objectGroup->ySortedObjects = (uint32_t*)MemAllocZero(ySortedSize);
+                memcpy(objectGroup->ySortedObjects, data + record->ySortedObjectsOffset, ySortedSize);
+            }
+        }
+    }
+
+    if (header->gidsToTilesLength > 0) {
+        map->gidsToTiles = (TmxTile*)MemAllocZero(sizeof(TmxTile) * header->gidsToTilesLength);
+        map->gidsToTilesLength = header->gidsToTilesLength;
+    }
+    const RaytmxBinaryTile* tileRecords = (const RaytmxBinaryTile*)(data + header->gidsToTilesOffset);
+    for (uint32_t gid = 0; gid < header->gidsToTilesLength; gid++) {
+        const RaytmxBinaryTile* record = &tileRecords[gid];
+        TmxTile* tile = &map->gidsToTiles[gid];
+        tile->gid = record->gid;
+        tile->sourceRect = record->sourceRect;
+        tile->offset = record->offset;
+        if (record->tilesetIndex >= 0 && (uint32_t)record->tilesetIndex < map->tilesetsLength)
+            tile->texture = map->tilesets[record->tilesetIndex].image.texture;
+    }
+
+    return map;
+}
+
+bool IsBinaryRangeValid(size_t length, uint64_t offset, uint64_t count, size_t size) {
+    /* 'count' is at most 32 bits wide in practice so the multiplication cannot overflow 64 bits */
+    return offset <= length && count * size <= length - offset;
+}
+
+char* CopyBinaryString(const unsigned char* data, const RaytmxBinaryHeader* header, uint32_t reference) {
+    if (reference == 0 || reference > header->stringsLength)
+        return NULL;
+    const char* str = (const char*)(data + header->stringsOffset + reference - 1);
+    char* copy = (char*)MemAllocZero((unsigned int)strlen(str) + 1);
+    StringCopy(copy, str);
+    return copy;
+}
+
+void AppendBinaryData(RaytmxBinaryBuffer* buffer, const void* data, size_t size) {
+    if (buffer->length + size > buffer->capacity) {
+        size_t capacity = buffer->capacity > 0 ? buffer->capacity * 2 : 4096;
+        while (capacity < buffer->length + size)
+            capacity *= 2;
+        buffer->data = (unsigned char*)MemRealloc(buffer->data, (unsigned int)capacity);
+        buffer->capacity = capacity;
+    }
+    if (data != NULL)
+        memcpy(buffer->data + buffer->length, data, size);
+    else
+        memset(buffer->data + buffer->length, 0, size);
+    buffer->length += size;
+}
+
+void AlignBinaryData(RaytmxBinaryBuffer* buffer) {
+    size_t padding = (RAYTMX_BINARY_ALIGNMENT - (buffer->length % RAYTMX_BINARY_ALIGNMENT)) % RAYTMX_BINARY_ALIGNMENT;
+    AppendBinaryData(buffer, NULL, padding);
+}
+
+uint32_t AppendBinaryString(RaytmxBinaryBuffer* strings, const char* str) {
+    if (str == NULL)
+        return 0;
+    uint32_t reference = (uint32_t)strings->length + 1; /* Plus one so that zero can mean NULL */
+    AppendBinaryData(strings, str, strlen(str) + 1); /* + 1 for the terminator */
+    return reference;
+}
+
+unsigned char* MapBinaryFile(const char* fileName, size_t* length) {
+    if (!FileExists(fileName))
+        return NULL;
+#ifdef _WIN32
+    int dataSize = 0;
+    unsigned char* data = LoadFileData(fileName, &dataSize);
+    *length = (size_t)dataSize;
+    return data;
+#else
+    int fileDescriptor = open(fileName, O_RDONLY);
+    if (fileDescriptor < 0)
+        return NULL;
+    struct stat fileStat;
+    void* data = NULL;
+    if (fstat(fileDescriptor, &fileStat) == 0 && fileStat.st_size > 0) {
+        data = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        if (data == MAP_FAILED)
+            data = NULL;
+        else
+            *length = (size_t)fileStat.st_size;
+    }
+    close(fileDescriptor); /* The mapping stays valid after the descriptor is closed */
+    return (unsigned char*)data;
+#endif
+}
+
+void UnmapBinaryFile(void* data, size_t length) {
+#ifdef _WIN32
+    (void)length;
+    UnloadFileData((unsigned char*)data);
+#else
+    munmap(data, length);
+#endif
+}
+
+/* "Get the file name of the baked binary map for a given TMX file name" (e.g. "maps/a.tmx" -> "maps/a.tmxb") */
+char* GetBinaryFileName(const char* fileName) {
+    static RAYTMX_THREAD_LOCAL char binaryFileName[260]; /* Max path length on Windows, the bottleneck, is 260 characters */
+    memset(binaryFileName, '\0', 260);
+    StringCopyN(binaryFileName, fileName, 258); /* Leave room for the 'b' and the terminator */
+    StringConcatenate(binaryFileName, "b");
+    return binaryFileName;
+}
+
+/**
+ * Helper function that writes a baked binary map without disturbing anyone reading the previous one. Maps loaded from
+ * the file may still have it mapped into memory, and other threads may be baking the same map, so the data is written
+ * to a temporary file of this thread's own and then renamed over the target in one step. Readers keep the old file's
+ * contents until they unmap them.
+ *
+ * @param fileName File name and/or path of the baked binary map.
+ * @param data The baked binary map.
+ * @param length Length, in bytes, of the 'data' array.
+ * @return True if the file now holds the data, or false if it was left as it was.
+ */
+bool ReplaceBinaryFile(const char* fileName, unsigned char* data, size_t length) {
+    static RAYTMX_THREAD_LOCAL char tempFileName[280];
+    /* The address of a thread-local buffer differs between threads alive at the same time */
+    snprintf(tempFileName, sizeof(tempFileName), "%s.%lx.tmp", fileName, (unsigned long)(uintptr_t)tempFileName);
+    if (!SaveFileData(tempFileName, data, (int)length))
+        return false;
+#ifdef _WIN32
+    /* rename() doesn't replace existing files on Windows. Nothing maps the file there as it's read into RAM instead. */
+    remove(fileName);
+#endif
+    if (rename(tempFileName, fileName) != 0) {
+        remove(tempFileName);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Helper function that loads a texture into VRAM or, if the upload is deferred, only decodes the image into RAM and
+ * returns a placeholder texture with the image's dimensions but no ID for UploadTMXTextures() to replace later.
+ *
+ * @param fileName File name and/or path referencing the image on disk.
+ * @param isTextureUploadDeferred When true, no graphics calls are made.
+ * @param pendingImage Output parameter assigned the decoded image if the upload is deferred, or a zeroed image if not.
+ * @return The loaded texture or placeholder. Its width is zero if loading failed.
+ */
+Texture2D LoadTextureOrImage(const char* fileName, bool isTextureUploadDeferred, Image* pendingImage) {
+    Texture2D texture;
+    memset(&texture, 0, sizeof(Texture2D));
+    memset(pendingImage, 0, sizeof(Image));
+    if (!isTextureUploadDeferred)
+        return LoadTexture(fileName);
+
+    Image image = LoadImage(fileName);
+    if (image.data == NULL)
+        return texture;
+    *pendingImage = image;
+    texture.width = image.width;
+    texture.height = image.height;
+    texture.mipmaps = image.mipmaps;
+    texture.format = image.format;
+    return texture;
+}
+
+/**
+ * Helper function that finds every image held by the map's tilesets, tileset tiles, and image layers.
+ *
+ * @param map The map whose images are to be found.
+ * @param images (Optional) array, long enough for every image, that is filled with pointers to the images.
+ * @return The number of images found.
+ */
+uint32_t GatherTMXImages(TmxMap* map, TmxImage** images) {
+    uint32_t imagesLength = 0;
+    for (uint32_t i = 0; i < map->tilesetsLength; i++) {
+        TmxTileset* tileset = &map->tilesets[i];
+        if (tileset->hasImage) {
+            if (images != NULL)
+                images[imagesLength] = &tileset->image;
+            imagesLength += 1;
+        }
+        for (uint32_t j = 0; j < tileset->tilesLength; j++) {
+            if (tileset->tiles[j].hasImage) {
+                if (images != NULL)
+                    images[imagesLength] = &tileset->tiles[j].image;
+                imagesLength += 1;
+            }
+        }
+    }
+    return imagesLength + GatherTMXLayerImages(map->layers, map->layersLength,
+        images != NULL ? images + imagesLength : NULL);
+}
+
+uint32_t GatherTMXLayerImages(TmxLayer* layers, uint32_t layersLength, TmxImage** images) {
+    uint32_t imagesLength = 0;
+    for (uint32_t i = 0; i < layersLength; i++) {
+        if (layers[i].type == LAYER_TYPE_IMAGE_LAYER && layers[i].exact.imageLayer.hasImage) {
+            if (images != NULL)
+                images[imagesLength] = &layers[i].exact.imageLayer.image;
+            imagesLength += 1;
+        }
+        /* <group> layers may have child layers with images of their own */
+        imagesLength += GatherTMXLayerImages(layers[i].layers, layers[i].layersLength,
+            images != NULL ? images + imagesLength : NULL);
+    }
+    return imagesLength;
+}
+
+/**
+ * Helper function that frees decoded images awaiting upload. Images decoded from the same file within a document share
+ * pixels so each distinct allocation is freed once.
+ *
+ * @param images Array of pointers to images, some of which may have pending images.
+ * @param imagesLength Length of the 'images' array.
+ */
+void UnloadPendingImages(TmxImage** images, uint32_t imagesLength) {
+    for (uint32_t i = 0; i < imagesLength; i++) {
+        void* data = images[i]->pendingImage.data;
+        if (data == NULL)
+            continue;
+        UnloadImage(images[i]->pendingImage);
+        /* Forget this and any later copies of the same pixels */
+        for (uint32_t j = i; j < imagesLength; j++) {
+            if (images[j]->pendingImage.data == data)
+                memset(&images[j]->pendingImage, 0, sizeof(Image));
+        }
+    }
+}
+
+#define SIGN(x) (x < 0 ? -1 : +1)
+
+/**
+ * Helper function that keeps an integer within the given range.
+ * Note: A function named Clamp() exists in raylib but uses floats, hence Clampi().
+ * 
+ * @param value The preferred value that will be used as long as it is between the minimum and maximum values.
+ * @param minimum The smallest acceptable value, inclusive.
+ * @param maximum The largest acceptable value, inclusive.
+ * @return The preferred value if within the range or the nearest acceptable value.
+ */
+int Clampi(int value, int minimum, int maximum) {
+    if (value < minimum)
+        return minimum;
+    else if (value > maximum)
+        return maximum;
+    return value;
+}
+
+/**
+ * Helper function that begins iterating through the tiles of the given tile layer overlapping with the given screen
+ * rectangle. Tiles are provided row-by-row, in the map's render order, by passing the returned iterator to
+ * NextTileLayerSpan() e.g. "while (NextTileLayerSpan(&iterator, &span)) { ... }". The iterator holds all of the
+ * iteration's state so any number of iterations may be ongoing at once, on any number of threads.
+ *
+ * @param map A loaded map model containing the given tile layer.
+ * @param layer The tile layer within the given map whose tiles will be iterated.
+ * @param screenRect A rectangle representing the screen. This could also be considered a search area.
+ * @return An iterator to be passed to NextTileLayerSpan(). It's already done if there is nothing to iterate.
+ */
+RaytmxTileLayerIterator IterateTileLayer(const TmxMap* map, const TmxTileLayer* layer, Rectangle screenRect) {
+    RaytmxTileLayerIterator iterator = { 0 };
+    iterator.isDone = true;
+    if (map == NULL || map->width == 0 || map->height == 0 || map->tileWidth == 0 || map->tileHeight == 0 ||
+            layer == NULL || layer->tilesLength == 0)
+        return iterator;
+
+    /* Determine the tile positions, not pixel, of the rows and columns that the screen rectangle overlaps with */
+    /* Restrain the tile positions to those within the map in case of rounding mistakes */
+    int left = Clampi((int)screenRect.x / (int)map->tileWidth, 0, (int)map->width - 1);
+    int top = Clampi((int)screenRect.y / (int)map->tileHeight, 0, (int)map->height - 1);
+    int right = Clampi((int)(screenRect.x + screenRect.width) / (int)map->tileWidth, 0, (int)map->width - 1);
+    int bottom = Clampi((int)(screenRect.y + screenRect.height) / (int)map->tileHeight, 0, (int)map->height - 1);
+
+    iterator.layer = layer;
+    iterator.stride = map->width;
+    iterator.fromX = left;
+    iterator.toX = right;
+    switch (map->renderOrder) {
+    case RENDER_ORDER_RIGHT_DOWN: /* Start at the top-left, iterate right, then down (the order English is read) */
+    case RENDER_ORDER_LEFT_DOWN: /* Start at the top-right, iterate left, then down */
+        iterator.nextY = top;
+        iterator.toY = bottom;
+        iterator.stepY = 1;
+    break;
+    case RENDER_ORDER_RIGHT_UP: /* Start at the bottom-left, iterate right, then up */
+    case RENDER_ORDER_LEFT_UP: /* Start at the bottom-right, iterate left, then up */
+        iterator.nextY = bottom;
+        iterator.toY = top;
+        iterator.stepY = -1;
+    break;
+    } /* switch (map->renderOrder) */
+    iterator.isRightToLeft = map->renderOrder == RENDER_ORDER_LEFT_DOWN || map->renderOrder == RENDER_ORDER_LEFT_UP;
+    iterator.isDone = false;
+    /* Walk the runs of non-empty tiles when they were indexed, which also guarantees the layer matches the map */
+    iterator.isSparse = layer->rowRuns != NULL && layer->width == map->width && layer->height == map->height;
+    iterator.runStep = iterator.isRightToLeft ? -1 : 1;
+
+    return iterator;
+}
+
+/**
+ * Helper function that provides the next row of tiles from an iteration begun with IterateTileLayer(). Each row is
+ * provided as a span of adjacent tiles whose raw GIDs are contiguous in memory, so callers process a whole row per
+ * call rather than a single tile.
+ *
+ * @param iterator The iteration state returned by IterateTileLayer(). It's advanced by this call.
+ * @param span Output parameter assigned with the tiles of the next row.
+ * @return True if the next row is being provided via the span, or false if iteration is done.
+ */
+bool NextTileLayerSpan(RaytmxTileLayerIterator* iterator, RaytmxTileSpan* span) {
+    if (iterator->isSparse) {
+        const TmxTileLayer* layer = iterator->layer;
+        while (true) {
+            /* Return the next run of the current row that overlaps with the iterated columns, clipped to them */
+            while (iterator->nextRun != iterator->endRun) {
+                TmxTileRun run = layer->runs[iterator->nextRun];
+                iterator->nextRun += iterator->runStep;
+                int fromX = (int)run.x > iterator->fromX ? (int)run.x : iterator->fromX;
+                int toX = (int)(run.x + run.length) - 1 < iterator->toX ? (int)(run.x + run.length) - 1 : iterator->toX;
+                if (fromX > toX) /* If the run is entirely to the left or right of the iterated columns */
+                    continue;
+
+                span->rawGids = &layer->tiles[((size_t)iterator->runY * iterator->stride) + (size_t)fromX];
+                span->length = (uint32_t)(toX - fromX + 1);
+                span->x = fromX;
+                span->y = iterator->runY;
+                span->isRightToLeft = iterator->isRightToLeft;
+                return true;
+            }
+
+            if (iterator->isDone)
+                return false;
+
+            /* Move on to the next row, or finish after it if it's the final one */
+            iterator->runY = iterator->nextY;
+            if (iterator->nextY == iterator->toY)
+                iterator->isDone = true;
+            else
+                iterator->nextY += iterator->stepY;
+
+            /* Only the runs between the first and last overlapping ones need to be visited. Runs are sorted by */
+            /* column so binary search for the first run ending at or after the first iterated column. */
+            int first = (int)layer->rowRuns[iterator->runY];
+            int last = (int)layer->rowRuns[iterator->runY + 1];
+            int low = first, high = last;
+            while (low < high) {
+                int middle = low + ((high - low) / 2);
+                if ((int)(layer->runs[middle].x + layer->runs[middle].length) <= iterator->fromX)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            first = low;
+            while (last > first && (int)layer->runs[last - 1].x > iterator->toX)
+                last -= 1;
+
+            if (iterator->runStep > 0) {
+                iterator->nextRun = first;
+                iterator->endRun = last;
+            } else {
+                iterator->nextRun = last - 1;
+                iterator->endRun = first - 1;
+            }
+        }
+    }
+
+    if (iterator->isDone)
+        return false;
+
+    /* Calculate the index in the tile layer of the row's first tile. The list of tiles is in row-major order. */
+    size_t index = ((size_t)iterator->nextY * iterator->stride) + (size_t)iterator->fromX;
+    if (index >= iterator->layer->tilesLength) { /* Bounds check */
+        iterator->isDone = true;
+        return false;
+    }
+
+    span->rawGids = &iterator->layer->tiles[index];
+    span->length = (uint32_t)(iterator->toX - iterator->fromX + 1);
+    if (span->length > iterator->layer->tilesLength - index) /* If the layer is shorter than the map */
+        span->length = (uint32_t)(iterator->layer->tilesLength - index);
+    span->x = iterator->fromX;
+    span->y = iterator->nextY;
+    span->isRightToLeft = iterator->isRightToLeft;
+
+    /* Move on to the next row, or finish if this was the final one */
+    if (iterator->nextY == iterator->toY)
+        iterator->isDone = true;
+    else
+        iterator->nextY += iterator->stepY;
+
+    return true;
+}
+
+/**
+ * Helper function that indexes the runs of non-empty tiles in every tile layer of the given map, so that iteration can
+ * skip the empty cells, and logs the share of cells that are occupied.
+ *
+ * @param map A loaded map model whose tile layers will be indexed.
+ */
+void IndexTMXTileRuns(TmxMap* map) {
+    uint64_t occupied = 0, total = 0;
+    IndexTileLayerRuns(map, map->layers, map->layersLength, &occupied, &total);
+    if (total > 0) {
+        TraceLog(LOG_INFO, "RAYTMX: \"%s\" has %llu of %llu tiles occupied (%.1f%%)", map->fileName,
+            (unsigned long long)occupied, (unsigned long long)total, (100.0 * (double)occupied) / (double)total);
+    }
+}
+
+/**
+ * Helper function that builds the 'runs' and 'rowRuns' arrays of the given layers, recursing into groups.
+ *
+ * @param map A loaded map model containing the given layers.
+ * @param layers An array of layers whose tile layers will be indexed.
+ * @param layersLength Length of the given array of layers.
+ * @param occupied Output parameter that the number of non-empty tiles is added to.
+ * @param total Output parameter that the number of tiles is added to.
+ */
+void IndexTileLayerRuns(const TmxMap* map, TmxLayer* layers, uint32_t layersLength, uint64_t* occupied,
+        uint64_t* total) {
+    for (uint32_t i = 0; i < layersLength; i++) {
+        if (layers[i].type == LAYER_TYPE_GROUP) {
+            IndexTileLayerRuns(map, layers[i].layers, layers[i].layersLength, occupied, total);
+            continue;
+        }
+
+        TmxTileLayer* tileLayer = &layers[i].exact.tileLayer;
+        if (layers[i].type != LAYER_TYPE_TILE_LAYER || tileLayer->runs != NULL || tileLayer->width != map->width ||
+                tileLayer->height != map->height || tileLayer->tilesLength != tileLayer->width * tileLayer->height)
+            continue; /* Layers that don't line up with the map's grid are iterated cell by cell */
+
+        /* Count the runs first so they can be stored in a single allocation */
+        uint32_t runsLength = 0;
+        for (uint32_t y = 0; y < tileLayer->height; y++) {
+            const uint32_t* row = &tileLayer->tiles[y * tileLayer->width];
+            for (uint32_t x = 0; x < tileLayer->width; x++) {
+                if (row[x] != 0 && (x == 0 || row[x - 1] == 0))
+                    runsLength += 1;
+                if (row[x] != 0)
+                    *occupied += 1;
+            }
+        }
+        *total += tileLayer->tilesLength;
+
+        tileLayer->runs = (TmxTileRun*)MemAllocZero(sizeof(TmxTileRun) * (runsLength > 0 ? runsLength : 1));
+        tileLayer->rowRuns = (uint32_t*)MemAllocZero(sizeof(uint32_t) * (tileLayer->height + 1));
+        uint32_t runIndex = 0;
+        for (uint32_t y = 0; y < tileLayer->height; y++) {
+            tileLayer->rowRuns[y] = runIndex;
+            const uint32_t* row = &tileLayer->tiles[y * tileLayer->width];
+            for (uint32_t x = 0; x < tileLayer->width; x++) {
+                if (row[x] == 0)
+                    continue;
+                if (x == 0 || row[x - 1] == 0) { /* If this tile begins a new run */
+                    tileLayer->runs[runIndex].x = x;
+                    runIndex += 1;
+                }
+                tileLayer->runs[runIndex - 1].length += 1;
+            }
+        }
+        tileLayer->rowRuns[tileLayer->height] = runIndex;
+        tileLayer->runsLength = runsLength;
+    }
+}
+
+/**
+ * Helper function that builds a bounding volume hierarchy over the objects of every object layer of the given map, so
+ * that collision checks against a layer only look at the objects near whatever is being checked.
+ *
+ * @param map A loaded map model whose object layers will be indexed.
+ */
+void IndexTMXObjectGroups(TmxMap* map) {
+    uint32_t nodes = 0;
+    IndexObjectGroupLayers(map->layers, map->layersLength, &nodes);
+    if (nodes > 0)
+        TraceLog(LOG_DEBUG, "RAYTMX: Built %u bounding volume nodes over \"%s\"'s objects", nodes, map->fileName);
+}
+
+/**
+ * Helper function that builds the bounding volume hierarchies of the given layers' object groups, recursing into
+ * groups.
+ *
+ * @param layers An array of layers whose object groups will be indexed.
+ * @param layersLength Length of the given array of layers.
+ * @param nodes Output parameter that the number of nodes built is added to.
+ */
+void IndexObjectGroupLayers(TmxLayer* layers, uint32_t layersLength, uint32_t* nodes) {
+    for (uint32_t i = 0; i < layersLength; i++) {
+        if (layers[i].type == LAYER_TYPE_GROUP)
+            IndexObjectGroupLayers(layers[i].layers, layers[i].layersLength, nodes);
+        else if (layers[i].type == LAYER_TYPE_OBJECT_GROUP && layers[i].exact.objectGroup.bvh == NULL) {
+            BuildObjectGroupBvh(&layers[i].exact.objectGroup);
+            *nodes += layers[i].exact.objectGroup.bvhLength;
+        }
+    }
+}
+
+/**
+ * Helper function that builds the 'bvh' and 'bvhObjects' arrays of the given object group by splitting its objects in
+ * half, by the centers of their AABBs, along the longer axis of the space the centers occupy until few enough remain.
+ *
+ * @param group An object group whose objects' AABBs have been calculated.
+ */
+void BuildObjectGroupBvh(TmxObjectGroup* group) {
+    if (group->objectsLength == 0)
+        return;
+
+    Vector2* centers = (Vector2*)MemAllocZero(sizeof(Vector2) * group->objectsLength);
+    group->bvhObjects = (uint32_t*)MemAllocZero(sizeof(uint32_t) * group->objectsLength);
+    for (uint32_t i = 0; i < group->objectsLength; i++) {
+        Rectangle aabb = group->objects[i].aabb;
+        centers[i] = (Vector2){ aabb.x + aabb.width / 2.0f, aabb.y + aabb.height / 2.0f };
+        group->bvhObjects[i] = i;
+    }
+
+    /* A binary tree whose leaves each hold at least one object has fewer than twice as many nodes as objects */
+    group->bvh = (TmxObjectBvhNode*)MemAllocZero(sizeof(TmxObjectBvhNode) * 2 * group->objectsLength);
+    group->bvhLength = 0;
+    BuildObjectBvhNode(group, centers, 0, group->objectsLength);
+    MemFree(centers);
+}
+
+/**
+ * Helper function that appends the node covering the given range of 'bvhObjects' to the object group's 'bvh' array,
+ * followed by its subtree.
+ *
+ * @param group An object group whose 'bvh' and 'bvhObjects' arrays are being built.
+ * @param centers Centers of the AABBs of the group's objects, by index in 'objects.'
+ * @param first Index into 'bvhObjects' of the node's first object.
+ * @param count Number of objects beneath the node.
+ * @return The index of the appended node.
+ */
+uint32_t BuildObjectBvhNode(TmxObjectGroup* group, const Vector2* centers, uint32_t first, uint32_t count) {
+    const uint32_t maxLeafObjects = 4;
+    uint32_t nodeIndex = group->bvhLength;
+    group->bvhLength += 1;
+
+    /* Bound the node's objects, and the centers that decide which way to split them */
+    Rectangle aabb = group->objects[group->bvhObjects[first]].aabb;
+    Vector2 minCenter = centers[group->bvhObjects[first]], maxCenter = minCenter;
+    for (uint32_t i = first + 1; i < first + count; i++) {
+        Rectangle objectAabb = group->objects[group->bvhObjects[i]].aabb;
+        float right = fmaxf(aabb.x + aabb.width, objectAabb.x + objectAabb.width);
+        float bottom = fmaxf(aabb.y + aabb.height, objectAabb.y + objectAabb.height);
+        aabb.x = fminf(aabb.x, objectAabb.x);
+        aabb.y = fminf(aabb.y, objectAabb.y);
+        aabb.width = right - aabb.x;
+        aabb.height = bottom - aabb.y;
+
+        Vector2 center = centers[group->bvhObjects[i]];
+        minCenter = (Vector2){ fminf(minCenter.x, center.x), fminf(minCenter.y, center.y) };
+        maxCenter = (Vector2){ fmaxf(maxCenter.x, center.x), fmaxf(maxCenter.y, center.y) };
+    }
+    group->bvh[nodeIndex].aabb = aabb;
+
+    if (count <= maxLeafObjects) {
+        group->bvh[nodeIndex].first = first;
+        group->bvh[nodeIndex].count = count;
+    } else {
+        /* Split at the median so the tree stays balanced however the objects are spread out */
+        uint32_t half = count / 2;
+        bool isAxisX = maxCenter.x - minCenter.x >= maxCenter.y - minCenter.y;
+        SelectObjectsByCenter(&group->bvhObjects[first], centers, count, half, isAxisX);
+        BuildObjectBvhNode(group, centers, first, half);
+        BuildObjectBvhNode(group, centers, first + half, count - half);
+    }
+    group->bvh[nodeIndex].skip = group->bvhLength;
+
+    return nodeIndex;
+}
+
+/**
+ * Helper function that partially sorts the given indexes of objects, by the centers of their AABBs along one axis, so
+ * the one that would be at the given position if they were sorted is, with lesser ones before it and greater after.
+ *
+ * @param indexes An array of indexes of objects.
+ * @param centers Centers of the AABBs of the objects, by index.
+ * @param count Length of the array of indexes.
+ * @param nth The position to sort the indexes around.
+ * @param isAxisX When true, the centers' x-coordinates are compared, otherwise their y-coordinates are.
+ */
+void SelectObjectsByCenter(uint32_t* indexes, const Vector2* centers, uint32_t count, uint32_t nth, bool isAxisX) {
+    uint32_t left = 0, right = count - 1;
+    while (left < right) {
+        /* Partition the range around the center of its middle object (Hoare's selection algorithm) */
+        uint32_t middle = indexes[left + (right - left) / 2];
+        float pivot = isAxisX ? centers[middle].x : centers[middle].y;
+        uint32_t i = left, j = right;
+        while (i <= j) {
+            while ((isAxisX ? centers[indexes[i]].x : centers[indexes[i]].y) < pivot)
+                i += 1;
+            while ((isAxisX ? centers[indexes[j]].x : centers[indexes[j]].y) > pivot)
+                j -= 1;
+            if (i <= j) {
+                uint32_t swap = indexes[i];
+                indexes[i] = indexes[j];
+                indexes[j] = swap;
+                i += 1;
+                if (j == 0)
+                    break;
+                j -= 1;
+            }
+        }
+
+        /* Continue in whichever side holds the nth position */
+        if (nth <= j)
+            right = j;
+        else if (nth >= i)
+            left = i;
+        else
+            break;
+    }
+}
+
+/**
+ * Helper function that tags every layer of the given map, nested layers included, with its roles and indexes the layers
+ * by name so they can be found without comparing names one by one.
+ *
+ * @param map A loaded map model whose layers will be tagged and indexed.
+ */
+void IndexTMXLayers(TmxMap* map) {
+    uint32_t layersLength = CountLayers(map->layers, map->layersLength);
+    if (layersLength == 0)
+        return;
+
+    /* Keep the table at most half full so probe sequences stay short */
+    map->layerIndexLength = 1;
+    while (map->layerIndexLength < layersLength * 2)
+        map->layerIndexLength *= 2;
+    map->layerIndex = (RaytmxLayerIndexEntry*)MemAllocZero(sizeof(RaytmxLayerIndexEntry) * map->layerIndexLength);
+    IndexLayerList(map, map->layers, map->layersLength);
+}
+
+/**
+ * Helper function that counts the given layers along with the layers nested within them.
+ *
+ * @param layers An array of layers to be counted.
+ * @param layersLength Length of the given array of layers.
+ * @return The number of layers, nested layers included.
+ */
+uint32_t CountLayers(const TmxLayer* layers, uint32_t layersLength) {
+    uint32_t count = layersLength;
+    for (uint32_t i = 0; i < layersLength; i++) {
+        if (layers[i].type == LAYER_TYPE_GROUP)
+            count += CountLayers(layers[i].layers, layers[i].layersLength);
+    }
+    return count;
+}
+
+/**
+ * Helper function that tags the given layers with their roles and adds them to the map's layer index, recursing into
+ * groups.
+ *
+ * @param map A loaded map model whose 'layerIndex' has been allocated.
+ * @param layers An array of layers within the map to be tagged and indexed.
+ * @param layersLength Length of the given array of layers.
+ */
+void IndexLayerList(TmxMap* map, TmxLayer* layers, uint32_t layersLength) {
+    uint32_t mask = map->layerIndexLength - 1;
+    for (uint32_t i = 0; i < layersLength; i++) {
+        TmxLayer* layer = &layers[i];
+        layer->roles = GetLayerRoles(layer);
+
+        if (layer->name != NULL) {
+            /* The first layer with a given name keeps the slot, as a search in document order would find it first */
+            uint32_t hash = HashLayerName(layer->name);
+            uint32_t slot = hash & mask;
+            bool isDuplicate = false;
+            while (map->layerIndex[slot].layer != NULL && !isDuplicate) {
+                isDuplicate = map->layerIndex[slot].hash == hash &&
+                    strcmp(map->layerIndex[slot].layer->name, layer->name) == 0;
+                slot = (slot + 1) & mask;
+            }
+            if (!isDuplicate) {
+                map->layerIndex[slot].hash = hash;
+                map->layerIndex[slot].layer = layer;
+            }
+        }
+
+        if (layer->type == LAYER_TYPE_GROUP)
+            IndexLayerList(map, layer->layers, layer->layersLength);
+    }
+}
+
+/**
+ * Helper function that hashes a layer's name with the 32-bit Fowler-Noll-Vo (FNV-1a) hash function.
+ *
+ * @param name Name of a layer.
+ * @return The hash of the name.
+ */
+uint32_t HashLayerName(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*)name; *c != '\0'; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Helper function that determines the roles of the given layer from its "role" property if it has one, else its class,
+ * else its name.
+ *
+ * @param layer A layer to determine the roles of.
+ * @return Logically OR'd TmxLayerRole flags.
+ */
+uint32_t GetLayerRoles(const TmxLayer* layer) {
+    for (uint32_t i = 0; i < layer->propertiesLength; i++) {
+        const TmxProperty* property = &layer->properties[i];
+        if (property->type == PROPERTY_TYPE_STRING && property->name != NULL && strcmp(property->name, "role") == 0)
+            return ParseLayerRoles(property->stringValue);
+    }
+    if (layer->classString != NULL && layer->classString[0] != '\0')
+        return ParseLayerRoles(layer->classString);
+    return ParseLayerRoles(layer->name);
+}
+
+/**
+ * Helper function that finds the role names among the words of the given text. Words are separated by any character
+ * that isn't a letter or digit and are compared case-insensitively.
+ *
+ * @param text A list of role names, such as "collision, hazard", or a layer name. May be NULL.
+ * @return Logically OR'd TmxLayerRole flags of the role names found.
+ */
+uint32_t ParseLayerRoles(const char* text) {
+    static const char* roleNames[] = { "collision", "hazard", "portal", "decoration" };
+    static const uint32_t roleFlags[] = { LAYER_ROLE_COLLISION, LAYER_ROLE_HAZARD, LAYER_ROLE_PORTAL,
+        LAYER_ROLE_DECORATION };
+
+    uint32_t roles = LAYER_ROLE_NONE;
+    if (text == NULL)
+        return roles;
+
+    const char* word = text;
+    while (*word != '\0') {
+        if (!isalnum((unsigned char)*word)) {
+            word += 1;
+            continue;
+        }
+        size_t wordLength = 0;
+        while (isalnum((unsigned char)word[wordLength]))
+            wordLength += 1;
+
+        for (size_t i = 0; i < sizeof(roleNames) / sizeof(roleNames[0]); i++) {
+            if (strlen(roleNames[i]) != wordLength)
+                continue;
+            size_t j = 0;
+            while (j < wordLength && tolower((unsigned char)word[j]) == roleNames[i][j])
+                j += 1;
+            if (j == wordLength)
+                roles |= roleFlags[i];
+        }
+        word += wordLength;
+    }
+
+    return roles;
+}
+
+/**
+ * Helper function that gathers the given layers tagged with any of the given roles, recursing into groups.
+ *
+ * @param layers An array of layers to be searched.
+ * @param layersLength Length of the given array of layers.
+ * @param roles Logically OR'd TmxLayerRole flags, any of which a layer must be tagged with to be gathered.
+ * @param outputLayers Output array assigned with pointers to the gathered layers.
+ * @param outputLength Length of the 'outputLayers' array.
+ * @param count Number of layers gathered so far.
+ * @return The number of layers gathered so far, including those found among the given layers.
+ */
+uint32_t GatherLayersWithRole(TmxLayer* layers, uint32_t layersLength, uint32_t roles, TmxLayer** outputLayers,
+        uint32_t outputLength, uint32_t count) {
+    for (uint32_t i = 0; i < layersLength; i++) {
+        if ((layers[i].roles & roles) != 0) {
+            if (count < outputLength)
+                outputLayers[count] = &layers[i];
+            count += 1;
+        }
+        if (layers[i].type == LAYER_TYPE_GROUP)
+            count = GatherLayersWithRole(layers[i].layers, layers[i].layersLength, roles, outputLayers, outputLength,
+                count);
+    }
+    return count;
+}
+
+void DrawTMXTileLayer(const TmxMap* map, Rectangle screenRect, TmxLayer layer, int posX, int posY, Color tint) {
     if (map == NULL || layer.type != LAYER_TYPE_TILE_LAYER || layer.exact.tileLayer.tilesLength == 0)
         return;
 
-    /* Iterate through each tile that the screen rectangle overlaps with */
-    uint32_t rawGid;
-    Rectangle tileRect;
-    while (IterateTileLayer(/* map: */ map, /* layer: */ &layer.exact.tileLayer, /* screenRect: */ screenRect,
-            /* rawGid: */ &rawGid, /* tile: */ NULL, /* tileRect: */ &tileRect)) {
-        DrawTMXLayerTile(/* map: */ map, /* screenRect: */ screenRect, /* rawGid: */ rawGid,
-                         /* posX: */ posX + (int)tileRect.x, /* posY: */ posY + (int)tileRect.y, /* tint: */ tint);
+    /* Iterate through each row of tiles that the screen rectangle overlaps with */
+    RaytmxTileLayerIterator iterator = IterateTileLayer(map, &layer.exact.tileLayer, screenRect);
+    RaytmxTileSpan span;
+    while (NextTileLayerSpan(&iterator, &span)) {
+        int tileY = posY + (span.y * (int)map->tileHeight);
+        for (uint32_t i = 0; i < span.length; i++) {
+            uint32_t j = span.isRightToLeft ? span.length - 1 - i : i; /* Follow the render order within the row */
+            if (span.rawGids[j] == 0) /* If there is no tile here */
+                continue;
+            DrawTMXLayerTile(/* map: */ map, /* screenRect: */ screenRect, /* rawGid: */ span.rawGids[j],
+                /* posX: */ posX + ((span.x + (int)j) * (int)map->tileWidth), /* posY: */ tileY, /* tint: */ tint);
+        }
+    }
+
+    /* Draw the queued tiles with one batch per tileset texture. Tiles of different tilesets therefore no longer */
+    /* interleave in the render order, which only shows where tiles overlap one another. */
+    FlushTileBatches();
+}
+
+bool DrawTMXTileLayerChunks(const TmxMap* map, Rectangle screenRect, TmxLayer* layer, int posX, int posY, Color tint) {
+    RaytmxRenderChunkSet* chunkSet = GetRenderChunkSet(map, &layer->exact.tileLayer);
+    if (chunkSet == NULL || !chunkSet->isCacheable)
+        return false; /* The caller draws the layer tile by tile */
+    if (tint.a == 0)
+        return true;
+
+    /* Determine the range of chunks that the screen rectangle overlaps with */
+    float chunkWidth = (float)(chunkSet->chunkSize * map->tileWidth);
+    float chunkHeight = (float)(chunkSet->chunkSize * map->tileHeight);
+    int fromX = Clampi((int)floorf((screenRect.x - posX) / chunkWidth), 0, (int)chunkSet->columns - 1);
+    int fromY = Clampi((int)floorf((screenRect.y - posY) / chunkHeight), 0, (int)chunkSet->rows - 1);
+    int toX = Clampi((int)floorf((screenRect.x + screenRect.width - posX) / chunkWidth), 0, (int)chunkSet->columns - 1);
+    int toY = Clampi((int)floorf((screenRect.y + screenRect.height - posY) / chunkHeight), 0, (int)chunkSet->rows - 1);
+
+    /* Rasterize any missing chunks first, so that switching render targets doesn't happen between chunk draws */
+    for (int y = fromY; y <= toY; y++) {
+        for (int x = fromX; x <= toX; x++) {
+            RaytmxRenderChunk* chunk = &chunkSet->chunks[(y * chunkSet->columns) + x];
+            if (chunk->target.id == 0)
+                RasterizeRenderChunk(map, *layer, chunk, GetRenderChunkRect(map, layer, chunkSet, x, y));
+            if (chunk->target.id == 0) /* If the render texture couldn't be created */
+                return false;
+        }
+    }
+
+    /* Chunks hold premultiplied colors, so they're blended as such and the tint is premultiplied to match */
+    Color premultipliedTint = { (unsigned char)(tint.r * tint.a / 255), (unsigned char)(tint.g * tint.a / 255),
+        (unsigned char)(tint.b * tint.a / 255), tint.a };
+    BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
+    for (int y = fromY; y <= toY; y++) {
+        for (int x = fromX; x <= toX; x++) {
+            RaytmxRenderChunk* chunk = &chunkSet->chunks[(y * chunkSet->columns) + x];
+            Rectangle chunkRect = GetRenderChunkRect(map, layer, chunkSet, x, y);
+            TouchRenderChunk(chunk);
+            tmxChunkStats.drawnChunks += 1;
+
+            /* Render textures are stored upside-down, hence the negative source height */
+            Rectangle source = { 0.0f, 0.0f, chunkRect.width, -chunkRect.height };
+            Rectangle dest = { posX + chunkRect.x, posY + chunkRect.y, chunkRect.width, chunkRect.height };
+            DrawTexturePro(chunk->target.texture, source, dest, (Vector2){ 0.0f, 0.0f }, 0.0f, premultipliedTint);
+        }
     }
+    EndBlendMode();
+
+    return true;
 }
 
-void DrawTextureTile(Texture2D texture, Rectangle source, Rectangle dest, bool flipX, bool flipY, bool flipDiag,
-        Color tint) {
-    if (texture.id == 0) /* If the texture is invalid */
+Rectangle GetRenderChunkRect(const TmxMap* map, const TmxLayer* layer, const RaytmxRenderChunkSet* chunkSet, int x,
+    int y) {
+    float chunkWidth = (float)(chunkSet->chunkSize * map->tileWidth);
+    float chunkHeight = (float)(chunkSet->chunkSize * map->tileHeight);
+
+    /* Chunks on the right and bottom edges are cut down to the layer's dimensions */
+    Rectangle chunkRect;
+    chunkRect.x = x * chunkWidth;
+    chunkRect.y = y * chunkHeight;
+    chunkRect.width = fminf(chunkWidth, (float)(layer->exact.tileLayer.width * map->tileWidth) - chunkRect.x);
+    chunkRect.height = fminf(chunkHeight, (float)(layer->exact.tileLayer.height * map->tileHeight) - chunkRect.y);
+    return chunkRect;
+}
+
+RaytmxRenderChunkSet* GetRenderChunkSet(const TmxMap* map, TmxTileLayer* tileLayer) {
+    if (tmxChunkSize == 0 || tileLayer->width == 0 || tileLayer->height == 0)
+        return NULL;
+
+    RaytmxRenderChunkSet* chunkSet = tileLayer->renderChunks;
+    if (chunkSet != NULL && chunkSet->chunkSize == tmxChunkSize)
+        return chunkSet;
+    FreeRenderChunkSet(chunkSet); /* The chunk size was changed so start over */
+
+    chunkSet = (RaytmxRenderChunkSet*)MemAllocZero(sizeof(RaytmxRenderChunkSet));
+    chunkSet->chunkSize = tmxChunkSize;
+    chunkSet->columns = (tileLayer->width + tmxChunkSize - 1) / tmxChunkSize;
+    chunkSet->rows = (tileLayer->height + tmxChunkSize - 1) / tmxChunkSize;
+    chunkSet->chunks = (RaytmxRenderChunk*)MemAllocZero(sizeof(RaytmxRenderChunk) * chunkSet->columns *
+        chunkSet->rows);
+
+    /* Animated tiles change between frames so a layer containing any can't be rasterized once and reused */
+    chunkSet->isCacheable = true;
+    for (uint32_t i = 0; i < tileLayer->tilesLength && chunkSet->isCacheable; i++) {
+        uint32_t gid = GetGid(tileLayer->tiles[i], NULL, NULL, NULL, NULL);
+        if (gid < map->gidsToTilesLength && map->gidsToTiles[gid].hasAnimation)
+            chunkSet->isCacheable = false;
+    }
+
+    tileLayer->renderChunks = chunkSet;
+    return chunkSet;
+}
+
+void RasterizeRenderChunk(const TmxMap* map, TmxLayer layer, RaytmxRenderChunk* chunk, Rectangle chunkRect) {
+    chunk->target = LoadRenderTexture((int)chunkRect.width, (int)chunkRect.height);
+    if (chunk->target.id == 0) {
+        TraceLog(LOG_WARNING, "RAYTMX: Unable to create a %dx%d render texture for a tile layer chunk",
+            (int)chunkRect.width, (int)chunkRect.height);
+        return;
+    }
+
+    /* Switching render targets resets the matrices, losing the caller's camera. Save them to restore afterwards. */
+    Matrix modelview = rlGetMatrixModelview();
+    Matrix projection = rlGetMatrixProjection();
+
+    BeginTextureMode(chunk->target);
+    ClearBackground(BLANK);
+    rlPushMatrix();
+    rlTranslatef(-chunkRect.x, -chunkRect.y, 0.0f); /* Place the chunk's top-left corner at the texture's origin */
+    /* With plain alpha blending the alpha channel would be blended with itself, so translucent tiles would come out */
+    /* fainter once the chunk is blended onto the screen. Colors are blended as usual, leaving them premultiplied by */
+    /* coverage, while alpha accumulates coverage the way the screen would. */
+    rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA, RL_FUNC_ADD,
+        RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+    DrawTMXTileLayer(map, chunkRect, layer, 0, 0, WHITE); /* Tints are applied when the chunk is drawn */
+    EndBlendMode();
+    rlPopMatrix();
+    EndTextureMode();
+
+    rlSetMatrixProjection(projection);
+    rlSetMatrixModelview(modelview);
+
+    tmxChunkStats.residentChunks += 1;
+    tmxChunkStats.residentBytes += (size_t)chunk->target.texture.width * chunk->target.texture.height * 4;
+    tmxChunkStats.rasterizedChunks += 1;
+}
+
+void TouchRenderChunk(RaytmxRenderChunk* chunk) {
+    chunk->lastDrawn = tmxChunkDrawCounter;
+    if (tmxMostRecentChunk == chunk)
         return;
 
+    /* Unlink the chunk if it's already in the list */
+    if (chunk->moreRecent != NULL)
+        chunk->moreRecent->lessRecent = chunk->lessRecent;
+    if (chunk->lessRecent != NULL)
+        chunk->lessRecent->moreRecent = chunk->moreRecent;
+    if (tmxLeastRecentChunk == chunk)
+        tmxLeastRecentChunk = chunk->moreRecent;
+
+    /* Insert it at the most recent end */
+    chunk->moreRecent = NULL;
+    chunk->lessRecent = tmxMostRecentChunk;
+    if (tmxMostRecentChunk != NULL)
+        tmxMostRecentChunk->moreRecent = chunk;
+    tmxMostRecentChunk = chunk;
+    if (tmxLeastRecentChunk == NULL)
+        tmxLeastRecentChunk = chunk;
+}
+
+void UnloadRenderChunk(RaytmxRenderChunk* chunk) {
+    if (chunk->target.id == 0)
+        return;
+
+    if (chunk->moreRecent != NULL)
+        chunk->moreRecent->lessRecent = chunk->lessRecent;
+    else
+        tmxMostRecentChunk = chunk->lessRecent;
+    if (chunk->lessRecent != NULL)
+        chunk->lessRecent->moreRecent = chunk->moreRecent;
+    else
+        tmxLeastRecentChunk = chunk->moreRecent;
+
+    tmxChunkStats.residentChunks -= 1;
+    tmxChunkStats.residentBytes -= (size_t)chunk->target.texture.width * chunk->target.texture.height * 4;
+    UnloadRenderTexture(chunk->target);
+    chunk->target = (RenderTexture2D){ 0 };
+    chunk->moreRecent = chunk->lessRecent = NULL;
+}
+
+void FreeRenderChunkSet(RaytmxRenderChunkSet* chunkSet) {
+    if (chunkSet == NULL)
+        return;
+
+    for (uint32_t i = 0; i < chunkSet->columns * chunkSet->rows; i++)
+        UnloadRenderChunk(&chunkSet->chunks[i]);
+    MemFree(chunkSet->chunks);
+    MemFree(chunkSet);
+}
+
+void EvictRenderChunks(void) {
+    /* Unload the least recently drawn chunks until the cache fits its budget, stopping at chunks in use right now */
+    while (tmxChunkStats.residentBytes > tmxChunkStats.budgetBytes && tmxLeastRecentChunk != NULL &&
+            tmxLeastRecentChunk->lastDrawn != tmxChunkDrawCounter) {
+        UnloadRenderChunk(tmxLeastRecentChunk);
+        tmxChunkStats.evictedChunks += 1;
+    }
+}
+
+RAYTMX_DEC TmxTileBatchStats GetTMXTileBatchStats(void) {
+    return tmxTileBatchStats;
+}
+
+RAYTMX_DEC void ResetTMXTileBatches(void) {
+    for (uint32_t i = 0; i < tmxTileBatchesLength; i++) {
+        if (tmxTileBatches[i].quads != NULL)
+            MemFree(tmxTileBatches[i].quads);
+    }
+    if (tmxTileBatches != NULL)
+        MemFree(tmxTileBatches);
+    tmxTileBatches = NULL;
+    tmxTileBatchesLength = 0;
+    tmxTileBatchesCapacity = 0;
+    tmxTileBatchesQueued = 0;
+}
+
+void SetTileQuad(RaytmxTileQuad* quad, Texture2D texture, Rectangle source, Rectangle dest, bool flipX, bool flipY,
+        bool flipDiag, Color tint) {
     float textureWidth = (float)texture.width;
     float textureHeight = (float)texture.height;
 
@@ -3387,62 +5186,157 @@ void DrawTextureTile(Texture2D texture, Rectangle source, Rectangle dest, bool f
     destBottomRight.x = dest.x + dest.width;
     destBottomRight.y = dest.y + dest.height;
 
+    /* Resolve the flips into the corners, in the order top-left, bottom-left, bottom-right, top-right */
+    if (flipX && !flipY) {
+        quad->texCoords[0] = sourceTopRight;
+        quad->texCoords[1] = sourceBottomRight;
+        quad->texCoords[2] = sourceBottomLeft;
+        quad->texCoords[3] = sourceTopLeft;
+    } else if (flipY && !flipX) {
+        quad->texCoords[0] = sourceBottomLeft;
+        quad->texCoords[1] = sourceTopLeft;
+        quad->texCoords[2] = sourceTopRight;
+        quad->texCoords[3] = sourceBottomRight;
+    } else {
+        quad->texCoords[0] = sourceTopLeft;
+        quad->texCoords[1] = sourceBottomLeft;
+        quad->texCoords[2] = sourceBottomRight;
+        quad->texCoords[3] = sourceTopRight;
+    }
+    if (flipX && flipY) { /* Flipping both ways is the same as rotating the destination by 180 degrees */
+        quad->positions[0] = destBottomRight;
+        quad->positions[1] = destTopRight;
+        quad->positions[2] = destTopLeft;
+        quad->positions[3] = destBottomLeft;
+    } else {
+        quad->positions[0] = destTopLeft;
+        quad->positions[1] = destBottomLeft;
+        quad->positions[2] = destBottomRight;
+        quad->positions[3] = destTopRight;
+    }
+    quad->tint = tint;
+}
+
+void DrawTextureTile(Texture2D texture, Rectangle source, Rectangle dest, bool flipX, bool flipY, bool flipDiag,
+        Color tint) {
+    if (texture.id == 0) /* If the texture is invalid */
+        return;
+
+    RaytmxTileQuad quad;
+    SetTileQuad(&quad, texture, source, dest, flipX, flipY, flipDiag, tint);
+
     rlSetTexture(texture.id);
     rlBegin(RL_QUADS);
     {
         rlColor4ub(tint.r, tint.g, tint.b, tint.a);
         rlNormal3f(0.0f, 0.0f, 1.0f); /* Normal vector pointing towards viewer */
+        for (int i = 0; i < 4; i++) {
+            rlTexCoord2f(quad.texCoords[i].x, quad.texCoords[i].y);
+            rlVertex2f(quad.positions[i].x, quad.positions[i].y);
+        }
+    }
+    rlEnd();
+    rlSetTexture(0);
+}
 
-        /* Top-left corner of the quad */
-        if (flipX && !flipY)
-            rlTexCoord2f(sourceTopRight.x, sourceTopRight.y);
-        else if (flipY && !flipX)
-            rlTexCoord2f(sourceBottomLeft.x, sourceBottomLeft.y);
-        else
-            rlTexCoord2f(sourceTopLeft.x, sourceTopLeft.y);
-        if (flipX && flipY)
-            rlVertex2f(destBottomRight.x, destBottomRight.y);
-        else
-            rlVertex2f(destTopLeft.x, destTopLeft.y);
+void BatchTextureTile(Texture2D texture, Rectangle source, Rectangle dest, bool flipX, bool flipY, bool flipDiag,
+        Color tint) {
+    if (texture.id == 0) /* If the texture is invalid */
+        return;
 
-        /* Bottom-left corner of the quad */
-        if (flipX && !flipY)
-            rlTexCoord2f(sourceBottomRight.x, sourceBottomRight.y);
-        else if (flipY && !flipX)
-            rlTexCoord2f(sourceTopLeft.x, sourceTopLeft.y);
-        else
-            rlTexCoord2f(sourceBottomLeft.x, sourceBottomLeft.y);
-        if (flipX && flipY)
-            rlVertex2f(destTopRight.x, destTopRight.y);
-        else
-            rlVertex2f(destBottomLeft.x, destBottomLeft.y);
+    /* Find the batch for this texture, trying the most recently added one first since tiles of a tileset cluster */
+    RaytmxTileBatch* batch = NULL;
+    for (uint32_t i = tmxTileBatchesLength; i > 0; i--) {
+        if (tmxTileBatches[i - 1].textureId == texture.id) {
+            batch = &tmxTileBatches[i - 1];
+            break;
+        }
+    }
+    if (batch == NULL) {
+        if (tmxTileBatchesLength == tmxTileBatchesCapacity) {
+            uint32_t capacity = tmxTileBatchesCapacity == 0 ? 4 : tmxTileBatchesCapacity * 2;
+            RaytmxTileBatch* batches = (RaytmxTileBatch*)MemRealloc(tmxTileBatches,
+                sizeof(RaytmxTileBatch) * capacity);
+            if (batches == NULL) { /* If the allocation failed, fall back to drawing the tile by itself */
+                DrawTextureTile(texture, source, dest, flipX, flipY, flipDiag, tint);
+                return;
+            }
+            tmxTileBatches = batches;
+            tmxTileBatchesCapacity = capacity;
+        }
+        batch = &tmxTileBatches[tmxTileBatchesLength++];
+        memset(batch, 0, sizeof(RaytmxTileBatch));
+        batch->textureId = texture.id;
+    }
 
-        /* Bottom-right corner of the quad */
-        if (flipX && !flipY)
-            rlTexCoord2f(sourceBottomLeft.x, sourceBottomLeft.y);
-        else if (flipY && !flipX)
-            rlTexCoord2f(sourceTopRight.x, sourceTopRight.y);
-        else
-            rlTexCoord2f(sourceBottomRight.x, sourceBottomRight.y);
-        if (flipX && flipY)
-            rlVertex2f(destTopLeft.x, destTopLeft.y);
-        else
-            rlVertex2f(destBottomRight.x, destBottomRight.y);
+    if (batch->quadsLength == batch->quadsCapacity) {
+        uint32_t capacity = batch->quadsCapacity == 0 ? 256 : batch->quadsCapacity * 2;
+        RaytmxTileQuad* quads = (RaytmxTileQuad*)MemRealloc(batch->quads, sizeof(RaytmxTileQuad) * capacity);
+        if (quads == NULL) { /* If the allocation failed, fall back to drawing the tile by itself */
+            DrawTextureTile(texture, source, dest, flipX, flipY, flipDiag, tint);
+            return;
+        }
+        batch->quads = quads;
+        batch->quadsCapacity = capacity;
+    }
 
-        /* Top-right corner of the quad */
-        if (flipX && !flipY)
-            rlTexCoord2f(sourceTopLeft.x, sourceTopLeft.y);
-        else if (flipY && !flipX)
-            rlTexCoord2f(sourceBottomRight.x, sourceBottomRight.y);
-        else
-            rlTexCoord2f(sourceTopRight.x, sourceTopRight.y);
-        if (flipX && flipY)
-            rlVertex2f(destBottomLeft.x, destBottomLeft.y);
-        else
-            rlVertex2f(destTopRight.x, destTopRight.y);
+    SetTileQuad(&batch->quads[batch->quadsLength++], texture, source, dest, flipX, flipY, flipDiag, tint);
+    tmxTileBatchesQueued += 1;
+}
+
+void FlushTileBatches(void) {
+    if (tmxTileBatchesQueued == 0)
+        return;
+
+    /* rlgl's own vertex buffer holds a limited number of quads, so very large batches are submitted in slices that */
+    /* are each guaranteed to fit. At common screen sizes a layer's tiles fit in a single slice. */
+    const uint32_t sliceLength = 1024;
+    for (uint32_t i = 0; i < tmxTileBatchesLength; i++) {
+        RaytmxTileBatch* batch = &tmxTileBatches[i];
+        for (uint32_t start = 0; start < batch->quadsLength; start += sliceLength) {
+            uint32_t end = batch->quadsLength - start > sliceLength ? start + sliceLength : batch->quadsLength;
+            rlCheckRenderBatchLimit((int)(end - start) * 4);
+            rlSetTexture(batch->textureId);
+            rlBegin(RL_QUADS);
+            {
+                rlNormal3f(0.0f, 0.0f, 1.0f); /* Normal vector pointing towards viewer */
+                for (uint32_t j = start; j < end; j++) {
+                    const RaytmxTileQuad* quad = &batch->quads[j];
+                    rlColor4ub(quad->tint.r, quad->tint.g, quad->tint.b, quad->tint.a);
+                    for (int k = 0; k < 4; k++) {
+                        rlTexCoord2f(quad->texCoords[k].x, quad->texCoords[k].y);
+                        rlVertex2f(quad->positions[k].x, quad->positions[k].y);
+                    }
+                }
+            }
+            rlEnd();
+            rlSetTexture(0);
+            tmxTileBatchStats.submittedBatches += 1;
+        }
+        tmxTileBatchStats.submittedQuads += batch->quadsLength;
+        batch->quadsLength = 0;
     }
-    rlEnd();
-    rlSetTexture(0);
+    tmxTileBatchesQueued = 0;
+}
+
+void DropTileBatches(const TmxMap* map) {
+    /* Remove, in place and keeping the draw order of the rest, every batch of a texture the map's tiles use */
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < tmxTileBatchesLength; i++) {
+        RaytmxTileBatch* batch = &tmxTileBatches[i];
+        bool isUsed = false;
+        for (uint32_t gid = 0; !isUsed && gid < map->gidsToTilesLength; gid++)
+            isUsed = map->gidsToTiles[gid].texture.id == batch->textureId;
+        if (isUsed) {
+            tmxTileBatchesQueued -= batch->quadsLength;
+            if (batch->quads != NULL)
+                MemFree(batch->quads);
+        } else
+            tmxTileBatches[kept++] = *batch;
+    }
+    tmxTileBatchesLength = kept;
+    if (tmxTileBatchesLength == 0) /* The last batch went with the last map, so free the array too */
+        ResetTMXTileBatches();
 }
 
 void DrawTMXLayerTile(const TmxMap* map, Rectangle screenRect, uint32_t rawGid, int posX, int posY, Color tint) {
@@ -3486,7 +5380,8 @@ void DrawTMXLayerTile(const TmxMap* map, Rectangle screenRect, uint32_t rawGid,
 
         /* If the screen and destination rectangles are overlapping to any degree (i.e. if the tile is visible) */
         if (CheckCollisionRecs(screenRect, destRect)) {
-            DrawTextureTile(/* texture: */ tile.texture, /* source: */ tile.sourceRect, /* dest: */ destRect,
+            /* Queue the tile with others sharing its texture. The caller must call FlushTileBatches() to draw it. */
+            BatchTextureTile(/* texture: */ tile.texture, /* source: */ tile.sourceRect, /* dest: */ destRect,
                 /* flipX: */ isFlippedHorizontally, /* flipY: */ isFlippedVertically,
                 /* flipDiag: */ isFlippedDiagonally, /* tint: */ tint);
         }
@@ -3514,6 +5409,7 @@ void DrawTMXObjectTile(const TmxMap* map, Rectangle screenRect, uint32_t rawGid,
         /* Animations aren't really tiles. Instead, they contain frames that identify a tile to draw for the duration */
         /* of that frame. That current tile should be drawn. */
         DrawTMXLayerTile(map, screenRect, tile.gid + tile.animation.frames[tile.frameIndex].id, posX, posY, tint);
+        FlushTileBatches(); /* Objects are drawn one by one so that they stay in their draw order */
     } else {
         /* Determine the area in which to draw, and potentially stretch, the texture. This area matches that of the */
         /* <object>, not the tile size. This also means that the Y coordinate needs consideration because raylib */
@@ -3916,21 +5812,31 @@ bool CheckCollisionTMXTileLayerObject(const TmxMap* map, const TmxLayer* layers,
     /* Iterate through each layer and check their tiles for collisions with the given object */
     for (uint32_t i = 0; i < layersLength; i++) {
         if (layers[i].type == LAYER_TYPE_TILE_LAYER) { /* If the layer has tiles */
-            /* Iterate through each tile that the object's Axis-Aligned Bounding Box (AABB) overlaps with */
-            TmxTile tile;
-            Rectangle tileRect;
-            while (IterateTileLayer(/* map: */ map, /* layer: */ &layers[i].exact.tileLayer,
-                    /* screenRect: */ object.aabb, /* rawGid: */ NULL, /* tile: */ &tile, /* tileRect: */ &tileRect)) {
-                /* Iterate through each object associated with the tile */
-                for (uint32_t j = 0; j < tile.objectGroup.objectsLength; j++) {
-                    /* This object, the tile's collision information, has a relative position so this object must be */
-                    /* translated to the position of the tile as it would be drawn with the layer */
-                    TmxObject positionedObject = TranslateObject(tile.objectGroup.objects[j], tileRect.x, tileRect.y);
-                    /* If this tile's object collides with the given object */
-                    if (CheckCollisionTMXObjects(positionedObject, object)) {
-                        if (outputObject != NULL)
-                            *outputObject = positionedObject;
-                        return true; /* Found a collision. Exit now to save some CPU cycles. */
+            /* Iterate through each row of tiles that the object's Axis-Aligned Bounding Box (AABB) overlaps with */
+            RaytmxTileLayerIterator iterator = IterateTileLayer(map, &layers[i].exact.tileLayer, object.aabb);
+            RaytmxTileSpan span;
+            while (NextTileLayerSpan(&iterator, &span)) {
+                for (uint32_t k = 0; k < span.length; k++) {
+                    /* The raw GID may have bit flags on it. They need to be removed in order to get the actual GID */
+                    /* value, and with it the tile's metadata. */
+                    uint32_t gid = GetGid(span.rawGids[k], NULL, NULL, NULL, NULL);
+                    if (gid >= map->gidsToTilesLength)
+                        continue;
+                    const TmxTile* tile = &map->gidsToTiles[gid];
+                    float tileX = (float)((uint32_t)(span.x + (int)k) * map->tileWidth);
+                    float tileY = (float)((uint32_t)span.y * map->tileHeight);
+
+                    /* Iterate through each object associated with the tile */
+                    for (uint32_t j = 0; j < tile->objectGroup.objectsLength; j++) {
+                        /* This object, the tile's collision information, has a relative position so this object */
+                        /* must be translated to the position of the tile as it would be drawn with the layer */
+                        TmxObject positionedObject = TranslateObject(tile->objectGroup.objects[j], tileX, tileY);
+                        /* If this tile's object collides with the given object */
+                        if (CheckCollisionTMXObjects(positionedObject, object)) {
+                            if (outputObject != NULL)
+                                *outputObject = positionedObject;
+                            return true; /* Found a collision. Exit now to save some CPU cycles. */
+                        }
                     }
                 }
             }
@@ -3953,15 +5859,79 @@ bool CheckCollisionTMXTileLayerObject(const TmxMap* map, const TmxLayer* layers,
  * @return True if an object in the object group collides with the given object, or false if there is no collision.
  */
 bool CheckCollisionTMXObjectGroupObject(TmxObjectGroup group, TmxObject object, TmxObject* outputObject) {
-    for (size_t i = 0; i < group.objectsLength; i++) {
-        if (CheckCollisionTMXObjects(group.objects[i], object)) {
-            if (outputObject != NULL)
-                *outputObject = group.objects[i];
-            return true;
+    if (group.bvh == NULL) {
+        for (size_t i = 0; i < group.objectsLength; i++) {
+            if (CheckCollisionTMXObjects(group.objects[i], object)) {
+                if (outputObject != NULL)
+                    *outputObject = group.objects[i];
+                return true;
+            }
         }
+        return false;
     }
 
-    return false;
+    /* Report the same object a scan in array order would, the colliding object with the lowest index */
+    uint32_t firstIndex;
+    if (CheckCollisionTMXObjectGroupObjects(group, object, NULL, 0, &firstIndex) == 0)
+        return false;
+    if (outputObject != NULL)
+        *outputObject = group.objects[firstIndex];
+    return true;
+}
+
+/**
+ * Helper function that finds every object in the given object group that collides with the given object. Searches the
+ * group's bounding volume hierarchy, if it has one, so only objects near the given object are checked.
+ *
+ * @param group The object group whose 0+ objects will be checked for collisions.
+ * @param object A TMX <object> to be checked for collisions.
+ * @param outputObjects Output array assigned with up to 'outputLength' of the objects collided with. NULL if not wanted.
+ * @param outputLength Length of the 'outputObjects' array.
+ * @param firstIndex Output parameter assigned with the lowest index in 'objects' of the objects collided with, if any.
+ *                   NULL if not wanted.
+ * @return The number of objects in the object group that collide with the given object.
+ */
+uint32_t CheckCollisionTMXObjectGroupObjects(TmxObjectGroup group, TmxObject object, TmxObject* outputObjects,
+        uint32_t outputLength, uint32_t* firstIndex) {
+    uint32_t count = 0, lowestIndex = UINT32_MAX;
+
+    if (group.bvh == NULL) {
+        for (uint32_t i = 0; i < group.objectsLength; i++) {
+            if (!CheckCollisionTMXObjects(group.objects[i], object))
+                continue;
+            if (count < outputLength)
+                outputObjects[count] = group.objects[i];
+            if (i < lowestIndex)
+                lowestIndex = i;
+            count += 1;
+        }
+    } else {
+        /* Walk the hierarchy in depth-first order, skipping past every subtree whose bounds the object misses */
+        uint32_t nodeIndex = 0;
+        while (nodeIndex < group.bvhLength) {
+            const TmxObjectBvhNode* node = &group.bvh[nodeIndex];
+            if (!CheckCollisionRecs(node->aabb, object.aabb)) {
+                nodeIndex = node->skip;
+                continue;
+            }
+
+            for (uint32_t i = node->first; i < node->first + node->count; i++) {
+                uint32_t objectIndex = group.bvhObjects[i];
+                if (!CheckCollisionTMXObjects(group.objects[objectIndex], object))
+                    continue;
+                if (count < outputLength)
+                    outputObjects[count] = group.objects[objectIndex];
+                if (objectIndex < lowestIndex)
+                    lowestIndex = objectIndex;
+                count += 1;
+            }
+            nodeIndex += 1; /* An inner node's first child, or for a leaf, the node after it */
+        }
+    }
+
+    if (firstIndex != NULL && count > 0)
+        *firstIndex = lowestIndex;
+    return count;
 }
 
 void TraceLogTMXTilesets(int logLevel, TmxOrientation orientation, TmxTileset* tilesets, uint32_t tilesetsLength,
@@ -4318,7 +6288,7 @@ void TraceLogTMXObject(int logLevel, TmxObject object, int numSpaces) {
 }
 
 TmxProperty* AddProperty(RaytmxState* raytmxState) {
-    RaytmxPropertyNode* node = (RaytmxPropertyNode*)MemAllocZero(sizeof(RaytmxPropertyNode));
+    RaytmxPropertyNode* node = (RaytmxPropertyNode*)ArenaAllocZero(raytmxState, sizeof(RaytmxPropertyNode));
 
     if (raytmxState->propertiesRoot == NULL)
         raytmxState->propertiesRoot = node;
@@ -4330,20 +6300,132 @@ TmxProperty* AddProperty(RaytmxState* raytmxState) {
     return &node->property;
 }
 
+void ReserveTileLayerTiles(RaytmxState* raytmxState, uint32_t capacity) {
+    if (capacity <= raytmxState->layerTilesCapacity)
+        return;
+
+    /* Grow, or initially allocate, the array of GIDs. Any GIDs already parsed are preserved by the reallocation. */
+    raytmxState->layerTiles = (uint32_t*)MemRealloc(raytmxState->layerTiles, sizeof(uint32_t) * capacity);
+    raytmxState->layerTilesCapacity = capacity;
+}
+
 void AddTileLayerTile(RaytmxState* raytmxState, uint32_t gid) {
-    RaytmxTileLayerTileNode* node = (RaytmxTileLayerTileNode*)MemAllocZero(sizeof(RaytmxTileLayerTileNode));
-    node->gid = gid;
+    if (raytmxState->layerTilesLength == raytmxState->layerTilesCapacity) { /* If the array is full, or missing */
+        /* A tile layer has exactly 'width' * 'height' tiles so that is the best first guess. Should the layer lack */
+        /* those attributes, or have more tiles than they suggest, fall back to doubling the capacity. */
+        uint32_t capacity = raytmxState->tileLayer->width * raytmxState->tileLayer->height;
+        if (capacity <= raytmxState->layerTilesCapacity)
+            capacity = raytmxState->layerTilesCapacity > 0 ? raytmxState->layerTilesCapacity * 2 : 64;
+        ReserveTileLayerTiles(raytmxState, capacity);
+    }
 
-    if (raytmxState->layerTilesRoot == NULL)
-        raytmxState->layerTilesRoot = node;
-    else
-        raytmxState->layerTilesTail->next = node;
-    raytmxState->layerTilesTail = node;
+    raytmxState->layerTiles[raytmxState->layerTilesLength] = gid;
     raytmxState->layerTilesLength += 1;
 }
 
+uint32_t DecodeCsvTileLayerTiles(RaytmxState* raytmxState, const char* csv, size_t csvLength) {
+    /* GIDs are written directly into the state's array of tiles. Local copies of its pointer, length, and capacity */
+    /* are kept for speed and are only refreshed when the array has to grow. */
+    uint32_t* tiles = raytmxState->layerTiles;
+    uint32_t length = raytmxState->layerTilesLength, capacity = raytmxState->layerTilesCapacity;
+    uint32_t initialLength = length;
+
+    const char *iterator = csv, *end = csv + csvLength;
+    uint32_t value = 0; /* The GID being accumulated, one digit at a time */
+    bool hasDigits = false; /* True once at least one digit of the current value has been read */
+    bool isValueEnded = false; /* True once a non-digit follows the digits, such as "12 " - the rest is ignored */
+    while (iterator < end) {
+        if (!hasDigits && !isValueEnded) { /* If pointing to the start of a value, ignoring any whitespace */
+            /* The vast majority of the GIDs in a typical map are single digits, mostly zeroes for empty cells. A run */
+            /* of them looks like "0,0,0,0,0,0,0,0," where every even byte is a digit and every odd byte is a comma. */
+            /* That pattern can be detected, and each digit converted to a GID, for a whole register at once. */
+#ifdef RAYTMX_CSV_AVX2
+            while (end - iterator >= 32 && capacity - length >= 16) {
+                __m256i bytes = _mm256_loadu_si256((const __m256i*)iterator);
+                __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8('0' - 1)),
+                    _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), bytes));
+                __m256i isComma = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(','));
+                if ((uint32_t)_mm256_movemask_epi8(isDigit) != 0x55555555u ||
+                        (uint32_t)_mm256_movemask_epi8(isComma) != 0xAAAAAAAAu)
+                    break; /* Not sixteen single-digit values in a row */
+                /* Each 16-bit lane is now a digit (low byte) and a comma (high byte). Keep the digit's value only. */
+                __m256i digits = _mm256_and_si256(_mm256_sub_epi8(bytes, _mm256_set1_epi8('0')),
+                    _mm256_set1_epi16(0x00FF));
+                /* Widen the sixteen 16-bit values to 32-bit GIDs and store them */
+                _mm256_storeu_si256((__m256i*)(tiles + length),
+                    _mm256_cvtepu16_epi32(_mm256_castsi256_si128(digits)));
+                _mm256_storeu_si256((__m256i*)(tiles + length + 8),
+                    _mm256_cvtepu16_epi32(_mm256_extracti128_si256(digits, 1)));
+                iterator += 32;
+                length += 16;
+            }
+#endif
+#ifdef RAYTMX_CSV_SSE2
+            while (end - iterator >= 16 && capacity - length >= 8) {
+                __m128i bytes = _mm_loadu_si128((const __m128i*)iterator);
+                __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('0' - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), bytes));
+                __m128i isComma = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(','));
+                if (_mm_movemask_epi8(isDigit) != 0x5555 || _mm_movemask_epi8(isComma) != 0xAAAA)
+                    break; /* Not eight single-digit values in a row */
+                /* Each 16-bit lane is now a digit (low byte) and a comma (high byte). Keep the digit's value only. */
+                __m128i digits = _mm_and_si128(_mm_sub_epi8(bytes, _mm_set1_epi8('0')), _mm_set1_epi16(0x00FF));
+                /* Widen the eight 16-bit values to 32-bit GIDs by interleaving them with zeroes and store them */
+                _mm_storeu_si128((__m128i*)(tiles + length), _mm_unpacklo_epi16(digits, _mm_setzero_si128()));
+                _mm_storeu_si128((__m128i*)(tiles + length + 4), _mm_unpackhi_epi16(digits, _mm_setzero_si128()));
+                iterator += 16;
+                length += 8;
+            }
+#endif
+            if (iterator >= end)
+                break;
+        }
+
+        /* Anything else, such as multi-digit GIDs and the newline at the end of each row, is handled one character */
+        /* at a time */
+        char character = *iterator++;
+        if (character >= '0' && character <= '9') {
+            if (!isValueEnded) {
+                value = (value * 10) + (uint32_t)(character - '0');
+                hasDigits = true;
+            }
+        } else if (character == ',') { /* If the value has ended */
+            if (length == capacity) { /* If the array is full, perhaps because 'width' and 'height' were missing */
+                ReserveTileLayerTiles(raytmxState, capacity > 0 ? capacity * 2 : 64);
+                tiles = raytmxState->layerTiles;
+                capacity = raytmxState->layerTilesCapacity;
+            }
+            tiles[length++] = value;
+            value = 0;
+            hasDigits = false;
+            isValueEnded = false;
+        } else if (hasDigits || !isspace((unsigned char)character))
+            isValueEnded = true; /* Any characters that follow, up to the next comma, are not part of the value */
+    }
+    if (hasDigits || isValueEnded) { /* If the final value wasn't followed by a comma, as is typical */
+        if (length == capacity) {
+            ReserveTileLayerTiles(raytmxState, capacity > 0 ? capacity * 2 : 64);
+            tiles = raytmxState->layerTiles;
+        }
+        tiles[length++] = value;
+    }
+
+    raytmxState->layerTilesLength = length;
+    return length - initialLength;
+}
+
+void TakeTileLayerTiles(RaytmxState* raytmxState) {
+    /* The array was sized for the layer so it's given to the layer directly rather than copied */
+    raytmxState->tileLayer->tiles = raytmxState->layerTiles;
+    raytmxState->tileLayer->tilesLength = raytmxState->layerTilesLength;
+    /* Clean up the state object */
+    raytmxState->layerTiles = NULL;
+    raytmxState->layerTilesLength = 0;
+    raytmxState->layerTilesCapacity = 0;
+}
+
 TmxTileset* AddTileset(RaytmxState* raytmxState) {
-    RaytmxTilesetNode* node = (RaytmxTilesetNode*)MemAllocZero(sizeof(RaytmxTilesetNode));
+    RaytmxTilesetNode* node = (RaytmxTilesetNode*)ArenaAllocZero(raytmxState, sizeof(RaytmxTilesetNode));
 
     if (raytmxState->tilesetsRoot == NULL)
         raytmxState->tilesetsRoot = node;
@@ -4356,7 +6438,7 @@ TmxTileset* AddTileset(RaytmxState* raytmxState) {
 }
 
 TmxTilesetTile* AddTilesetTile(RaytmxState* raytmxState) {
-    RaytmxTilesetTileNode* node = (RaytmxTilesetTileNode*)MemAllocZero(sizeof(RaytmxTilesetTileNode));
+    RaytmxTilesetTileNode* node = (RaytmxTilesetTileNode*)ArenaAllocZero(raytmxState, sizeof(RaytmxTilesetTileNode));
 
     if (raytmxState->tilesetTilesRoot == NULL)
         raytmxState->tilesetTilesRoot = node;
@@ -4369,7 +6451,8 @@ TmxTilesetTile* AddTilesetTile(RaytmxState* raytmxState) {
 }
 
 TmxAnimationFrame* AddAnimationFrame(RaytmxState* raytmxState) {
-    RaytmxAnimationFrameNode* node = (RaytmxAnimationFrameNode*)MemAllocZero(sizeof(RaytmxAnimationFrameNode));
+    RaytmxAnimationFrameNode* node = (RaytmxAnimationFrameNode*)ArenaAllocZero(raytmxState,
+        sizeof(RaytmxAnimationFrameNode));
 
     if (raytmxState->animationFramesRoot == NULL)
         raytmxState->animationFramesRoot = node;
@@ -4382,7 +6465,7 @@ TmxAnimationFrame* AddAnimationFrame(RaytmxState* raytmxState) {
 }
 
 TmxLayer* AddGenericLayer(RaytmxState* raytmxState, bool isGroup) {
-    RaytmxLayerNode* node = (RaytmxLayerNode*)MemAllocZero(sizeof(RaytmxLayerNode));
+    RaytmxLayerNode* node = (RaytmxLayerNode*)ArenaAllocZero(raytmxState, sizeof(RaytmxLayerNode));
     /* There are some non-zero default values for several layer attributes: */
     node->layer.opacity = 1.0;
     node->layer.visible = true;
@@ -4413,7 +6496,7 @@ TmxLayer* AddGenericLayer(RaytmxState* raytmxState, bool isGroup) {
 }
 
 TmxObject* AddObject(RaytmxState* raytmxState) {
-    RaytmxObjectNode* node = (RaytmxObjectNode*)MemAllocZero(sizeof(RaytmxObjectNode));
+    RaytmxObjectNode* node = (RaytmxObjectNode*)ArenaAllocZero(raytmxState, sizeof(RaytmxObjectNode));
     /* <object> elements have one non-zero default value: */
     node->object.visible = true;
 
@@ -4468,10 +6551,11 @@ RaytmxCachedTextureNode* LoadCachedTexture(RaytmxState* raytmxState, const char*
         cachedTextureNode = cachedTextureNode->next;
     }
 
-    /* Try to load the texture */
+    /* Try to load the texture, or only decode the image when the upload is deferred */
     char* fullPath = JoinPath(raytmxState->documentDirectory, fileName);
-    Texture2D texture = LoadTexture(fullPath);
-    if (texture.id == 0) { /* If loading the texture failed */
+    Image image;
+    Texture2D texture = LoadTextureOrImage(fullPath, raytmxState->isTextureUploadDeferred, &image);
+    if (texture.width == 0) { /* If loading the texture failed */
         TraceLog(LOG_ERROR, "RAYTMX: Unable to load texture \"%s\"", fullPath);
         return NULL;
     }
@@ -4481,6 +6565,7 @@ RaytmxCachedTextureNode* LoadCachedTexture(RaytmxState* raytmxState, const char*
     cachedTextureNode->fileName = (char*)MemAllocZero((unsigned int)strlen(fileName) + 1);
     StringCopy(cachedTextureNode->fileName, fileName);
     cachedTextureNode->texture = texture;
+    cachedTextureNode->image = image;
 
     /* Add to the cache */
     if (raytmxState->texturesRoot == NULL)
@@ -4510,7 +6595,7 @@ RaytmxCachedTemplateNode* LoadCachedTemplate(RaytmxState* raytmxState, const cha
 
     /* Load the template from the external TX file */
     char* fullPath = JoinPath(raytmxState->documentDirectory, fileName);
-    RaytmxObjectTemplate objectTemplate = LoadTX(fullPath);
+    RaytmxObjectTemplate objectTemplate = LoadTX(fullPath, raytmxState->isTextureUploadDeferred);
     if (!objectTemplate.isSuccess) { /* If loading the template failed */
         TraceLog(LOG_ERROR, "RAYTMX: Unable to load template \"%s\"", fullPath);
         return NULL;
@@ -4608,10 +6693,45 @@ void* MemAllocZero(unsigned int size) {
     return buffer;
 }
 
+void* ArenaAllocZero(RaytmxState* raytmxState, size_t size) {
+    /* Round the size up so that the next allocation from the same block remains aligned */
+    size = (size + RAYTMX_ARENA_ALIGNMENT - 1) & ~(size_t)(RAYTMX_ARENA_ALIGNMENT - 1);
+    /* The block's header is padded the same way so the first allocation from a block is also aligned */
+    size_t headerSize = (sizeof(RaytmxArenaBlock) + RAYTMX_ARENA_ALIGNMENT - 1) &
+        ~(size_t)(RAYTMX_ARENA_ALIGNMENT - 1);
+
+    RaytmxArenaBlock* block = raytmxState->arena;
+    if (block == NULL || block->used + size > block->capacity) { /* If there's no block or it's too full */
+        /* Reserve a new block, making it larger than usual if this one allocation wouldn't fit in a typical block */
+        size_t capacity = headerSize + size > RAYTMX_ARENA_BLOCK_SIZE ? headerSize + size : RAYTMX_ARENA_BLOCK_SIZE;
+        block = (RaytmxArenaBlock*)MemAlloc((unsigned int)capacity);
+        block->capacity = capacity;
+        block->used = headerSize;
+        /* The newest block goes at the front of the list since it's the only one that will be allocated from */
+        block->next = raytmxState->arena;
+        raytmxState->arena = block;
+    }
+
+    void* buffer = (unsigned char*)block + block->used;
+    block->used += size;
+    memset(buffer, 0, size); /* Initialize any values to zero, NULL, false, or an equivalent enum value */
+    return buffer;
+}
+
+void FreeArena(RaytmxState* raytmxState) {
+    RaytmxArenaBlock *blockIterator = raytmxState->arena, *blockTemp;
+    while (blockIterator != NULL) {
+        blockTemp = blockIterator;
+        blockIterator = blockIterator->next;
+        MemFree(blockTemp);
+    }
+    raytmxState->arena = NULL;
+}
+
 /* "Get directory for a given filePath" */
 /* raylib's GetDirectoryPath() doesn't work as described so this is used in its place */
 char* GetDirectoryPath2(const char* filePath) {
-    static char directoryPath[260]; /* Max path length on Windows, the bottleneck, is 260 characters */
+    static RAYTMX_THREAD_LOCAL char directoryPath[260]; /* Max path length on Windows, the bottleneck, is 260 characters */
     memset(directoryPath, '\0', 260);
     size_t length = strlen(filePath);
     /* Paths beginning with a Windows drive letter (C:\, D:\, etc.) or beginning with a slash are absolute paths */
@@ -4636,7 +6756,7 @@ char* GetDirectoryPath2(const char* filePath) {
 }
 
 char* JoinPath(const char* prefix, const char* suffix) {
-    static char joinedPath[260]; /* Max path length on Windows, the bottleneck, is 260 characters */
+    static RAYTMX_THREAD_LOCAL char joinedPath[260]; /* Max path length on Windows, the bottleneck, is 260 characters */
     memset(joinedPath, '\0', 260);
     StringCopy(joinedPath, prefix);
     size_t prefixLength = strlen(prefix);